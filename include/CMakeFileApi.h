@@ -0,0 +1,42 @@
+#ifndef CMAKEFILEAPI_H
+#define CMAKEFILEAPI_H
+
+#include <string>
+#include <vector>
+
+struct CMakeTarget {
+    std::string name;
+    std::string type;                   // EXECUTABLE, STATIC_LIBRARY, SHARED_LIBRARY, ...
+    std::vector<std::string> artifacts; // Absolute paths of the files the target produces
+    std::string buildDirectory;         // Absolute binary directory of the target's CMakeLists.txt
+    bool linksGuiToolkit = false;       // Links Qt Widgets, GTK, SDL, ...
+};
+
+struct CMakeCodeModel {
+    std::string projectName;
+    std::vector<CMakeTarget> targets;
+};
+
+// Client of the CMake File API (cmake-file-api(7)). A query written into
+// the build directory before configuring makes cmake describe every target
+// and its artifacts in a JSON reply, which replaces guessing from the files
+// in the build tree.
+class CMakeFileApi {
+public:
+    explicit CMakeFileApi(const std::string& buildDirectory);
+
+    // Idempotent; must be in place before cmake configures
+    bool writeQuery() const;
+    bool hasReply() const;
+
+    // configuration picks the build type of multi-config generators;
+    // false if there is no readable reply yet
+    bool readCodeModel(CMakeCodeModel& model, const std::string& configuration = std::string()) const;
+
+private:
+    std::string latestReplyIndex() const;
+
+    std::string buildDirectory_;
+};
+
+#endif // CMAKEFILEAPI_H
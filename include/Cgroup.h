@@ -0,0 +1,64 @@
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+// Limits for the cgroup of each confined job. Weights are relative to the
+// sibling cgroups (1..10000, the kernel default is 100), so a build yields
+// to the desktop under contention without being slowed on an idle machine.
+struct ResourceLimits {
+    bool enabled = false;
+    int cpuWeight = 50;
+    uint64_t memoryMaxMb = 0; // 0: no hard limit
+    int ioWeight = 50;
+
+    void loadFromFile(const std::string& filePath);
+    void saveToFile(const std::string& filePath) const;
+};
+
+// Counters of one cgroup-v2 directory; whatever a controller that is not
+// enabled would report stays 0
+struct CgroupUsage {
+    bool valid = false;
+    uint64_t cpuUsec = 0;
+    uint64_t memoryCurrent = 0;
+    uint64_t memoryPeak = 0; // memory.peak needs Linux 5.19
+    uint64_t ioReadBytes = 0;
+    uint64_t ioWriteBytes = 0;
+    uint64_t processes = 0;
+};
+
+// Transient cgroup-v2 groups for child processes. Either systemd's user
+// manager creates them (systemd-run --user --scope), or, when cppm itself
+// runs in a delegated subtree, cppm creates them as children of its own.
+class Cgroup {
+public:
+    enum class Method { None, SystemdScope, Delegated };
+
+    // Decided once per process, without changing anything: safe to ask
+    // for display. None once a delegation has been refused.
+    static Method availableMethod();
+    // The method, made ready for job groups. Delegated moves cppm into a
+    // "cppm" leaf of its own group, because a cgroup that distributes
+    // controllers to children may not contain processes itself, then
+    // enables cpu, memory and io for its children; if the kernel refuses
+    // any of it, the method is None from then on.
+    static Method prepare();
+    static const char* methodName(Method method);
+
+    // The cgroup-v2 directory a process is in; empty without a unified hierarchy
+    static std::string pathOf(pid_t pid);
+
+    // Delegated only: a new child group with the limits written to it;
+    // empty if the group or any of its limits could not be set up
+    static std::string createJobGroup(const std::string& name, const ResourceLimits& limits);
+    static void removeJobGroup(const std::string& path);
+    // Moves the calling process into path
+    static bool enter(const std::string& path);
+
+    static bool readUsage(const std::string& path, CgroupUsage& usage);
+};
+
+#endif // CGROUP_H
@@ -0,0 +1,37 @@
+#ifndef COMPILEDATABASE_H
+#define COMPILEDATABASE_H
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct CompileCommand {
+    std::string directory;              // Working directory of the compiler
+    std::string file;                   // Absolute path of the translation unit
+    std::vector<std::string> arguments; // argv, when the database lists it split
+    std::string command;                // Shell command line otherwise
+};
+
+// A compile_commands.json as written by CMAKE_EXPORT_COMPILE_COMMANDS,
+// meson or bear: how to compile each translation unit on its own.
+class CompileDatabase {
+public:
+    bool load(const std::string& filePath);
+    // Keeps what is loaded if it came from filePath and the file has not
+    // changed since; loads it otherwise
+    bool refresh(const std::string& filePath);
+
+    // nullptr if the file is not a translation unit of the build
+    const CompileCommand* find(const std::string& sourceFile) const;
+    const std::vector<CompileCommand>& commands() const { return commands_; }
+
+private:
+    std::vector<CompileCommand> commands_;
+    std::unordered_map<std::string, size_t> byFile_; // Normalized path to index
+    std::string loadedPath_;
+    std::filesystem::file_time_type loadedTime_;
+    std::uintmax_t loadedSize_ = 0;
+};
+
+#endif // COMPILEDATABASE_H
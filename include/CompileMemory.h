@@ -0,0 +1,61 @@
+#ifndef COMPILEMEMORY_H
+#define COMPILEMEMORY_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// How many compile jobs a build may run at once, and why
+struct JobsChoice {
+    int jobs = 1;
+    int cores = 1;
+    uint64_t availableKb = 0; // MemAvailable when the build started
+    uint64_t perJobKb = 0;    // 90th percentile peak of a translation unit, 0 if none was recorded
+    size_t sources = 0;       // Translation units with a recorded peak
+};
+
+// Peak resident memory of each translation unit of a workspace, recorded
+// by the compile launcher ("cppm-launcher --compile-launcher") that runs in
+// front of every compiler call. Builds size their -j from it, and the
+// launcher holds back compiles while memory is short.
+//
+// Build trees are configured with the workspace's shim script as their
+// launcher (Workspace::compileLauncherShim), not with a path to cppm; a
+// build started from cppm names the launcher and log in kLauncherVariable
+// and kLogVariable, and the shim runs the compiler directly without them.
+class CompileMemory {
+public:
+    static constexpr const char* kLauncherVariable = "CPPM_COMPILE_LAUNCHER";
+    static constexpr const char* kLogVariable = "CPPM_COMPILE_MEMORY_LOG";
+
+    explicit CompileMemory(const std::string& logFile);
+
+    bool load();
+    // Reloads and rewrites the log with one line per source once it has
+    // grown. Launchers append under a shared lock on "<log>.lock" and this
+    // takes it exclusively, or leaves the log for next time if it is busy.
+    void compact();
+    uint64_t peakKb(const std::string& source) const;
+    // The latest record of one source, without loading the others
+    static uint64_t recordedPeakKb(const std::string& logFile, const std::string& source);
+    // 90th percentile over sources, so a few heavy template TUs count
+    uint64_t typicalPeakKb() const;
+    size_t sourceCount() const { return peaks_.size(); }
+
+    // As many jobs as fit into 80% of what is available, at most one per core
+    JobsChoice chooseJobs(int cores) const;
+
+    static uint64_t memAvailableKb();
+    // "some avg10" of /proc/pressure/memory in percent, negative without PSI
+    static double memoryPressure();
+
+    // Body of "cppm-launcher --compile-launcher <log file> <compiler> [arguments...]"
+    static int runLauncher(int argc, char* argv[]);
+
+private:
+    std::string logFile_;
+    std::unordered_map<std::string, uint64_t> peaks_;
+    size_t lines_ = 0;
+};
+
+#endif // COMPILEMEMORY_H
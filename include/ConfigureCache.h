@@ -0,0 +1,37 @@
+#ifndef CONFIGURECACHE_H
+#define CONFIGURECACHE_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Initial cache (cmake -C) for fresh build directories, so they do not
+// repeat the try_compile runs of an earlier configure. Only what the
+// toolchain alone decides, the check_type_size results (SIZEOF_*), is
+// shared by every workspace configured with the same toolchain, in
+// ~/.cache/cppm/configure. The results of check_include_file,
+// check_symbol_exists, check_cxx_compiler_flag and the like depend on the
+// project's own check inputs and are only kept for the workspace that ran
+// them, in its .cppm directory; that file includes the shared one.
+// A compiler or cmake binary that changes on disk invalidates both files.
+class ConfigureCache {
+public:
+    // cacheEntries are a configuration's -D entries, which may pick the
+    // compilers or add flags, standards or CMAKE_REQUIRED_* inputs that
+    // change the outcome of the probes
+    ConfigureCache(const std::string& toolchainFile, const std::vector<std::string>& cacheEntries,
+                   const std::filesystem::path& workspaceStateDirectory);
+
+    // Path to pass with -C; empty if nothing valid is recorded yet
+    std::string initialCacheFile() const;
+
+    // Merges the probe results of a successfully configured CMakeCache.txt
+    bool record(const std::string& cmakeCacheFile) const;
+
+private:
+    std::string identity_;       // Path, size and mtime of each tool
+    std::filesystem::path file_; // Shared by the toolchain's workspaces
+    std::filesystem::path workspaceFile_;
+};
+
+#endif // CONFIGURECACHE_H
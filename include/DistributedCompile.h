@@ -0,0 +1,60 @@
+#ifndef DISTRIBUTEDCOMPILE_H
+#define DISTRIBUTEDCOMPILE_H
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// Per-workspace choice, kept in .cppm/distributed.txt
+struct DistributedSettings {
+    bool enabled = false;
+    std::string backend = "auto"; // "auto", "distcc" or "icecc"
+    int jobSlots = 0;             // 0: from the distcc host list; icecream needs it set
+
+    void loadFromFile(const std::string& filePath);
+    void saveToFile(const std::string& filePath) const;
+};
+
+struct DistccHost {
+    std::string name;
+    int jobSlots = 0;
+    bool local = false;
+};
+
+// What a distributed build would run with, or why it cannot
+struct DistributedPlan {
+    bool available = false;
+    std::string backend; // "distcc" or "icecc"
+    std::string tool;    // Full path of the distcc or icecc binary
+    int jobSlots = 0;    // Compiles the hosts accept at once, local ones included
+    std::vector<DistccHost> hosts;
+    std::string error;
+};
+
+// One compile in flight, from distcc's state directory
+struct DistccTask {
+    pid_t pid = 0;
+    std::string file;
+    std::string host;
+    int slot = 0;
+};
+
+// distcc and icecream as compile launchers. Builds hand the tool to the
+// cppm compile launcher through kLauncherVariable, so switching a workspace
+// to distributed mode needs no reconfigure.
+class DistributedCompile {
+public:
+    static constexpr const char* kLauncherVariable = "CPPM_DISTRIBUTED_COMPILER";
+
+    static DistributedPlan plan(const DistributedSettings& settings);
+
+    // $DISTCC_HOSTS, else ~/.distcc/hosts, else /etc/distcc/hosts
+    static std::vector<DistccHost> distccHosts();
+    static std::vector<DistccHost> parseDistccHosts(const std::string& spec);
+
+    // Compiles distcc is running right now, read from the binstate files
+    // distccmon reads ($DISTCC_DIR/state, default ~/.distcc/state)
+    static std::vector<DistccTask> distccTasks();
+};
+
+#endif // DISTRIBUTEDCOMPILE_H
@@ -0,0 +1,80 @@
+#ifndef GITPIPELINE_H
+#define GITPIPELINE_H
+
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class ProcessJob;
+class ProcessSupervisor;
+
+// How one step of a pipeline went
+struct GitStepResult {
+    QString name;          // "commit", "push origin", ...
+    bool ok = false;
+    bool skipped = false;  // Not run because an earlier stage failed
+    int exitCode = -1;
+    QString message;       // Last line git wrote, or the benign outcome
+    qint64 elapsedMs = 0;
+};
+
+// A sequence of git commands in one repository, run as ProcessJobs so the
+// GUI never waits on them. Stages run one after another; the steps of a
+// stage, such as pushes to several remotes, run in parallel. A failed step
+// stops the stages after its own, which are reported as skipped.
+class GitPipeline : public QObject {
+    Q_OBJECT
+
+public:
+    GitPipeline(ProcessSupervisor* supervisor, const QString& workspace, const QString& path,
+                QObject* parent = nullptr);
+
+    // arguments go to git as they are, without a shell. A non-zero exit
+    // whose output contains benignOutput (e.g. "nothing to commit") counts
+    // as success. Remote steps talk to a server and report --progress.
+    void addStage(const QString& name, const QStringList& arguments, const QString& benignOutput = QString(),
+                  bool remote = false);
+    // Adds a step to the stage added last, to run alongside it
+    void addParallelStep(const QString& name, const QStringList& arguments, bool remote = false);
+
+    void start();
+    bool isRunning() const { return running_; }
+    const QString& workspace() const { return workspace_; }
+    const QList<GitStepResult>& results() const { return results_; }
+
+signals:
+    void stepStarted(ProcessJob* job, const QString& step, bool remote);
+    // Complete lines of a step's output
+    void output(const QString& step, const QString& text);
+    // Lines git keeps rewriting with \r, such as "Writing objects:  45% (9/20)"
+    void progress(const QString& step, const QString& text);
+    void stepFinished(const GitStepResult& result);
+    void finished(bool ok);
+
+private:
+    struct Step {
+        QString name;
+        QStringList arguments;
+        QString benignOutput;
+        bool remote = false;
+    };
+
+    void startStage();
+    void onOutput(const QString& step, const QString& text);
+    void onStepFinished(const Step& step, ProcessJob* job);
+
+    ProcessSupervisor* supervisor_;
+    QString workspace_;
+    QString path_;
+    QList<QList<Step>> stages_;
+    int stage_ = 0;
+    int pendingSteps_ = 0;
+    bool failed_ = false;
+    bool running_ = false;
+    QMap<QString, QString> partialLines_; // Per step, text after the last line break
+    QList<GitStepResult> results_;
+};
+
+#endif // GITPIPELINE_H
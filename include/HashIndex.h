@@ -0,0 +1,47 @@
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TreeDigest {
+    uint64_t digest = 0;
+    uint64_t files = 0;
+    uint64_t filesHashed = 0; // Files read this time; the rest were unchanged
+    double seconds = 0.0;
+};
+
+// Content hashes (xxHash64) of every file in a tree that .gitignore does
+// not exclude, combined into one digest of the whole tree. Files are hashed in parallel
+// on the shared WorkStealingPool, and only re-hashed when their inode, mtime
+// or size changed since the index was last saved.
+class HashIndex {
+public:
+    // excludedDirectories are relative to root, e.g. the build directories
+    HashIndex(const std::string& root, const std::string& indexFile,
+              std::vector<std::string> excludedDirectories = {});
+
+    TreeDigest compute();
+
+    static uint64_t xxh64(const void* data, size_t size, uint64_t seed = 0);
+
+private:
+    struct Entry {
+        uint64_t inode = 0;
+        int64_t mtimeNs = 0;
+        uint64_t size = 0;
+        uint64_t hash = 0;
+    };
+
+    void loadIndex();
+    void saveIndex() const;
+
+    std::string root_;
+    std::string indexFile_;
+    std::vector<std::string> excludedDirectories_;
+    std::unordered_map<std::string, Entry> index_; // Keyed by path relative to root_
+};
+
+#endif // HASHINDEX_H
@@ -0,0 +1,37 @@
+#ifndef IGNORERULES_H
+#define IGNORERULES_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// The .gitignore rules in effect for one directory, layered over those of
+// its parents. Later rules win, and a directory's own file wins over its
+// parents', as in git.
+class IgnoreRules {
+public:
+    // The rules of filePath layered over parent; parent itself when the
+    // file is missing or holds no rules. base is the directory of the file,
+    // relative to the root of the walk.
+    static std::shared_ptr<const IgnoreRules> load(const std::string& filePath, const std::string& base,
+                                                   std::shared_ptr<const IgnoreRules> parent);
+
+    // relative is a path relative to the root of the walk
+    bool isIgnored(const std::string& relative, bool isDirectory) const;
+
+private:
+    struct Rule {
+        std::string pattern;
+        bool negated = false;
+        bool directoryOnly = false;
+        bool anchored = false;
+        bool floating = false; // Had a leading "**/": matches below any directory
+        std::vector<std::string> segments; // Of an anchored pattern; "**" spans any number
+    };
+
+    std::string base_; // Directory of the .gitignore, relative to the root
+    std::vector<Rule> rules_;
+    std::shared_ptr<const IgnoreRules> parent_;
+};
+
+#endif // IGNORERULES_H
@@ -0,0 +1,33 @@
+#ifndef LINKERBENCHMARK_H
+#define LINKERBENCHMARK_H
+
+#include <string>
+#include <vector>
+#include "CMakeFileApi.h"
+
+// One link command of a target, ready to be rerun with another linker
+struct LinkCommand {
+    std::string command;          // Shell command line
+    std::string workingDirectory;
+    std::string error;            // Why there is none
+};
+
+// The linkers cppm can select with -fuse-ld / CMAKE_LINKER_TYPE, and a
+// benchmark that reruns a target's own link command with each of them.
+class LinkerBenchmark {
+public:
+    // "bfd", "gold", "lld", "mold", fastest last
+    static const std::vector<std::string>& linkers();
+    // Whether the compiler driver can find the linker's binary on PATH
+    static bool isAvailable(const std::string& linker);
+
+    // From CMakeFiles/<target>.dir/link.txt for Makefile generators, or the
+    // last of `ninja -t commands <target>` for Ninja
+    static LinkCommand linkCommand(const std::string& buildTop, const CMakeTarget& target);
+
+    // command with any linker selection replaced by -fuse-ld=<linker> and
+    // its -o redirected to output, so the real artifact stays as it is
+    static std::string withLinker(const std::string& command, const std::string& linker, const std::string& output);
+};
+
+#endif // LINKERBENCHMARK_H
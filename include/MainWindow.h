@@ -13,7 +13,24 @@
 #include <QSplitter>
 #include <QProcess>
 #include <QProgressBar>
+#include <QDockWidget>
+#include <QTableWidget>
+#include <QTabWidget>
+#include <QTimer>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QMap>
+#include <QSet>
+#include <functional>
+#include <memory>
 #include "WorkspaceManager.h"
+#include "TextSearch.h"
+#include "ProcessSupervisor.h"
+#include "CompileDatabase.h"
+
+class SourceWatcher;
+class GitPipeline;
+class RunChart;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -35,10 +52,22 @@ public slots:
 
     // Build management actions
     void buildWorkspace();
+    // A clean build with clang's -ftime-trace, aggregated into the Compile Profile tab
+    void profileCompile();
     void cleanWorkspace();
     void runWorkspace();
     void editMakefile();
     void setBuildSystem();
+    void setConfiguration();
+    void newConfiguration();
+    void compileSingleFile();
+    void onSourcesChanged(const QStringList& paths, bool overflowed);
+    void editResourceLimits();
+    void tuneParallelism();
+    void editDistributedCompilation();
+    void chooseLinker();
+    // Relinks an executable target with every installed linker and times it
+    void benchmarkLinkers();
 
     // Git versioning actions
     void gitMajorVersion();
@@ -59,31 +88,107 @@ public slots:
     void runScript();
     void installSystemWide();
 
-    // Build process slots
-    void onBuildFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onCmakeFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onBuildOutput();
+    // Search
+    void showSearch();
+    void startSearch();
+    void openSearchResult(int row, int column);
+
+    // Diagnostics
+    void exportTrace();
+    void refreshMetrics();
+    void resetMetrics();
+    void refreshJobs();
+    void showSelectedJobLog();
+    void cancelSelectedJob();
+    void refreshRunHistory();
+
+    // Process slots; output slots are connected to a ProcessJob
+    void onBuildOutput(const QString& text, bool isError);
     void onScriptFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onInstallFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onScriptOutput();
+    void onScriptOutput(const QString& text, bool isError);
     void onCloneFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& repoName, const QString& clonePath);
     void onGithubActionFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onGithubAuthFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& token);
-    void onBrowseReposFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onCreateRepoFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& repoName);
+    void onGithubAuthFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& token, const QByteArray& output);
+    void onBrowseReposFinished(int exitCode, QProcess::ExitStatus exitStatus, const QByteArray& output);
+    void onCreateRepoFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& repoName, const QByteArray& output);
 
 private:
+    // Everything a configure-and-build chain needs once it has left the
+    // slot that started it; the selection may change in the meantime
+    struct BuildRequest {
+        QString workspace;         // Name the jobs are tagged with
+        QString buildDir;
+        QString target;            // Empty for everything
+        bool recordDigest = false; // Only a build of everything may be recorded as up to date
+        std::string configuration;
+        uint64_t digest = 0;       // Of the sources as the build started
+        std::string generator;     // The build system combo's choice, part of the build key
+        int jobs = 1;
+        bool trial = false;        // An autotune build, recorded by ParallelismTuner
+        QString distributedTool;   // distcc or icecc for a distributed build
+        QString compileMemoryLog;  // Where the compile launcher records peaks
+        bool profile = false;      // Traces every compile for the compile profile
+        int64_t profileSinceNs = 0;
+        bool automatic = false;    // Started by watch mode: no dialogs, restarted when sources change again
+        QString historyAction = "build"; // Its RunHistory series; single-file compiles are "compile"
+    };
+    void onCmakeFinished(const BuildRequest& request, const ProcessJob* job, int exitCode, QProcess::ExitStatus exitStatus);
+    void onBuildFinished(const BuildRequest& request, const ProcessJob* job, int exitCode, QProcess::ExitStatus exitStatus);
+    void startBuild(bool profile, bool automatic = false);
+    // The rest of startBuild, once the sources are hashed off the GUI thread
+    void onSourceDigest(BuildRequest request, const TreeDigest& digest, bool upToDate);
+    void startCompile(const CompileCommand& command, const QString& file, bool automatic);
+    // Watch mode: saves in the selected workspace rebuild it, or compile
+    // just the saved file
+    enum class WatchMode { Off, Rebuild, CompileFile };
+    void setWatchMode(WatchMode mode);
+    void updateWatcher();
+    void startWatchBuild();
+    void startMakeBuild(const BuildRequest& request);
+    // What the compile launcher is told: the distributed compiler and whether to trace
+    void setBuildEnvironment(ProcessJob* job, const BuildRequest& request);
+    void showCompileProfile(const BuildRequest& request);
+    struct LinkBenchmarkRun;
+    void runLinkBenchmark(std::shared_ptr<LinkBenchmarkRun> run);
+    void reconfigureWorkspace(const QString& reason);
+    void sampleDistributedCompiles();
+    // Jobs that are not tied to a listed workspace always show their output
+    bool showsOutputOf(const ProcessJob* job);
+    void updateBuildProgress();
+
     void setupUI();
+    void setupMetricsDock();
+    void setupJobsDock();
+    void setupRunHistoryDock();
+    // Appends a finished build or console run to its workspace's RunHistory
+    // and prints what the whole process tree used; action overrides the
+    // job's own in the history
+    void recordRun(const ProcessJob* job, const QString& action = QString());
+    void setupSearchDock();
+    void populateSearchScope();
+    void appendSearchMatches(const std::vector<SearchMatch>& matches);
     void displayWorkspaceInfo(Workspace* ws);
+    void showWorkspaceInfo(const QString& path, const InfoSnapshot& snapshot, bool stale);
+    // Runs off the GUI thread on a private Workspace; false once cancelled
+    static bool collectWorkspaceInfo(Workspace& ws, const CancellationToken& token, InfoSnapshot& snapshot);
     void updateActionButtons();
+    void populateConfigurations();
+    void populateTargets();
     QString getCurrentVersion(Workspace* ws);
     QString incrementVersion(const QString& version, int type); // 0=patch, 1=minor, 2=major
     void createVersionTag(const QString& version);
-    void startMakeBuild();
+    // Asks which remotes to push to when there is more than one
+    bool chooseRemotes(const QString& title, const QString& branch, QStringList& remotes);
+    // Streams the pipeline's output, then reports every step; takes ownership
+    void runGitPipeline(GitPipeline* pipeline, const QString& title, std::function<void()> onSuccess);
+    // verb names the dialog and its button: "Run", "Benchmark"
+    bool chooseRunTarget(const CMakeCodeModel& model, ExecutableInfo& chosen, const QString& verb = "Run");
     void populateScriptList();
     void discoverScripts();
     void createSystemWideInstallScript(const QString& scriptPath);
     void startCloneProcess(const QString& repoUrl, const QString& repoName, const QString& clonePath);
+    void instrumentProcess(ProcessJob* job, const char* name, const QString& detail, const char* metric = nullptr);
     
     struct RepoInfo {
         QString fullName;
@@ -114,6 +219,10 @@ private:
     QPushButton* editMakefileButton_;
     QComboBox* buildSystemCombo_;
     QLabel* buildSystemLabel_;
+    QComboBox* configurationCombo_;
+    QPushButton* newConfigurationButton_;
+    QComboBox* targetCombo_;
+    QPushButton* compileFileButton_;
     
     // Git versioning buttons
     QGroupBox* gitGroup_;
@@ -146,10 +255,57 @@ private:
     bool isGithubAuthenticated_;
     QStringList userRepositories_;
 
-    // Build progress
-    QProcess* buildProcess_;
+    // Child processes and build progress
+    ProcessSupervisor* supervisor_;
     QTextEdit* buildOutput_;
     QProgressBar* buildProgress_;
+    QTabWidget* outputTabs_ = nullptr;
+    QTextEdit* compileProfile_ = nullptr;
+
+    // Search
+    QDockWidget* searchDock_;
+    QLineEdit* searchEdit_;
+    QCheckBox* searchRegexCheck_;
+    QCheckBox* searchCaseCheck_;
+    QListWidget* searchScopeList_;
+    QPushButton* searchButton_;
+    QLabel* searchStatus_;
+    QTableWidget* searchResults_;
+    std::shared_ptr<TextSearch> activeSearch_;
+    uint64_t searchGeneration_ = 0; // Drops batches from a search that was replaced
+    CancellationToken infoToken_;   // Info refresh for the current selection
+    CancellationToken targetsToken_; // Target listing for the current selection
+
+    // Diagnostics
+    QDockWidget* metricsDock_;
+    QTableWidget* metricsTable_;
+    QTimer* metricsTimer_;
+    std::string metricsFile_ = "metrics.txt";
+    QDockWidget* jobsDock_;
+    QTableWidget* jobsTable_;
+    QTextEdit* jobLog_;
+    QPushButton* cancelJobButton_;
+    QTimer* jobsTimer_;
+    QDockWidget* runHistoryDock_ = nullptr;
+    QComboBox* runMetricCombo_ = nullptr;
+    RunChart* runChart_ = nullptr;
+    QTableWidget* runTable_ = nullptr;
+    std::string limitsFile_ = "limits.txt";
+    // distcc's compiles per host, sampled while a distributed build runs
+    QTimer* distributedTimer_ = nullptr;
+    QSet<QString> distributedSeen_;
+    QMap<QString, int> distributedCompiles_;
+
+    // Watch mode
+    WatchMode watchMode_ = WatchMode::Off;
+    QAction* watchOffAction_ = nullptr;
+    SourceWatcher* watcher_ = nullptr;
+    QString watchedWorkspace_;
+    QSet<QString> watchChanges_;   // Saved since the last watch build started
+    bool watchOverflowed_ = false;
+    bool watchRestart_ = false;    // Changes wait for the running build to end, cancelled if it is one of ours
+    QSet<quint64> watchJobs_;      // Ids of the jobs watch mode started; only these are cancelled
+    CompileDatabase compileDatabase_; // Reloaded only when compile_commands.json changes
 };
 
 #endif // MAINWINDOW_H
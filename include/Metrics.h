@@ -0,0 +1,77 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// HDR-style latency histogram: values are bucketed by power of two with 16
+// linear sub-buckets each, so any recorded latency is kept to within ~6%
+// across the range 1us .. ~12 days while using a fixed 600-bucket array.
+class LatencyHistogram {
+public:
+    void record(uint64_t micros);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    uint64_t mean() const { return count_ ? sum_ / count_ : 0; }
+    uint64_t percentile(double p) const; // p in [0, 100]
+
+    std::string serialize() const;
+    bool deserialize(const std::string& text);
+
+private:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxMagnitude = 40;
+    static constexpr int kBucketCount = kSubBuckets + (kMaxMagnitude - kSubBucketBits + 1) * kSubBuckets;
+
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(int index);
+
+    std::array<uint64_t, kBucketCount> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+    uint64_t sum_ = 0;
+};
+
+// Process-wide set of named histograms, persisted between sessions.
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    void record(const std::string& name, uint64_t micros);
+    std::map<std::string, LatencyHistogram> snapshot() const;
+    void reset();
+
+    void loadFromFile(const std::string& filePath);
+    void saveToFile(const std::string& filePath) const;
+
+private:
+    MetricsRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, LatencyHistogram> histograms_;
+};
+
+// Records the lifetime of the scope into the named histogram.
+class ScopedLatency {
+public:
+    explicit ScopedLatency(const char* name);
+    ~ScopedLatency();
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_;
+};
+
+#endif // METRICS_H
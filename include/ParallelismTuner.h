@@ -0,0 +1,79 @@
+#ifndef PARALLELISMTUNER_H
+#define PARALLELISMTUNER_H
+
+#include <string>
+#include <vector>
+
+// One finished build of a workspace at a given -j
+struct ParallelismSample {
+    int jobs = 0;
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0; // User plus system time of the whole build tree
+
+    // Cores kept busy on average; incremental builds differ in how much they
+    // compile, so builds are compared by this rather than by wall time
+    double speedup() const { return wallSeconds > 0.0 ? cpuSeconds / wallSeconds : 0.0; }
+    double efficiency() const { return jobs > 0 ? speedup() / jobs : 0.0; }
+};
+
+struct ParallelismCandidate {
+    int jobs = 0;
+    int builds = 0;
+    double medianSpeedup = 0.0;
+    double medianEfficiency = 0.0;
+};
+
+// Learns the -j a workspace builds fastest with on this machine. While
+// tuning, successive builds cycle through a few candidate job counts; once
+// each has enough builds, the smallest one within 5% of the best speedup is
+// kept. State lives in the workspace's .cppm/parallelism.txt, keyed by host
+// name, so a workspace on a shared disk is tuned per machine.
+class ParallelismTuner {
+public:
+    static constexpr int kBuildsPerCandidate = 2;
+    // Shorter builds are mostly dependency scanning and say little about -j
+    static constexpr double kMinWallSeconds = 5.0;
+
+    explicit ParallelismTuner(const std::string& stateFile);
+
+    bool load();
+    bool save() const;
+
+    bool isTuning() const { return !candidates_.empty(); }
+    // Candidates around the core count, none above what fits into memory
+    void startTuning(int cores, int memoryJobs);
+    void stopTuning();
+    void forget();
+
+    // The settled -j, 0 before tuning finished once
+    int tunedJobs() const { return tunedJobs_; }
+    // -j for the next build: the candidate due for a trial while tuning,
+    // else the settled value, never above memoryJobs
+    int nextJobs(int memoryJobs) const;
+    // Whether a build at jobs counts as a trial
+    bool isTrial(int jobs) const;
+    // Skips the candidates memory no longer allows, which would otherwise
+    // never get their trials; returns true if any were skipped. Tuning may
+    // complete with that, or goes on with memoryJobs as its only candidate.
+    bool skipCandidatesAbove(int memoryJobs);
+
+    // Records a trial build; returns true when it completed tuning
+    bool record(const ParallelismSample& sample);
+
+    std::vector<ParallelismCandidate> candidates() const;
+    const std::vector<ParallelismSample>& samples() const { return samples_; }
+
+private:
+    int settle() const;
+    // Settles once every candidate has its builds
+    bool completeIfSampled();
+
+    std::string stateFile_;
+    std::string host_;
+    std::vector<std::string> otherHosts_; // Lines of other machines, kept as they are
+    std::vector<int> candidates_;
+    std::vector<ParallelismSample> samples_;
+    int tunedJobs_ = 0;
+};
+
+#endif // PARALLELISMTUNER_H
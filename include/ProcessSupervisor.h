@@ -0,0 +1,165 @@
+#ifndef PROCESSSUPERVISOR_H
+#define PROCESSSUPERVISOR_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include "Cgroup.h"
+
+// Resource usage of a finished child and its descendants: those it waited
+// for, and orphans, which the helper adopts and reaps. Any still running
+// when the child exits are not included.
+struct ProcessUsage {
+    bool valid = false; // False if the helper could not report it
+    double userSeconds = 0.0;
+    double systemSeconds = 0.0;
+    long maxRssKb = 0;     // The largest single process
+    long majorFaults = 0;
+    long blockInputs = 0;  // 512-byte blocks read from disk
+    long blockOutputs = 0;
+    long voluntarySwitches = 0;
+    long involuntarySwitches = 0;
+    // Sampled from /proc while the child ran, so processes that start and
+    // end between two samples are missed, as are those leaving its group.
+    // Without /proc the tree's peak is that of its largest process.
+    long processes = 0;     // Child and descendants seen in its process group
+    long peakTreeRssKb = 0; // Highest sum of their resident sets
+    // /proc/<pid>/io of the whole tree; without it storage bytes come from
+    // rusage's block counts
+    uint64_t readChars = 0;     // Bytes passed to read() and the like, cached or not
+    uint64_t writtenChars = 0;
+    uint64_t storageReadBytes = 0;  // Bytes fetched from storage
+    uint64_t storageWriteBytes = 0; // Bytes sent to storage, including page cache writeback
+    // The job's cgroup as the helper left it; invalid unless confined
+    CgroupUsage cgroup;
+};
+
+// One child process owned by the ProcessSupervisor. Its output is kept so
+// that finished handlers and the Jobs dock can read all of it, and it is
+// also forwarded as it arrives.
+class ProcessJob : public QObject {
+    Q_OBJECT
+
+public:
+    enum class State { Pending, Running, Finished, Failed, Cancelled };
+
+    quint64 id() const { return id_; }
+    const QString& workspace() const { return workspace_; }
+    const QString& action() const { return action_; }
+    const QString& description() const { return description_; }
+    // What within the workspace the job works on, e.g. a build directory;
+    // jobs of one action with different scopes do not conflict
+    const QString& scope() const { return scope_; }
+    void setScope(const QString& scope) { scope_ = scope; }
+    State state() const { return state_; }
+    bool isActive() const { return state_ == State::Pending || state_ == State::Running; }
+    int exitCode() const { return exitCode_; }
+    // Frozen once the child exits
+    qint64 elapsedNs() const;
+    qint64 elapsedMs() const { return elapsedNs() / 1000000; }
+    const ProcessUsage& usage() const { return usage_; }
+
+    // Whether the child runs in a cgroup of its own with the resource limits
+    bool isConfined() const { return confined_; }
+    // Live counters of that cgroup; invalid once it is gone or if unconfined
+    CgroupUsage cgroupUsage();
+
+    // Set the working directory and environment here before start()
+    QProcess* process() const { return process_; }
+
+    // Everything the child wrote to stdout so far
+    const QByteArray& standardOutput() const { return standardOutput_; }
+    // stdout and stderr interleaved, the most recent megabyte
+    const QString& log() const { return log_; }
+
+    void start(const QString& program, const QStringList& arguments);
+    // SIGTERM to the child's whole process group, SIGKILL 3 s later
+    void cancel();
+
+signals:
+    void output(const QString& text, bool isError);
+    void finished(int exitCode, QProcess::ExitStatus exitStatus);
+    void stateChanged();
+
+private:
+    friend class ProcessSupervisor;
+    ProcessJob(quint64 id, const QString& workspace, const QString& action, const QString& description,
+               QObject* parent);
+
+    void readOutput(bool isError);
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void signalGroup(int signal);
+    void releaseCgroup();
+
+    quint64 id_;
+    QString workspace_;
+    QString action_;
+    QString description_;
+    QString scope_;
+    QProcess* process_;
+    State state_ = State::Pending;
+    int exitCode_ = 0;
+    QElapsedTimer timer_;
+    qint64 finishedNs_ = -1;
+    bool cancelRequested_ = false;
+    QString usageFile_;
+    ResourceLimits limits_; // Set by the supervisor for confined actions
+    bool confined_ = false;
+    std::string cgroupPath_;
+    std::string scopeName_; // systemd unit, until cgroupPath_ is known
+    ProcessUsage usage_;
+    QByteArray standardOutput_;
+    QString log_;
+};
+
+// Owns any number of child processes, each tagged with the workspace and
+// action it belongs to, so builds, clones and GitHub calls for different
+// workspaces run side by side. Children are started through cppm itself
+// ("--exec-supervised"), which puts them in their own process group, so a
+// cancel reaches everything they spawned, and reports their rusage on exit.
+// Builds and scripts can additionally be confined to a transient cgroup.
+class ProcessSupervisor : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ProcessSupervisor(QObject* parent = nullptr);
+    ~ProcessSupervisor() override;
+
+    // A new job; connect to it and configure process() before start()
+    ProcessJob* create(const QString& workspace, const QString& action, const QString& description);
+
+    // Whether a job with this tag is pending or running
+    bool isRunning(const QString& workspace, const QString& action) const;
+    // Only jobs of that scope, or without one, count
+    bool isRunning(const QString& workspace, const QString& action, const QString& scope) const;
+    // Oldest first; the most recent finished jobs are kept for inspection
+    const QList<ProcessJob*>& jobs() const { return jobs_; }
+
+    // Builds and scripts started from now on run in their own cgroup when
+    // the limits are enabled and the system offers a way to create one
+    void setResourceLimits(const ResourceLimits& limits) { limits_ = limits; }
+    const ResourceLimits& resourceLimits() const { return limits_; }
+
+    void cancelAll();
+    bool waitForAll(int msecs);
+
+    // Body of "cppm --exec-supervised <usage file> [--cgroup <dir> | --scope] <program> [arguments...]";
+    // --scope reports the cgroup systemd-run put the helper in
+    static int execSupervised(int argc, char* argv[]);
+
+signals:
+    void jobsChanged();
+
+private:
+    void pruneFinished();
+
+    QList<ProcessJob*> jobs_;
+    quint64 nextId_ = 1;
+    ResourceLimits limits_;
+};
+
+#endif // PROCESSSUPERVISOR_H
@@ -0,0 +1,74 @@
+#ifndef REAPER_H
+#define REAPER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ReapResult {
+    std::string path;
+    uint64_t bytesReclaimed = 0;
+    uint64_t filesRemoved = 0;
+    uint64_t errors = 0;
+    double seconds = 0.0;
+};
+
+// Deletes directory trees in the background. Directories are scanned and
+// their entries unlinked in parallel by a small pool of threads running at
+// idle I/O priority, so reaping a large build tree never competes with
+// builds or the UI for the disk.
+class Reaper {
+public:
+    using Callback = std::function<void(const ReapResult&)>;
+
+    static Reaper& instance();
+    ~Reaper();
+
+    // Takes ownership of path; onDone runs on a reaper thread.
+    void reap(const std::string& path, Callback onDone = nullptr);
+
+    // Stops the workers; unfinished trees are left on disk to be picked
+    // up again by the next reap of the same trash directory.
+    void shutdown();
+
+private:
+    struct Job;
+    struct DirNode {
+        std::string path;
+        std::shared_ptr<DirNode> parent;
+        std::shared_ptr<Job> job;
+        std::atomic<int> pending{1}; // The scan itself plus one per subdirectory
+    };
+    struct Job {
+        ReapResult result;
+        Callback onDone;
+        uint64_t startNs = 0;
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> files{0};
+        std::atomic<uint64_t> errors{0};
+    };
+
+    Reaper() = default;
+    void startWorkers();
+    void workerLoop();
+    void scanDirectory(const std::shared_ptr<DirNode>& node);
+    void finishNode(std::shared_ptr<DirNode> node);
+    void enqueue(std::shared_ptr<DirNode> node);
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::shared_ptr<DirNode>> queue_;
+    std::vector<std::thread> workers_;
+    std::set<std::string> activePaths_;
+    bool stopping_ = false;
+};
+
+#endif // REAPER_H
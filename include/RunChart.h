@@ -0,0 +1,38 @@
+#ifndef RUNCHART_H
+#define RUNCHART_H
+
+#include <QString>
+#include <QWidget>
+#include <vector>
+#include "RunHistory.h"
+
+class QPaintEvent;
+
+// One RunHistory metric over a workspace's runs, oldest on the left, with
+// a line for builds and one for console runs; failed runs are marked red.
+// Single-file compiles are left out.
+class RunChart : public QWidget {
+    Q_OBJECT
+
+public:
+    enum class Metric { WallTime, CpuTime, PeakMemory, Processes, BytesRead, BytesWritten };
+
+    explicit RunChart(QWidget* parent = nullptr);
+
+    void setRecords(const std::vector<RunRecord>& records);
+    void setMetric(Metric metric);
+
+    static QString metricName(Metric metric);
+    static double value(const RunRecord& record, Metric metric);
+    // "12.3 s", "1.2 GB", "140"
+    static QString formatValue(double value, Metric metric);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    std::vector<RunRecord> records_;
+    Metric metric_ = Metric::WallTime;
+};
+
+#endif // RUNCHART_H
@@ -0,0 +1,52 @@
+#ifndef RUNHISTORY_H
+#define RUNHISTORY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// What one build or console run of a workspace cost, its whole process
+// tree included
+struct RunRecord {
+    int64_t time = 0;     // Unix seconds when it finished
+    std::string action;   // "build", "compile" or "run"
+    int exitCode = 0;
+    double wallSeconds = 0.0;
+    double userSeconds = 0.0;
+    double systemSeconds = 0.0;
+    uint64_t maxRssKb = 0;  // The largest single process
+    uint64_t peakKb = 0;    // The tree at its largest: cgroup memory.peak when confined, else sampled
+    long processes = 0;
+    uint64_t readBytes = 0; // read() and write() traffic, page cache hits included
+    uint64_t writtenBytes = 0;
+    uint64_t storageReadBytes = 0; // What reached the disk: cgroup io.stat when confined, else /proc/<pid>/io
+    uint64_t storageWriteBytes = 0;
+    std::string description;
+
+    double cpuSeconds() const { return userSeconds + systemSeconds; }
+};
+
+// Finished builds and runs of a workspace, oldest first, in its
+// .cppm/runs.txt. Runs are appended as they finish; the file is cut back
+// to the most recent kMaxRecords once it holds twice as many.
+class RunHistory {
+public:
+    static constexpr size_t kMaxRecords = 500;
+
+    explicit RunHistory(const std::string& file);
+
+    bool load();
+    // After load(), so the file is cut back when due
+    bool append(const RunRecord& record);
+
+    const std::vector<RunRecord>& records() const { return records_; }
+
+private:
+    bool rewrite() const;
+
+    std::string file_;
+    std::vector<RunRecord> records_; // The most recent kMaxRecords
+    size_t lines_ = 0;
+};
+
+#endif // RUNHISTORY_H
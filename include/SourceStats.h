@@ -0,0 +1,61 @@
+#ifndef SOURCESTATS_H
+#define SOURCESTATS_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct LanguageStats {
+    std::string language;
+    uint64_t files = 0;
+    uint64_t lines = 0;
+    uint64_t bytes = 0;
+};
+
+struct SourceStatsResult {
+    std::vector<LanguageStats> languages; // Most lines first
+    uint64_t files = 0;
+    uint64_t lines = 0;
+    uint64_t bytes = 0;
+    uint64_t filesCounted = 0;            // Files actually read; the rest came from the cache
+    double seconds = 0.0;
+};
+
+// Per-language file, line and size totals for a source tree. The tree is
+// walked by a pool of threads, newlines are counted with SSE2 over mmapped
+// files, and per-file line counts are cached by (inode, mtime, size) so a
+// repeated scan only reads files that changed.
+class SourceStats {
+public:
+    SourceStats(const std::string& root, const std::string& cacheFile);
+
+    SourceStatsResult compute();
+
+    // Number of '\n' bytes in data
+    static uint64_t countNewlines(const char* data, size_t size);
+
+    // Whether a file name is a recognised source or build file
+    static bool isSourceFile(const std::string& fileName);
+    // Hidden directories, dependencies and build output
+    static bool isSkippedDirectory(const std::string& name);
+    // Editor swap, backup and lock files (foo.swp, foo~, .#foo, #foo#)
+    static bool isScratchFile(const std::string& name);
+
+private:
+    struct CacheEntry {
+        uint64_t inode = 0;
+        int64_t mtimeNs = 0;
+        uint64_t size = 0;
+        uint64_t lines = 0;
+    };
+
+    void loadCache();
+    void saveCache() const;
+
+    std::string root_;
+    std::string cacheFile_;
+    std::unordered_map<std::string, CacheEntry> cache_; // Keyed by path relative to root_
+};
+
+#endif // SOURCESTATS_H
@@ -0,0 +1,65 @@
+#ifndef SOURCEWATCHER_H
+#define SOURCEWATCHER_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class IgnoreRules;
+class QSocketNotifier;
+class QTimer;
+
+// Watches the files of a tree with inotify, the same ones the no-op build
+// check hashes: all but those .gitignore excludes and editor scratch files.
+// A burst of events (an editor's save, a checkout) is coalesced into one
+// changed() once the tree has been quiet for the debounce interval.
+class SourceWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    // excludedDirectories are relative to root, e.g. the build directories
+    SourceWatcher(const std::string& root, std::vector<std::string> excludedDirectories = {},
+                  QObject* parent = nullptr);
+    ~SourceWatcher() override;
+
+    // inotify is Linux only; elsewhere start() always fails
+    static bool isSupported();
+    // False with error() set if inotify is unavailable or the tree needs
+    // more watches than fs.inotify.max_user_watches allows
+    bool start();
+    void stop();
+    bool isWatching() const { return fd_ >= 0; }
+    const QString& error() const { return error_; }
+    int directories() const { return static_cast<int>(directories_.size()); }
+    void setDebounce(int ms);
+
+signals:
+    // Files relative to the root; overflowed when the kernel dropped events,
+    // so anything may have changed
+    void changed(const QStringList& paths, bool overflowed);
+
+private:
+    void readEvents();
+    bool watchTree(const std::string& relative, std::shared_ptr<const IgnoreRules> rules);
+    bool isIgnored(const std::string& directory, const std::string& path, bool isDirectory) const;
+    void flush();
+
+    std::string root_;
+    std::vector<std::string> excludedDirectories_;
+    int fd_ = -1;
+    QSocketNotifier* notifier_ = nullptr;
+    QTimer* debounce_;
+    std::unordered_map<int, std::string> directories_; // Watch descriptor to directory relative to root_
+    // The .gitignore rules in effect in each watched directory, as of when it was first watched
+    std::unordered_map<std::string, std::shared_ptr<const IgnoreRules>> rules_;
+    QSet<QString> pending_;
+    bool overflowed_ = false;
+    QString error_;
+};
+
+#endif // SOURCEWATCHER_H
@@ -0,0 +1,72 @@
+#ifndef TAGINDEX_H
+#define TAGINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A Semantic Versioning 2.0.0 version parsed from a tag such as
+// "v1.4.0-rc.2+build.7"
+struct SemVer {
+    uint64_t major = 0;
+    uint64_t minor = 0;
+    uint64_t patch = 0;
+    std::vector<std::string> preRelease; // Dot-separated identifiers, empty for a release
+    std::string build;                   // Build metadata; no part of the ordering
+    std::string tag;                     // The tag it came from
+
+    // Accepts "X.Y.Z[-pre][+build]" with an optional leading "v"
+    static bool parse(const std::string& text, SemVer& version);
+    // Without the "v": "1.4.0-rc.2+build.7"
+    std::string toString() const;
+    bool isPreRelease() const { return !preRelease.empty(); }
+    // type 0=patch, 1=minor, 2=major. A pre-release bumps to its own release
+    // when that is the next such version (1.3.0-rc.1 -> 1.3.0 for minor),
+    // and build metadata and pre-release identifiers are dropped
+    SemVer bumped(int type) const;
+};
+
+// Precedence as the specification orders it; equal versions that differ in
+// build metadata are ordered by tag name so the order is total
+bool operator<(const SemVer& a, const SemVer& b);
+
+// Every version tag of a repository, sorted, read straight from packed-refs
+// and refs/tags instead of walking history with git describe. The highest
+// version is then a constant-time lookup, and tags cppm creates are added
+// in place rather than by rereading.
+class TagIndex {
+public:
+    // gitDirectory holds refs/ and packed-refs (the common directory of a worktree)
+    explicit TagIndex(const std::string& gitDirectory = std::string());
+
+    const std::string& gitDirectory() const { return gitDirectory_; }
+
+    // Rereads the tags if packed-refs or refs/tags changed since the last
+    // read; false if nothing changed
+    bool refresh();
+    // Inserts a tag that was just created; not a version tag is ignored
+    void add(const std::string& tag);
+
+    // Ascending; empty if there are no version tags
+    const std::vector<SemVer>& versions() const { return versions_; }
+    // The highest version, pre-releases included, or nullptr
+    const SemVer* latest() const { return versions_.empty() ? nullptr : &versions_.back(); }
+    // The highest version that is not a pre-release, or nullptr
+    const SemVer* latestRelease() const { return latestRelease_ < 0 ? nullptr : &versions_[latestRelease_]; }
+
+private:
+    // Modification times of packed-refs and refs/tags
+    using Stamp = std::pair<int64_t, int64_t>;
+    Stamp stamp() const;
+    void load();
+    void updateLatestRelease();
+
+    std::string gitDirectory_;
+    Stamp stamp_;
+    bool loaded_ = false;
+    std::vector<SemVer> versions_;
+    long latestRelease_ = -1; // Index into versions_
+};
+
+#endif // TAGINDEX_H
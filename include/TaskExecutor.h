@@ -0,0 +1,87 @@
+#ifndef TASKEXECUTOR_H
+#define TASKEXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Shared flag handed to a task and kept by whoever may want to stop it.
+// Copies share the flag.
+class CancellationToken {
+public:
+    CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { cancelled_->store(true); }
+    bool isCancelled() const { return cancelled_->load(); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+enum class TaskLane {
+    Interactive, // What the user just asked for: selection, info panel
+    Background   // Bulk work: searches, fetches, indexing
+};
+
+// Central executor for cppm's asynchronous work. Each lane has its own
+// threads and priority queue. Background workers run at a lower nice value
+// and do not start a task while any interactive task is queued or running,
+// so a click is never stuck behind a bulk job. Parallel algorithms that a
+// caller waits on (HashIndex) keep using WorkStealingPool.
+//
+// Cancellation is cooperative: a cancelled task is still invoked, so it can
+// account for itself, and is expected to return early.
+class TaskExecutor {
+public:
+    using Task = std::function<void(const CancellationToken&)>;
+
+    static TaskExecutor& instance();
+
+    // backgroundThreads 0 = hardware concurrency
+    explicit TaskExecutor(unsigned interactiveThreads = 2, unsigned backgroundThreads = 0);
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    // Higher priorities run first within a lane, equal ones in FIFO order
+    CancellationToken submit(TaskLane lane, Task task, int priority = 0);
+    // For several tasks that are cancelled together
+    void submit(TaskLane lane, const CancellationToken& token, Task task, int priority = 0);
+
+    // Cancels every queued and running task, drops those still queued and
+    // joins the workers once the running ones have returned.
+    void shutdown();
+
+private:
+    struct Entry {
+        int priority;
+        uint64_t sequence;
+        CancellationToken token;
+        Task task;
+    };
+    struct Lane {
+        std::vector<Entry> heap;
+        std::condition_variable wake;
+        std::vector<std::thread> workers;
+        std::vector<const CancellationToken*> running; // Per worker, while it runs a task
+    };
+
+    static bool runsLater(const Entry& a, const Entry& b);
+    void workerLoop(TaskLane lane, unsigned index);
+    Lane& lane(TaskLane which) { return which == TaskLane::Interactive ? interactive_ : background_; }
+
+    std::mutex mutex_;
+    Lane interactive_;
+    Lane background_;
+    unsigned interactiveRunning_ = 0;
+    uint64_t nextSequence_ = 0;
+    bool stopping_ = false;
+};
+
+#endif // TASKEXECUTOR_H
@@ -0,0 +1,97 @@
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+#include "TaskExecutor.h"
+
+class IgnoreRules;
+
+struct SearchQuery {
+    std::string pattern;
+    bool regex = false;
+    bool caseSensitive = true;
+    size_t maxMatches = 10000;
+};
+
+struct SearchRoot {
+    std::string name; // Workspace name shown with each match
+    std::string path;
+};
+
+struct SearchMatch {
+    std::string workspace;
+    std::string path;         // Relative to the workspace root
+    uint64_t line = 0;        // 1-based
+    std::string text;
+};
+
+struct SearchSummary {
+    uint64_t filesSearched = 0;
+    uint64_t matches = 0;
+    bool truncated = false;   // Stopped at maxMatches
+    bool cancelled = false;
+    double seconds = 0.0;
+};
+
+// Searches any number of workspace trees at once on the background lane of
+// the TaskExecutor. Directories and file batches are independent tasks,
+// .gitignore rules are honoured along the way, and matches are handed to
+// onMatches in batches as each file batch completes.
+//
+// Literal patterns are located with memmem; regex patterns are prefiltered
+// by the longest literal they must contain, so the regex engine only runs
+// on candidate lines. Both callbacks run on executor threads.
+class TextSearch : public std::enable_shared_from_this<TextSearch> {
+public:
+    using MatchCallback = std::function<void(std::vector<SearchMatch>)>;
+    using FinishedCallback = std::function<void(const SearchSummary&)>;
+
+    static std::shared_ptr<TextSearch> create(const SearchQuery& query, std::vector<SearchRoot> roots,
+                                              MatchCallback onMatches, FinishedCallback onFinished);
+
+    // Returns false if the regex does not compile
+    bool start(std::string* error = nullptr);
+    void cancel();
+
+    // The literal every match of a regex must contain, empty if none is known
+    static std::string requiredLiteral(const std::string& regex);
+
+private:
+    struct FileBatch;
+
+    TextSearch(const SearchQuery& query, std::vector<SearchRoot> roots, MatchCallback onMatches,
+               FinishedCallback onFinished);
+
+    void searchDirectory(size_t rootIndex, std::string relative, std::shared_ptr<const IgnoreRules> rules);
+    void searchFiles(size_t rootIndex, std::vector<std::string> files);
+    void searchBuffer(const SearchRoot& root, const std::string& relative, const char* data, size_t size,
+                      std::vector<SearchMatch>& matches);
+    bool lineMatches(const char* begin, const char* end) const;
+    const char* findCandidate(const char* from, const char* end) const;
+    void spawn(std::function<void()> task);
+    void taskDone();
+
+    SearchQuery query_;
+    std::vector<SearchRoot> roots_;
+    MatchCallback onMatches_;
+    FinishedCallback onFinished_;
+
+    std::string needle_;        // memmem prefilter; empty scans every line
+    std::string foldedNeedle_;  // Lower-case needle for case-insensitive literals
+    std::regex regex_;
+
+    CancellationToken token_;   // Also cancelled once maxMatches is reached
+    std::atomic<int> pending_{0};
+    std::atomic<uint64_t> filesSearched_{0};
+    std::atomic<uint64_t> matchCount_{0};
+    std::atomic<bool> truncated_{false};
+    uint64_t startNs_ = 0;
+};
+
+#endif // TEXTSEARCH_H
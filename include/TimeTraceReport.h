@@ -0,0 +1,49 @@
+#ifndef TIMETRACEREPORT_H
+#define TIMETRACEREPORT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TimeTraceEntry {
+    std::string name;
+    double totalMs = 0.0;
+    uint64_t count = 0;
+    double maxMs = 0.0;
+};
+
+struct TimeTraceSummary {
+    size_t traces = 0;
+    size_t unreadable = 0;
+    double compileMs = 0.0;  // Sum of every translation unit's compile
+    double frontendMs = 0.0;
+    double backendMs = 0.0;
+    double seconds = 0.0;    // Time the aggregation itself took
+    std::vector<TimeTraceEntry> files;          // Slowest translation units
+    std::vector<TimeTraceEntry> headers;        // Parsing, including what the header includes
+    std::vector<TimeTraceEntry> instantiations; // Per full template-id
+    std::vector<TimeTraceEntry> templateSets;   // Per template, over all its arguments
+    std::vector<TimeTraceEntry> functions;      // Optimization per function
+};
+
+// Aggregates the JSON files clang's -ftime-trace writes next to each
+// object file, in the spirit of ClangBuildAnalyzer.
+class TimeTraceReport {
+public:
+    // Set for profile builds; the compile launcher then adds -ftime-trace
+    // to every clang call
+    static constexpr const char* kLauncherVariable = "CPPM_TIME_TRACE";
+
+    // Traces below buildDir whose object file sits next to them, written
+    // at or after sinceNs (wall clock), so stale traces of an earlier build
+    // are left out
+    static std::vector<std::string> findTraces(const std::string& buildDir, int64_t sinceNs);
+
+    // Parses the traces on the WorkStealingPool; each list keeps its top entries
+    static TimeTraceSummary aggregate(const std::vector<std::string>& traces, const std::string& buildDir,
+                                      size_t top = 20);
+
+    static std::string format(const TimeTraceSummary& summary);
+};
+
+#endif // TIMETRACEREPORT_H
@@ -0,0 +1,77 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A single completed span. Names and categories must be string literals;
+// the optional detail (e.g. the command line of a runCommand call) is
+// copied into a fixed buffer so recording never allocates.
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t startNs;
+    uint64_t durationNs;
+    char detail[96];
+};
+
+// Collects spans into one fixed-size ring buffer per thread and exports them
+// in the Chrome trace-event format (chrome://tracing, Perfetto).
+class Tracer {
+public:
+    static Tracer& instance();
+
+    // Nanoseconds since the tracer was created (monotonic clock)
+    static uint64_t now();
+
+    void record(const char* name, const char* category, uint64_t startNs, uint64_t durationNs,
+                std::string_view detail = std::string_view());
+    void setThreadName(const std::string& name);
+
+    bool exportChromeTrace(const std::string& filePath) const;
+    size_t eventCount() const;
+
+private:
+    static constexpr size_t kRingCapacity = 8192;
+
+    struct ThreadBuffer {
+        std::mutex mutex; // Only contended while exporting
+        uint32_t tid = 0;
+        std::string threadName;
+        std::vector<TraceEvent> events;
+        uint64_t written = 0;
+    };
+
+    Tracer() = default;
+    ThreadBuffer& localBuffer();
+
+    mutable std::mutex registryMutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+// RAII span: records [construction, destruction) on the current thread. The
+// detail is truncated into the span itself, so a span never allocates.
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const char* category = "app", std::string_view detail = std::string_view());
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    char detail_[sizeof(TraceEvent::detail)];
+    uint64_t start_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(...) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(__VA_ARGS__)
+
+#endif // TRACE_H
@@ -0,0 +1,55 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. Tasks
+// submitted from a worker go to that worker's deque and are run newest
+// first, which keeps recursive work (e.g. directory walks) cache-friendly;
+// idle workers steal the oldest task from a busy worker's deque.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    static WorkStealingPool& instance();
+
+    explicit WorkStealingPool(unsigned threadCount = 0); // 0 = hardware concurrency
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task);
+
+    // Stops the workers; tasks still queued are dropped.
+    void shutdown();
+
+    unsigned threadCount() const { return static_cast<unsigned>(queues_.size()); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popLocal(unsigned index, Task& task);
+    bool steal(unsigned thief, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<unsigned> nextQueue_{0};
+    bool stopping_ = false;
+};
+
+#endif // WORKSTEALINGPOOL_H
@@ -4,6 +4,14 @@
 #include <string>
 #include <filesystem>
 #include <vector>
+#include <functional>
+#include <unordered_map>
+#include "SourceStats.h"
+#include "HashIndex.h"
+#include "CMakeFileApi.h"
+#include "MetadataScanner.h"
+#include "CompileMemory.h"
+#include "TagIndex.h"
 
 enum class BuildSystem {
     None,
@@ -14,6 +22,44 @@ enum class BuildSystem {
     Script  // For build.sh, build.py, etc.
 };
 
+struct ReapResult;
+
+// Everything cppm derives from the names in the workspace root, gathered
+// from a single directory read.
+struct WorkspaceProfile {
+    BuildSystem buildSystem = BuildSystem::None;
+    std::vector<std::string> buildScripts;     // Most preferred first
+    std::vector<std::string> buildDirectories; // Existing output directories, most likely first
+    bool hasDocsDirectory = false;
+    bool hasReadme = false;
+    bool hasWorkflows = false;
+    bool hasScriptsDirectory = false;
+};
+
+// A named CMake configuration with its own build directory and cache, so
+// Debug, Release, sanitizer and cross builds can live side by side.
+struct BuildConfiguration {
+    std::string name;
+    std::string buildType;                 // CMAKE_BUILD_TYPE, empty for the generator default
+    std::string directory;                 // Relative to the workspace root
+    std::string toolchainFile;             // Optional CMAKE_TOOLCHAIN_FILE
+    std::vector<std::string> cacheEntries; // Extra -D entries, e.g. "CMAKE_CXX_FLAGS=-fsanitize=address"
+    bool builtin = false;
+};
+
+// One titled block of the workspace info panel
+struct InfoSection {
+    std::string title;
+    std::string body;
+};
+
+// What the info panel showed last, so it can be shown again before it is
+// recomputed
+struct InfoSnapshot {
+    std::string version;
+    std::vector<InfoSection> sections;
+};
+
 struct ExecutableInfo {
     std::string name;
     std::string path;
@@ -30,11 +76,17 @@ public:
     bool exists() const;
 
     // Build system detection
+    WorkspaceProfile getProfile() const;
     BuildSystem detectBuildSystem() const;
     std::string getBuildSystemName() const;
     std::vector<std::string> getBuildScripts() const;
     
-    // Executable detection
+    // Per-language file and line counts; only changed files are re-read
+    SourceStatsResult getSourceStats() const;
+
+    // Executable detection; CMake workspaces use the File API reply when
+    // there is one instead of walking the build tree
+    bool getCodeModel(CMakeCodeModel& model) const;
     std::vector<ExecutableInfo> findExecutables() const;
     ExecutableInfo findMainExecutable() const;
 
@@ -42,23 +94,125 @@ public:
     bool gitInit();
     bool gitAdd();
     bool gitCommit(const std::string& message);
+    // .git, or the repository it points to for worktrees and submodules;
+    // where config, refs and packed-refs are
+    std::filesystem::path gitCommonDirectory() const;
+    // Remotes named in the repository's config, in the order they appear
+    std::vector<std::string> getGitRemotes() const;
+    // Version tags, reread only when packed-refs or refs/tags changed
+    const TagIndex& getTagIndex() const;
+    // Records a tag cppm just created without rereading the others
+    void addTag(const std::string& tag);
+    // Highest version tag without its "v" (pre-releases included), or "0.0.0"
+    std::string getCurrentVersion() const;
 
     // Build operations
+    bool prepareConfigure() const; // Creates the build directory and the CMake File API query
     bool configureBuild(); // Run cmake or equivalent
+    // Shares the probe results of the last configure with other workspaces on the same toolchain
+    bool recordConfigureCache() const;
     bool build();
-    bool clean();
+    // Moves the build directory into the trash and deletes it in the
+    // background; onReaped runs on a reaper thread once the space is freed.
+    // A directory that cannot be moved is left alone, never deleted in place.
+    bool clean(std::function<void(const ReapResult&)> onReaped = nullptr, std::string* error = nullptr);
     std::string getBuildDirectory() const;
     std::string getPreferredBuildCommand() const;
 
+    // Targets that can be built on their own, and where to find the
+    // per-file compile commands (empty if there are none)
+    std::vector<std::string> getBuildTargets();
+    std::string getCompileDatabasePath() const;
+
+    // Up-to-date checks: the digest of the tree, keyed with the settings of
+    // the configuration (buildKey), is compared with the one recorded after
+    // its last successful build
+    TreeDigest computeSourceDigest() const;
+    // sourceDigest folded with what else decides the build's output: the
+    // configure arguments, generator, linker, distributed settings, the
+    // compiler environment and the configuration's CMakeCache.txt
+    uint64_t buildKey(const std::string& configuration, uint64_t sourceDigest, const std::string& generator) const;
+    bool isBuildUpToDate(uint64_t key) const;
+    void recordSuccessfulBuild(const std::string& configuration, uint64_t key);
+    // The next build of the configuration runs whatever changed, e.g. after Clean or a reconfigure
+    void forgetSuccessfulBuild(const std::string& configuration);
+    // Build trees of every configuration, relative to the root; outputs, not sources
+    std::vector<std::string> getBuildDirectories() const;
+
+    // Build configurations
+    std::vector<BuildConfiguration> getConfigurations() const;
+    BuildConfiguration getActiveConfiguration() const;
+    bool setActiveConfiguration(const std::string& name);
+    bool addConfiguration(const BuildConfiguration& config, std::string* error = nullptr);
+    // A build directory must be relative, below the root and not the root
+    // itself, .cppm, .git or a directory holding sources, since Clean
+    // throws it away
+    bool checkBuildDirectory(const std::string& directory, std::string& error) const;
+    bool removeConfiguration(const std::string& name);
+    std::string getConfigurationDirectory(const BuildConfiguration& config) const;
+    // compileLauncher (program and arguments) goes in front of every compiler
+    // call of a fresh build directory, ahead of any launcher the configuration
+    // or the environment (CMAKE_<LANG>_COMPILER_LAUNCHER, e.g. ccache) sets
+    std::vector<std::string> getConfigureArguments(const BuildConfiguration& config,
+                                                   const std::vector<std::string>& compileLauncher = {}) const;
+
+    // Per-compile peak memory recorded by the compile launcher, in .cppm
+    std::string compileMemoryLog() const;
+    // Script in .cppm that build trees are configured with as their compile
+    // launcher: it runs the one a build names in its environment
+    // (CompileMemory::kLauncherVariable) and otherwise the compiler itself.
+    // Empty if it cannot be written.
+    std::string compileLauncherShim() const;
+    // Parallel jobs for the next build from that record and MemAvailable
+    JobsChoice chooseBuildJobs() const;
+    // Learned -j of this workspace (ParallelismTuner), in .cppm
+    std::string parallelismFile() const;
+    // DistributedSettings of this workspace, in .cppm
+    std::string distributedSettingsFile() const;
+    // Resources of each finished build and run (RunHistory), in .cppm
+    std::string runHistoryFile() const;
+    // "bfd", "gold", "lld" or "mold" (LinkerBenchmark::linkers()), empty for
+    // the toolchain's default; kept in .cppm/linker.txt
+    std::string getLinker() const;
+    bool setLinker(const std::string& linker);
+
     std::string runCommand(const std::string& cmd);
+    // Runs cmd from the workspace root without changing the process's
+    // working directory, so it is safe off the GUI thread
+    std::string runInWorkspace(const std::string& cmd);
+
+    // Last computed info panel, kept in .cppm/info.txt
+    bool loadInfoSnapshot(InfoSnapshot& snapshot) const;
+    void saveInfoSnapshot(const InfoSnapshot& snapshot) const;
+
+    // Per-workspace directory for cppm's own state (.cppm, git-ignored),
+    // created by stateDirectory() and prepareStateDirectory(). The file
+    // accessors above only name paths in it: whoever writes them through
+    // another class prepares the directory first.
+    std::filesystem::path stateDirectory() const;
+    bool prepareStateDirectory() const;
 
 private:
     std::string path_;
-    std::filesystem::path buildDir_;
-    mutable BuildSystem cachedBuildSystem_ = BuildSystem::None;
-    mutable bool buildSystemCached_ = false;
+    // Reused until the root directory's mtime changes
+    mutable WorkspaceProfile profile_;
+    mutable int64_t profileStamp_ = -1;
+
+    // Loaded lazily from .cppm/configurations.txt
+    mutable std::vector<BuildConfiguration> configurations_;
+    mutable std::string activeConfiguration_;
+    mutable bool configurationsLoaded_ = false;
+
+    mutable TagIndex tagIndex_;
+
+    void loadConfigurations() const;
+    void saveConfigurations() const;
+    std::unordered_map<std::string, uint64_t> loadBuildDigests() const;
+    void saveBuildDigests(const std::unordered_map<std::string, uint64_t>& digests) const;
+    std::filesystem::path activeBuildDirectory() const;
     
-    bool isExecutableFile(const std::filesystem::path& file) const;
+    void collectExecutables(std::vector<FileProbe>& candidates, std::vector<ExecutableInfo>& executables) const;
+    bool isExecutableFile(const FileProbe& probe) const;
     bool isLikelyGUIApp(const std::filesystem::path& file) const;
 };
 
@@ -8,15 +8,15 @@ set -e
 echo "🚀 Installing C++ Workspace Manager system-wide..."
 
 # Check if executable exists
-if [ ! -f "build/cppm" ]; then
-    echo "❌ Error: build/cppm not found. Please build the project first."
+if [ ! -f "build/cppm" ] || [ ! -f "build/cppm-launcher" ]; then
+    echo "❌ Error: build/cppm or build/cppm-launcher not found. Please build the project first."
     exit 1
 fi
 
 # Install executable to /usr/local/bin
 echo "📦 Installing executable to /usr/local/bin..."
-sudo cp build/cppm /usr/local/bin/
-sudo chmod +x /usr/local/bin/cppm
+sudo cp build/cppm build/cppm-launcher /usr/local/bin/
+sudo chmod +x /usr/local/bin/cppm /usr/local/bin/cppm-launcher
 echo "✅ Executable installed successfully"
 
 # Create desktop entry
@@ -45,5 +45,5 @@ echo "✅ You can now run 'cppm' from anywhere in the terminal"
 echo "✅ You can also find 'C++ Workspace Manager' in your application menu"
 echo ""
 echo "To uninstall, run:"
-echo "  sudo rm /usr/local/bin/cppm"
+echo "  sudo rm /usr/local/bin/cppm /usr/local/bin/cppm-launcher"
 echo "  rm ~/.local/share/applications/cppm.desktop"
\ No newline at end of file
@@ -43,7 +43,7 @@ tar -czf "$PACKAGE_DIR/${PROJECT_NAME}-${VERSION}-source.tar.gz" \
 echo "🐧 Creating Linux binary package..."
 # Create Linux binary package
 mkdir -p "$PACKAGE_DIR/linux-x64"
-cp "$BUILD_DIR/cppm" "$PACKAGE_DIR/linux-x64/"
+cp "$BUILD_DIR/cppm" "$BUILD_DIR/cppm-launcher" "$PACKAGE_DIR/linux-x64/"
 cp README.md "$PACKAGE_DIR/linux-x64/" 2>/dev/null || true
 cp LICENSE "$PACKAGE_DIR/linux-x64/" 2>/dev/null || true
 
@@ -51,8 +51,8 @@ cp LICENSE "$PACKAGE_DIR/linux-x64/" 2>/dev/null || true
 cat > "$PACKAGE_DIR/linux-x64/install.sh" << 'EOF'
 #!/bin/bash
 echo "Installing CppWorkspaceManager..."
-sudo cp cppm /usr/local/bin/
-sudo chmod +x /usr/local/bin/cppm
+sudo cp cppm cppm-launcher /usr/local/bin/
+sudo chmod +x /usr/local/bin/cppm /usr/local/bin/cppm-launcher
 echo "✅ CppWorkspaceManager installed to /usr/local/bin/cppm"
 echo "Run 'cppm' to start the application"
 EOF
@@ -62,7 +62,7 @@ chmod +x "$PACKAGE_DIR/linux-x64/install.sh"
 cat > "$PACKAGE_DIR/linux-x64/uninstall.sh" << 'EOF'
 #!/bin/bash
 echo "Uninstalling CppWorkspaceManager..."
-sudo rm -f /usr/local/bin/cppm
+sudo rm -f /usr/local/bin/cppm /usr/local/bin/cppm-launcher
 echo "✅ CppWorkspaceManager uninstalled"
 EOF
 chmod +x "$PACKAGE_DIR/linux-x64/uninstall.sh"
@@ -76,7 +76,7 @@ cd ..
 echo "📱 Creating AppImage (if linuxdeploy available)..."
 if command -v linuxdeploy &> /dev/null; then
     mkdir -p "$PACKAGE_DIR/appimage"
-    cp "$BUILD_DIR/cppm" "$PACKAGE_DIR/appimage/"
+    cp "$BUILD_DIR/cppm" "$BUILD_DIR/cppm-launcher" "$PACKAGE_DIR/appimage/"
     
     # Create desktop file
     cat > "$PACKAGE_DIR/appimage/cppm.desktop" << EOF
@@ -147,7 +147,7 @@ make -j$(sysctl -n hw.ncpu)
 ```bash
 # Create app bundle structure
 mkdir -p CppWorkspaceManager.app/Contents/MacOS
-cp cppm CppWorkspaceManager.app/Contents/MacOS/
+cp cppm cppm-launcher CppWorkspaceManager.app/Contents/MacOS/
 
 # Create Info.plist
 cat > CppWorkspaceManager.app/Contents/Info.plist << 'PLIST'
@@ -205,7 +205,7 @@ RUN apt-get update && apt-get install -y \
     && rm -rf /var/lib/apt/lists/*
 
 # Copy built application
-COPY --from=builder /src/build/cppm /usr/local/bin/
+COPY --from=builder /src/build/cppm /src/build/cppm-launcher /usr/local/bin/
 
 # Create user for running the app
 RUN useradd -m -s /bin/bash cppwm
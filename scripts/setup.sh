@@ -100,6 +100,7 @@ echo ""
 echo "📁 Project structure:"
 echo "   build/           - Build output directory"
 echo "   build/cppm       - Main executable"
+echo "   build/cppm-launcher - Compile launcher, kept next to cppm"
 echo "   scripts/         - Development scripts"
 echo ""
 echo "🚀 To run the application:"
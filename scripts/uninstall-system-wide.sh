@@ -11,6 +11,7 @@ echo "🗑️  Uninstalling C++ Workspace Manager from system..."
 if [ -f "/usr/local/bin/cppm" ]; then
     echo "📦 Removing executable from /usr/local/bin..."
     sudo rm /usr/local/bin/cppm
+    sudo rm -f /usr/local/bin/cppm-launcher
     echo "✅ Executable removed successfully"
 else
     echo "ℹ️  Executable not found in /usr/local/bin"
@@ -0,0 +1,145 @@
+#include "CMakeFileApi.h"
+#include "Trace.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+const char* const kClientQuery = ".cmake/api/v1/query/client-cppm/query.json";
+const char* const kReplyDirectory = ".cmake/api/v1/reply";
+
+QJsonObject readJsonObject(const std::filesystem::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open()) {
+        return QJsonObject();
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return QJsonDocument::fromJson(QByteArray::fromStdString(buffer.str())).object();
+}
+
+bool linksGuiToolkit(const QJsonObject& target) {
+    static const char* const toolkits[] = {"Qt5Widgets", "Qt6Widgets", "Qt5Quick", "Qt6Quick",
+                                           "gtk", "SDL", "glfw", "wx_", "fltk"};
+    const QJsonArray fragments = target.value("link").toObject().value("commandFragments").toArray();
+    for (const auto& fragment : fragments) {
+        QString text = fragment.toObject().value("fragment").toString();
+        for (const char* toolkit : toolkits) {
+            if (text.contains(toolkit, Qt::CaseInsensitive)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+CMakeFileApi::CMakeFileApi(const std::string& buildDirectory) : buildDirectory_(buildDirectory) {
+}
+
+bool CMakeFileApi::writeQuery() const {
+    std::filesystem::path query = std::filesystem::path(buildDirectory_) / kClientQuery;
+    std::error_code ec;
+    if (std::filesystem::exists(query, ec)) {
+        return true;
+    }
+    std::filesystem::create_directories(query.parent_path(), ec);
+    std::ofstream out(query);
+    out << "{ \"requests\": [ { \"kind\": \"codemodel\", \"version\": 2 } ] }" << std::endl;
+    return out.good();
+}
+
+std::string CMakeFileApi::latestReplyIndex() const {
+    // Index files are named by timestamp, so the greatest name is the newest
+    std::string latest;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(buildDirectory_) / kReplyDirectory, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("index-", 0) == 0 && name > latest) {
+            latest = name;
+        }
+    }
+    return latest;
+}
+
+bool CMakeFileApi::hasReply() const {
+    return !latestReplyIndex().empty();
+}
+
+bool CMakeFileApi::readCodeModel(CMakeCodeModel& model, const std::string& configuration) const {
+    TRACE_SCOPE("CMakeFileApi::readCodeModel", "scan", buildDirectory_);
+    std::string indexName = latestReplyIndex();
+    if (indexName.empty()) {
+        return false;
+    }
+
+    std::filesystem::path replyDir = std::filesystem::path(buildDirectory_) / kReplyDirectory;
+    QJsonObject index = readJsonObject(replyDir / indexName);
+    const QJsonArray responses = index.value("reply").toObject().value("client-cppm").toObject()
+                                      .value("query.json").toObject().value("responses").toArray();
+
+    QString codemodelFile;
+    for (const auto& response : responses) {
+        QJsonObject object = response.toObject();
+        if (object.value("kind").toString() == "codemodel") {
+            codemodelFile = object.value("jsonFile").toString();
+            break;
+        }
+    }
+    if (codemodelFile.isEmpty()) {
+        return false;
+    }
+
+    QJsonObject codemodel = readJsonObject(replyDir / codemodelFile.toStdString());
+    const QJsonArray configurations = codemodel.value("configurations").toArray();
+    if (configurations.isEmpty()) {
+        return false;
+    }
+
+    // Single-config generators report exactly one configuration
+    QJsonObject selected = configurations.at(0).toObject();
+    for (const auto& config : configurations) {
+        if (config.toObject().value("name").toString().toStdString() == configuration) {
+            selected = config.toObject();
+            break;
+        }
+    }
+
+    std::filesystem::path buildTop = codemodel.value("paths").toObject().value("build").toString().toStdString();
+    if (buildTop.empty()) {
+        buildTop = buildDirectory_;
+    }
+
+    model = CMakeCodeModel();
+    const QJsonArray projects = selected.value("projects").toArray();
+    if (!projects.isEmpty()) {
+        model.projectName = projects.at(0).toObject().value("name").toString().toStdString();
+    }
+
+    const QJsonArray targets = selected.value("targets").toArray();
+    for (const auto& targetRef : targets) {
+        QJsonObject target = readJsonObject(replyDir / targetRef.toObject().value("jsonFile").toString().toStdString());
+        if (target.isEmpty()) {
+            continue;
+        }
+
+        CMakeTarget info;
+        info.name = target.value("name").toString().toStdString();
+        info.type = target.value("type").toString().toStdString();
+        info.linksGuiToolkit = linksGuiToolkit(target);
+        std::filesystem::path targetBuild = target.value("paths").toObject().value("build").toString().toStdString();
+        info.buildDirectory = (targetBuild.is_absolute() ? targetBuild : buildTop / targetBuild).lexically_normal().string();
+        const QJsonArray artifacts = target.value("artifacts").toArray();
+        for (const auto& artifact : artifacts) {
+            std::filesystem::path path = artifact.toObject().value("path").toString().toStdString();
+            info.artifacts.push_back((path.is_absolute() ? path : buildTop / path).string());
+        }
+        model.targets.push_back(std::move(info));
+    }
+    return true;
+}
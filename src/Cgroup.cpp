@@ -0,0 +1,299 @@
+#include "Cgroup.h"
+#include <atomic>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const kCgroupRoot = "/sys/fs/cgroup";
+
+bool readFile(const std::string& path, std::string& contents) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+bool writeFile(const std::string& path, const std::string& contents) {
+    // Control files take the whole value in a single write and report
+    // rejected values as its error
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool written = write(fd, contents.data(), contents.size()) == static_cast<ssize_t>(contents.size());
+    close(fd);
+    return written;
+}
+
+bool readNumber(const std::string& path, uint64_t& value) {
+    std::string text;
+    if (!readFile(path, text) || text.empty() || text.compare(0, 3, "max") == 0) {
+        return false;
+    }
+    value = std::strtoull(text.c_str(), nullptr, 10);
+    return true;
+}
+
+bool isUnifiedHierarchy() {
+    return access((std::string(kCgroupRoot) + "/cgroup.controllers").c_str(), R_OK) == 0;
+}
+
+bool hasExecutable(const char* name) {
+    const char* path = std::getenv("PATH");
+    std::stringstream directories(path ? path : "/usr/bin:/bin");
+    std::string directory;
+    while (std::getline(directories, directory, ':')) {
+        if (!directory.empty() && access((directory + "/" + name).c_str(), X_OK) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool hasSystemdUserManager() {
+    // systemd-run --user talks to the user manager over the session bus;
+    // checking for both sockets avoids spawning a probe on the GUI thread
+    const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+    if (!runtime || !*runtime) {
+        return false;
+    }
+    std::string base = runtime;
+    return access((base + "/systemd/private").c_str(), F_OK) == 0 &&
+           access((base + "/bus").c_str(), F_OK) == 0 &&
+           hasExecutable("systemd-run");
+}
+
+// What a delegated job group needs to carry its limits
+const char* const kControllers[] = {"cpu", "memory", "io"};
+
+bool listsController(const std::string& list, const std::string& controller) {
+    std::stringstream names(list);
+    std::string name;
+    while (names >> name) {
+        if (name == controller) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Whether cppm could create job groups below its own; only looks. The
+// controllers must reach its group, with io.weight (blk-iocost) among them.
+bool canDelegate() {
+    std::string own = Cgroup::pathOf(getpid());
+    if (own.empty() || own == kCgroupRoot ||
+        access(own.c_str(), W_OK) != 0 ||
+        access((own + "/cgroup.subtree_control").c_str(), W_OK) != 0 ||
+        access((own + "/io.weight").c_str(), F_OK) != 0) {
+        return false;
+    }
+    std::string controllers;
+    if (!readFile(own + "/cgroup.controllers", controllers)) {
+        return false;
+    }
+    for (const char* controller : kControllers) {
+        if (!listsController(controllers, controller)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string delegatedRoot;
+std::atomic<bool> delegationFailed{false};
+
+bool prepareDelegation() {
+    std::string own = Cgroup::pathOf(getpid());
+    std::string leaf = own + "/cppm";
+    mkdir(leaf.c_str(), 0755);
+    if (!Cgroup::enter(leaf)) {
+        return false;
+    }
+
+    std::string controllers;
+    readFile(own + "/cgroup.controllers", controllers);
+    for (const char* controller : {"cpu", "memory", "io", "pids"}) {
+        if (listsController(controllers, controller)) {
+            writeFile(own + "/cgroup.subtree_control", std::string("+") + controller);
+        }
+    }
+    // The writes fail with EBUSY while some other process still lives in
+    // own, so what took effect is read back rather than assumed
+    std::string enabled;
+    readFile(own + "/cgroup.subtree_control", enabled);
+    for (const char* controller : kControllers) {
+        if (!listsController(enabled, controller)) {
+            return false;
+        }
+    }
+    delegatedRoot = own;
+    return true;
+}
+
+} // namespace
+
+void ResourceLimits::loadFromFile(const std::string& filePath) {
+    std::ifstream in(filePath);
+    std::string key;
+    uint64_t value;
+    while (in >> key >> value) {
+        if (key == "enabled") enabled = value != 0;
+        else if (key == "cpu_weight") cpuWeight = static_cast<int>(value);
+        else if (key == "memory_max_mb") memoryMaxMb = value;
+        else if (key == "io_weight") ioWeight = static_cast<int>(value);
+    }
+}
+
+void ResourceLimits::saveToFile(const std::string& filePath) const {
+    std::ofstream out(filePath);
+    out << "enabled " << (enabled ? 1 : 0) << "\n"
+        << "cpu_weight " << cpuWeight << "\n"
+        << "memory_max_mb " << memoryMaxMb << "\n"
+        << "io_weight " << ioWeight << "\n";
+}
+
+Cgroup::Method Cgroup::availableMethod() {
+    static std::once_flag once;
+    static Method method = Method::None;
+    std::call_once(once, []() {
+        if (!isUnifiedHierarchy()) {
+            method = Method::None;
+        } else if (hasSystemdUserManager()) {
+            method = Method::SystemdScope;
+        } else if (canDelegate()) {
+            method = Method::Delegated;
+        }
+    });
+    // A delegation the kernel refused is no method at all
+    if (method == Method::Delegated && delegationFailed) {
+        return Method::None;
+    }
+    return method;
+}
+
+Cgroup::Method Cgroup::prepare() {
+    Method method = availableMethod();
+    if (method != Method::Delegated) {
+        return method;
+    }
+    static std::once_flag once;
+    std::call_once(once, []() { delegationFailed = !prepareDelegation(); });
+    return delegationFailed ? Method::None : Method::Delegated;
+}
+
+const char* Cgroup::methodName(Method method) {
+    switch (method) {
+    case Method::SystemdScope: return "systemd user scope";
+    case Method::Delegated: return "delegated cgroup";
+    case Method::None: break;
+    }
+    return "not available";
+}
+
+std::string Cgroup::pathOf(pid_t pid) {
+    if (!isUnifiedHierarchy()) {
+        return std::string();
+    }
+    std::ifstream in("/proc/" + std::to_string(pid) + "/cgroup");
+    std::string line;
+    while (std::getline(in, line)) {
+        // The unified hierarchy is the "0::/path" entry
+        if (line.compare(0, 3, "0::") == 0) {
+            std::string relative = line.substr(3);
+            return relative == "/" ? std::string(kCgroupRoot) : kCgroupRoot + relative;
+        }
+    }
+    return std::string();
+}
+
+std::string Cgroup::createJobGroup(const std::string& name, const ResourceLimits& limits) {
+    if (prepare() != Method::Delegated) {
+        return std::string();
+    }
+    std::string path = delegatedRoot + "/" + name;
+    if (mkdir(path.c_str(), 0755) != 0) {
+        return std::string();
+    }
+    // Each limit is read back: a group the kernel took only some of them
+    // for would run the job with less confinement than was asked for
+    uint64_t cpuWeight = 0;
+    std::string ioWeight;
+    std::string expectedIoWeight = "default " + std::to_string(limits.ioWeight);
+    bool applied = writeFile(path + "/cpu.weight", std::to_string(limits.cpuWeight)) &&
+                   readNumber(path + "/cpu.weight", cpuWeight) &&
+                   cpuWeight == static_cast<uint64_t>(limits.cpuWeight) &&
+                   writeFile(path + "/io.weight", expectedIoWeight) &&
+                   readFile(path + "/io.weight", ioWeight) &&
+                   ioWeight.compare(0, expectedIoWeight.size() + 1, expectedIoWeight + "\n") == 0;
+    if (applied && limits.memoryMaxMb > 0) {
+        uint64_t memoryMax = 0;
+        applied = writeFile(path + "/memory.max", std::to_string(limits.memoryMaxMb * 1024 * 1024)) &&
+                  readNumber(path + "/memory.max", memoryMax) && memoryMax == limits.memoryMaxMb * 1024 * 1024;
+    }
+    if (!applied) {
+        rmdir(path.c_str());
+        return std::string();
+    }
+    return path;
+}
+
+void Cgroup::removeJobGroup(const std::string& path) {
+    // Fails while a daemonized descendant still lives there
+    rmdir(path.c_str());
+}
+
+bool Cgroup::enter(const std::string& path) {
+    return writeFile(path + "/cgroup.procs", "0");
+}
+
+bool Cgroup::readUsage(const std::string& path, CgroupUsage& usage) {
+    usage = CgroupUsage();
+    std::string text;
+    if (path.empty() || !readFile(path + "/cpu.stat", text)) {
+        return false;
+    }
+    std::stringstream cpu(text);
+    std::string key;
+    uint64_t value;
+    while (cpu >> key >> value) {
+        if (key == "usage_usec") {
+            usage.cpuUsec = value;
+        }
+    }
+
+    readNumber(path + "/memory.current", usage.memoryCurrent);
+    readNumber(path + "/memory.peak", usage.memoryPeak);
+
+    // One line per device: "8:0 rbytes=... wbytes=... rios=... ..."
+    if (readFile(path + "/io.stat", text)) {
+        std::stringstream io(text);
+        std::string field;
+        while (io >> field) {
+            if (field.compare(0, 7, "rbytes=") == 0) {
+                usage.ioReadBytes += std::strtoull(field.c_str() + 7, nullptr, 10);
+            } else if (field.compare(0, 7, "wbytes=") == 0) {
+                usage.ioWriteBytes += std::strtoull(field.c_str() + 7, nullptr, 10);
+            }
+        }
+    }
+
+    if (!readNumber(path + "/pids.current", usage.processes) && readFile(path + "/cgroup.procs", text)) {
+        std::stringstream procs(text);
+        std::string pid;
+        while (procs >> pid) {
+            ++usage.processes;
+        }
+    }
+    usage.valid = true;
+    return true;
+}
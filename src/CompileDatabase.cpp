@@ -0,0 +1,88 @@
+#include "CompileDatabase.h"
+#include "Trace.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+std::string normalizedPath(const std::filesystem::path& path) {
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+    return (ec ? path.lexically_normal() : canonical).string();
+}
+
+} // namespace
+
+bool CompileDatabase::load(const std::string& filePath) {
+    TRACE_SCOPE("CompileDatabase::load", "scan", filePath);
+    commands_.clear();
+    byFile_.clear();
+    loadedPath_.clear();
+
+    std::error_code ec;
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(filePath, ec);
+    std::uintmax_t size = ec ? 0 : std::filesystem::file_size(filePath, ec);
+
+    std::ifstream in(filePath, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromStdString(buffer.str()));
+    if (!document.isArray()) {
+        return false;
+    }
+
+    const QJsonArray entries = document.array();
+    for (const auto& value : entries) {
+        QJsonObject entry = value.toObject();
+        CompileCommand command;
+        command.directory = entry.value("directory").toString().toStdString();
+        command.command = entry.value("command").toString().toStdString();
+        const QJsonArray arguments = entry.value("arguments").toArray();
+        for (const auto& argument : arguments) {
+            command.arguments.push_back(argument.toString().toStdString());
+        }
+
+        // "file" may be relative to "directory"
+        std::filesystem::path file = entry.value("file").toString().toStdString();
+        if (file.is_relative()) {
+            file = std::filesystem::path(command.directory) / file;
+        }
+        command.file = normalizedPath(file);
+
+        if (!command.file.empty() && (!command.command.empty() || !command.arguments.empty())) {
+            // The first entry for a file wins, as with a linear search
+            byFile_.emplace(command.file, commands_.size());
+            commands_.push_back(std::move(command));
+        }
+    }
+    if (!ec) {
+        loadedPath_ = filePath;
+        loadedTime_ = time;
+        loadedSize_ = size;
+    }
+    return true;
+}
+
+bool CompileDatabase::refresh(const std::string& filePath) {
+    if (!loadedPath_.empty() && loadedPath_ == filePath) {
+        std::error_code ec;
+        std::filesystem::file_time_type time = std::filesystem::last_write_time(filePath, ec);
+        std::uintmax_t size = ec ? 0 : std::filesystem::file_size(filePath, ec);
+        if (!ec && time == loadedTime_ && size == loadedSize_) {
+            return true;
+        }
+    }
+    return load(filePath);
+}
+
+const CompileCommand* CompileDatabase::find(const std::string& sourceFile) const {
+    auto found = byFile_.find(normalizedPath(sourceFile));
+    return found != byFile_.end() ? &commands_[found->second] : nullptr;
+}
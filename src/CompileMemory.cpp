@@ -0,0 +1,333 @@
+#include "CompileMemory.h"
+#include "DistributedCompile.h"
+#include "TimeTraceReport.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <random>
+#include <sys/file.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Compiles wait while this share of the last 10 s had tasks stalled on memory
+constexpr double kPressureThreshold = 10.0;
+// Headroom kept free for the rest of the desktop, on top of the expected peak
+constexpr uint64_t kReserveKb = 512 * 1024;
+// After this long a compile starts anyway, so the build cannot stall forever
+constexpr auto kMaxAdmissionWait = std::chrono::seconds(120);
+// Nor does it keep waiting for memory that nothing is giving back
+constexpr auto kMaxStagnantWait = std::chrono::seconds(15);
+constexpr uint64_t kProgressKb = 64 * 1024;
+
+const char* baseName(const char* path) {
+    const char* slash = std::strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+bool isClang(int argc, char* argv[]) {
+    // The compiler itself, or the one behind ccache
+    for (int i = 0; i < argc && i < 2; ++i) {
+        if (std::strstr(baseName(argv[i]), "clang")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string sourceOf(int argc, char* argv[]) {
+    // CMake launchers see "<compiler> <flags> -o <object> -c <source>"
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "-c") == 0) {
+            return argv[i + 1];
+        }
+    }
+    return std::string();
+}
+
+// flock() on "<log>.lock": shared for appends, exclusive for compact();
+// -1 if the lock cannot be had
+int lockLog(const std::string& logFile, int operation) {
+    int fd = open((logFile + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    while (flock(fd, operation) != 0) {
+        if (errno != EINTR) {
+            close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+void appendRecord(const std::string& logFile, uint64_t peakKb, const std::string& source) {
+    // One short O_APPEND write per compile keeps concurrent launchers from
+    // interleaving their lines; the lock keeps compact() from renaming the
+    // log away between the open and the write
+    std::string line = std::to_string(peakKb) + " " + source + "\n";
+    int lock = lockLog(logFile, LOCK_SH);
+    int fd = open(logFile.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        ssize_t written = write(fd, line.data(), line.size());
+        (void)written;
+        close(fd);
+    }
+    if (lock >= 0) {
+        close(lock);
+    }
+}
+
+} // namespace
+
+CompileMemory::CompileMemory(const std::string& logFile) : logFile_(logFile) {
+}
+
+bool CompileMemory::load() {
+    peaks_.clear();
+    lines_ = 0;
+    std::ifstream in(logFile_);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t space = line.find(' ');
+        if (space == std::string::npos) {
+            continue;
+        }
+        // The latest run of a source wins; it reflects the code as it is now
+        peaks_[line.substr(space + 1)] = std::strtoull(line.c_str(), nullptr, 10);
+        ++lines_;
+    }
+    return true;
+}
+
+void CompileMemory::compact() {
+    if (lines_ <= 2 * peaks_.size() + 64) {
+        return;
+    }
+    int lock = lockLog(logFile_, LOCK_EX | LOCK_NB);
+    if (lock < 0) {
+        return;
+    }
+    // Whatever launchers appended since load() is kept
+    load();
+    std::string tmp = logFile_ + ".tmp";
+    std::ofstream out(tmp);
+    for (const auto& entry : peaks_) {
+        out << entry.second << " " << entry.first << "\n";
+    }
+    out.close();
+    if (out.good() && std::rename(tmp.c_str(), logFile_.c_str()) == 0) {
+        lines_ = peaks_.size();
+    }
+    close(lock);
+}
+
+uint64_t CompileMemory::recordedPeakKb(const std::string& logFile, const std::string& source) {
+    int fd = open(logFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    std::string text;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        text.resize(static_cast<size_t>(st.st_size));
+        ssize_t length = pread(fd, &text[0], text.size(), 0);
+        text.resize(length > 0 ? static_cast<size_t>(length) : 0);
+    }
+    close(fd);
+
+    // The latest line "<peak> <source>" is the one closest to the end
+    std::string suffix = " " + source + "\n";
+    size_t end = text.size();
+    while (end > 0) {
+        size_t found = text.rfind(suffix, end - 1);
+        if (found == std::string::npos) {
+            break;
+        }
+        size_t newline = found == 0 ? std::string::npos : text.rfind('\n', found - 1);
+        size_t lineStart = newline == std::string::npos ? 0 : newline + 1;
+        if (lineStart < found && std::all_of(text.begin() + lineStart, text.begin() + found,
+                                             [](unsigned char c) { return std::isdigit(c); })) {
+            return std::strtoull(text.c_str() + lineStart, nullptr, 10);
+        }
+        end = found;
+    }
+    return 0;
+}
+
+uint64_t CompileMemory::peakKb(const std::string& source) const {
+    auto it = peaks_.find(source);
+    return it == peaks_.end() ? 0 : it->second;
+}
+
+uint64_t CompileMemory::typicalPeakKb() const {
+    if (peaks_.empty()) {
+        return 0;
+    }
+    std::vector<uint64_t> peaks;
+    peaks.reserve(peaks_.size());
+    for (const auto& entry : peaks_) {
+        peaks.push_back(entry.second);
+    }
+    size_t rank = (peaks.size() * 9) / 10;
+    std::nth_element(peaks.begin(), peaks.begin() + rank, peaks.end());
+    return peaks[rank];
+}
+
+JobsChoice CompileMemory::chooseJobs(int cores) const {
+    JobsChoice choice;
+    choice.cores = std::max(1, cores);
+    choice.jobs = choice.cores;
+    choice.availableKb = memAvailableKb();
+    choice.perJobKb = typicalPeakKb();
+    choice.sources = peaks_.size();
+    if (choice.perJobKb > 0 && choice.availableKb > 0) {
+        uint64_t fit = (choice.availableKb * 8 / 10) / choice.perJobKb;
+        choice.jobs = static_cast<int>(std::max<uint64_t>(1, std::min<uint64_t>(fit, choice.cores)));
+    }
+    return choice;
+}
+
+uint64_t CompileMemory::memAvailableKb() {
+    std::ifstream in("/proc/meminfo");
+    std::string key;
+    uint64_t value;
+    std::string unit;
+    while (in >> key >> value >> unit) {
+        if (key == "MemAvailable:") {
+            return value;
+        }
+    }
+    return 0;
+}
+
+double CompileMemory::memoryPressure() {
+    std::ifstream in("/proc/pressure/memory");
+    std::string kind;
+    std::string avg10;
+    if (!(in >> kind >> avg10) || kind != "some" || avg10.compare(0, 6, "avg10=") != 0) {
+        return -1.0;
+    }
+    return std::strtod(avg10.c_str() + 6, nullptr);
+}
+
+int CompileMemory::runLauncher(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: cppm --compile-launcher <log file> <compiler> [arguments...]\n");
+        return 2;
+    }
+    std::string logFile = argv[0];
+    char** command = argv + 1;
+    int commandCount = argc - 1;
+    std::string source = sourceOf(commandCount, command);
+    // Set for distributed builds: the compile itself runs on another host
+    const char* distributed = std::getenv(DistributedCompile::kLauncherVariable);
+    bool remote = distributed && *distributed;
+
+    // Admission: a compile that is expected not to fit, or any compile while
+    // the system is already stalling on memory, waits for others to finish.
+    // Waiting launchers are what lowers the build's effective parallelism.
+    if (!source.empty()) {
+        uint64_t expectedKb = recordedPeakKb(logFile, source);
+        auto start = std::chrono::steady_clock::now();
+        std::mt19937 jitter(static_cast<unsigned>(getpid()));
+        double pressure = 0.0;
+        uint64_t availableKb = 0;
+        uint64_t bestAvailableKb = 0;
+        auto improved = start;
+        bool waited = false;
+        while (std::chrono::steady_clock::now() - start < kMaxAdmissionWait) {
+            pressure = memoryPressure();
+            availableKb = memAvailableKb();
+            auto now = std::chrono::steady_clock::now();
+            // Noise in MemAvailable is not memory being given back
+            if (availableKb > bestAvailableKb + kProgressKb) {
+                bestAvailableKb = availableKb;
+                improved = now;
+            }
+            bool stalling = pressure >= kPressureThreshold;
+            bool tooBig = !remote && expectedKb > 0 && availableKb > 0 && availableKb < expectedKb + kReserveKb;
+            if ((!stalling && !tooBig) || now - improved > kMaxStagnantWait) {
+                break;
+            }
+            waited = true;
+            // Spread the retries so that waiting compiles do not all resume together
+            std::this_thread::sleep_for(std::chrono::milliseconds(200 + jitter() % 600));
+        }
+        if (waited) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::fprintf(stderr, "cppm: held %s for %.1f s (memory pressure %.1f%%, %llu MB available, %llu MB expected)\n",
+                         source.c_str(), seconds, pressure < 0 ? 0.0 : pressure,
+                         static_cast<unsigned long long>(availableKb / 1024),
+                         static_cast<unsigned long long>(expectedKb / 1024));
+        }
+    }
+
+    std::vector<char*> arguments(command, command + commandCount);
+    if (remote) {
+        // ccache goes first and hands misses on to its prefix
+        if (std::strcmp(baseName(command[0]), "ccache") == 0) {
+            setenv("CCACHE_PREFIX", distributed, 1);
+        } else {
+            arguments.insert(arguments.begin(), const_cast<char*>(distributed));
+        }
+    }
+    // Profile builds: clang writes foo.cpp.json next to foo.cpp.o
+    const char* timeTrace = std::getenv(TimeTraceReport::kLauncherVariable);
+    if (timeTrace && *timeTrace && !source.empty() && isClang(commandCount, command)) {
+        arguments.push_back(const_cast<char*>("-ftime-trace"));
+    }
+    arguments.push_back(nullptr);
+
+    pid_t child = fork();
+    if (child < 0) {
+        std::perror("cppm: fork");
+        return 127;
+    }
+    if (child == 0) {
+        execvp(arguments[0], arguments.data());
+        std::fprintf(stderr, "cppm: cannot run %s: %s\n", arguments[0], std::strerror(errno));
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    std::memset(&usage, 0, sizeof(usage));
+    while (wait4(child, &status, 0, &usage) < 0) {
+        if (errno != EINTR) {
+            std::perror("cppm: wait4");
+            return 127;
+        }
+    }
+
+    // ru_maxrss covers the driver and the cc1plus it waited for; a remote
+    // compile's would only be the client's
+    if (!source.empty() && !remote && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        appendRecord(logFile, static_cast<uint64_t>(usage.ru_maxrss), source);
+    }
+
+    if (WIFSIGNALED(status)) {
+        int signal = WTERMSIG(status);
+        struct rlimit noCore = {0, 0};
+        setrlimit(RLIMIT_CORE, &noCore);
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+        return 128 + signal;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 127;
+}
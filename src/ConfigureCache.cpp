@@ -0,0 +1,275 @@
+#include "ConfigureCache.h"
+#include "HashIndex.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// v2: files from before the split into shared and workspace results held
+// project probes as well, and are dropped as if the toolchain had changed
+const std::string kIdentityPrefix = "# cppm toolchain v2: ";
+
+// Value of NAME=... or NAME:TYPE=... among -D entries
+std::string cacheEntryValue(const std::vector<std::string>& entries, const std::string& name) {
+    for (const auto& entry : entries) {
+        if (entry.size() > name.size() && entry.compare(0, name.size(), name) == 0 &&
+            (entry[name.size()] == '=' || entry[name.size()] == ':')) {
+            size_t equals = entry.find('=');
+            if (equals != std::string::npos) {
+                return entry.substr(equals + 1);
+            }
+        }
+    }
+    return std::string();
+}
+
+std::string findProgram(const std::string& name) {
+    if (name.empty() || name.find('/') != std::string::npos) {
+        return name;
+    }
+    const char* path = std::getenv("PATH");
+    std::istringstream directories(path ? path : "/usr/bin:/bin");
+    std::string directory;
+    while (std::getline(directories, directory, ':')) {
+        std::string candidate = (directory.empty() ? "." : directory) + "/" + name;
+        if (access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+    }
+    return std::string();
+}
+
+// The compiler cmake will pick: the configuration's, the environment's or the default
+std::string compilerFor(const std::vector<std::string>& entries, const char* cacheName,
+                        const char* environmentName, const char* fallback) {
+    std::string compiler = cacheEntryValue(entries, cacheName);
+    if (compiler.empty()) {
+        // CC may carry a launcher or flags; the first word is the binary
+        const char* environment = std::getenv(environmentName);
+        std::string value = environment ? environment : "";
+        compiler = value.substr(0, value.find(' '));
+    }
+    return findProgram(compiler.empty() ? fallback : compiler);
+}
+
+// "path size mtime" of the file a tool resolves to through symlinks such as c++ -> g++-12
+std::string fileStamp(const std::string& path) {
+    if (path.empty()) {
+        return "-";
+    }
+    std::error_code ec;
+    std::filesystem::path resolved = std::filesystem::canonical(path, ec);
+    struct stat st;
+    if (ec || stat(resolved.c_str(), &st) != 0) {
+        return path + " missing";
+    }
+    return resolved.string() + " " + std::to_string(st.st_size) + " " + std::to_string(st.st_mtime);
+}
+
+std::filesystem::path cacheDirectory() {
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) {
+        return std::filesystem::path(xdg) / "cppm" / "configure";
+    }
+    const char* home = std::getenv("HOME");
+    return std::filesystem::path(home ? home : "/tmp") / ".cache" / "cppm" / "configure";
+}
+
+bool startsWith(const std::string& text, const char* prefix) {
+    return text.rfind(prefix, 0) == 0;
+}
+
+enum class ProbeScope { None, Toolchain, Workspace };
+
+// Check modules store their results as INTERNAL entries that are only
+// recomputed while undefined. Only the results of the stock modules, under
+// the names they are conventionally given, are kept: check_type_size
+// (SIZEOF_* with HAVE_SIZEOF_*) depends on the toolchain alone;
+// check_include_file, check_symbol_exists and friends (HAVE_*, CMake's own
+// CMAKE_HAVE_*) and check_cxx_compiler_flag (COMPILER_SUPPORTS_*) also on
+// the project, whose variable name need not say which header, symbol or
+// flag was checked. Anything else is a project's own bookkeeping that
+// merely looks like a probe. Only successful probes are kept: a failed
+// check may pass once a package is installed.
+ProbeScope probeScope(const std::string& name, const std::string& type, const std::string& value) {
+    if (type != "INTERNAL" || value.empty() || value.size() > 20) {
+        return ProbeScope::None;
+    }
+    if (!std::all_of(name.begin(), name.end(), [](unsigned char c) { return std::isupper(c) || std::isdigit(c) || c == '_'; })) {
+        return ProbeScope::None;
+    }
+    if (startsWith(name, "SIZEOF_")) {
+        bool size = value != "0" && std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); });
+        return size ? ProbeScope::Toolchain : ProbeScope::None;
+    }
+    std::string upper;
+    for (unsigned char c : value) {
+        upper += static_cast<char>(std::toupper(c));
+    }
+    if (upper != "1" && upper != "ON" && upper != "TRUE" && upper != "YES") {
+        return ProbeScope::None;
+    }
+    if (startsWith(name, "HAVE_SIZEOF_")) {
+        return ProbeScope::Toolchain;
+    }
+    if (startsWith(name, "HAVE_") || startsWith(name, "CMAKE_HAVE_") || startsWith(name, "COMPILER_SUPPORTS_")) {
+        return ProbeScope::Workspace;
+    }
+    return ProbeScope::None;
+}
+
+// A file recorded for this identity; one left by other tools is removed
+bool isCurrent(const std::filesystem::path& file, const std::string& identity) {
+    std::ifstream in(file);
+    std::string header;
+    if (!in.is_open() || !std::getline(in, header)) {
+        return false;
+    }
+    if (header != kIdentityPrefix + identity) {
+        in.close();
+        std::error_code ec;
+        std::filesystem::remove(file, ec);
+        return false;
+    }
+    return true;
+}
+
+// Lines look like set(NAME "VALUE" CACHE INTERNAL "")
+void readResults(const std::filesystem::path& file, std::map<std::string, std::string>& results) {
+    std::ifstream in(file);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t nameEnd = line.find(" \"");
+        size_t valueEnd = nameEnd == std::string::npos ? nameEnd : line.find('"', nameEnd + 2);
+        if (line.rfind("set(", 0) == 0 && valueEnd != std::string::npos) {
+            results[line.substr(4, nameEnd - 4)] = line.substr(nameEnd + 2, valueEnd - nameEnd - 2);
+        }
+    }
+}
+
+// Written aside and renamed so concurrent configures never read half a file
+bool writeResults(const std::filesystem::path& file, const std::string& identity,
+                  const std::map<std::string, std::string>& results, const std::filesystem::path& included) {
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+    std::filesystem::path temporary = file;
+    temporary += "." + std::to_string(getpid());
+    {
+        std::ofstream out(temporary);
+        out << kIdentityPrefix << identity << "\n";
+        if (!included.empty()) {
+            out << "include(\"" << included.string() << "\" OPTIONAL)\n";
+        }
+        for (const auto& result : results) {
+            out << "set(" << result.first << " \"" << result.second << "\" CACHE INTERNAL \"\")\n";
+        }
+        if (!out.good()) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, file, ec);
+    return !ec;
+}
+
+// Entries that change what a check compiles: flags, language standards and
+// the CMAKE_REQUIRED_* inputs of the check modules
+bool isCheckInput(const std::string& entry) {
+    std::string name = entry.substr(0, entry.find_first_of(":="));
+    return name.find("FLAGS") != std::string::npos || name.find("STANDARD") != std::string::npos ||
+           startsWith(name, "CMAKE_REQUIRED_");
+}
+
+} // namespace
+
+ConfigureCache::ConfigureCache(const std::string& toolchainFile, const std::vector<std::string>& cacheEntries,
+                               const std::filesystem::path& workspaceStateDirectory) {
+    std::string cCompiler = compilerFor(cacheEntries, "CMAKE_C_COMPILER", "CC", "cc");
+    std::string cxxCompiler = compilerFor(cacheEntries, "CMAKE_CXX_COMPILER", "CXX", "c++");
+
+    // Which tools and check inputs: sanitizer flags change what compiles and links
+    std::string key = cCompiler + "\n" + cxxCompiler + "\n" + toolchainFile;
+    for (const auto& entry : cacheEntries) {
+        if (isCheckInput(entry)) {
+            key += "\n" + entry;
+        }
+    }
+
+    // Which builds of them: a reinstalled compiler or cmake starts over
+    identity_ = fileStamp(cCompiler) + "; " + fileStamp(cxxCompiler) + "; " + fileStamp(findProgram("cmake"));
+    if (!toolchainFile.empty()) {
+        identity_ += "; " + fileStamp(toolchainFile);
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.cmake",
+                  static_cast<unsigned long long>(HashIndex::xxh64(key.data(), key.size())));
+    file_ = cacheDirectory() / name;
+    workspaceFile_ = workspaceStateDirectory / (std::string("configure-") + name);
+}
+
+std::string ConfigureCache::initialCacheFile() const {
+    bool shared = isCurrent(file_, identity_);
+    if (isCurrent(workspaceFile_, identity_)) {
+        return workspaceFile_.string();
+    }
+    return shared ? file_.string() : std::string();
+}
+
+bool ConfigureCache::record(const std::string& cmakeCacheFile) const {
+    TRACE_SCOPE("ConfigureCache::record", "build", cmakeCacheFile);
+    std::ifstream in(cmakeCacheFile);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    // Results from earlier configures stay, other workspaces' in the shared file
+    std::map<std::string, std::string> shared;
+    std::map<std::string, std::string> own;
+    if (isCurrent(file_, identity_)) {
+        readResults(file_, shared);
+    }
+    if (isCurrent(workspaceFile_, identity_)) {
+        readResults(workspaceFile_, own);
+    }
+
+    // CMakeCache.txt lines look like NAME:TYPE=VALUE
+    bool sharedChanged = false;
+    bool ownChanged = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t colon = line.find(':');
+        size_t equals = colon == std::string::npos ? colon : line.find('=', colon);
+        if (line.empty() || line[0] == '#' || line[0] == '/' || equals == std::string::npos) {
+            continue;
+        }
+        std::string name = line.substr(0, colon);
+        std::string value = line.substr(equals + 1);
+        ProbeScope scope = probeScope(name, line.substr(colon + 1, equals - colon - 1), value);
+        if (scope == ProbeScope::None) {
+            continue;
+        }
+        std::map<std::string, std::string>& results = scope == ProbeScope::Toolchain ? shared : own;
+        auto it = results.find(name);
+        if (it == results.end() || it->second != value) {
+            results[name] = value;
+            (scope == ProbeScope::Toolchain ? sharedChanged : ownChanged) = true;
+        }
+    }
+
+    bool ok = true;
+    if (sharedChanged) {
+        ok = writeResults(file_, identity_, shared, std::filesystem::path());
+    }
+    if (ownChanged) {
+        ok = writeResults(workspaceFile_, identity_, own, file_) && ok;
+    }
+    return ok;
+}
@@ -0,0 +1,198 @@
+#include "DistributedCompile.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+
+// distcc's struct dcc_task_state (state.h), as written to binstate_<pid>
+struct DccTaskState {
+    size_t structSize;
+    unsigned long magic;
+    unsigned long cpid;
+    char file[128];
+    char host[128];
+    int slot;
+    int phase;
+    void* next;
+};
+constexpr unsigned long kDccStateMagic = 0x44494800UL;
+constexpr int kDccPhaseDone = 7;
+
+std::string findExecutable(const char* name) {
+    const char* path = std::getenv("PATH");
+    std::stringstream directories(path ? path : "/usr/bin:/bin");
+    std::string directory;
+    while (std::getline(directories, directory, ':')) {
+        std::string candidate = directory + "/" + name;
+        if (!directory.empty() && access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+    }
+    return std::string();
+}
+
+std::string distccDirectory() {
+    if (const char* dir = std::getenv("DISTCC_DIR")) {
+        return dir;
+    }
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : "/tmp") + "/.distcc";
+}
+
+std::string readHostFile(const std::string& path) {
+    std::ifstream in(path);
+    std::string spec;
+    std::string line;
+    while (std::getline(in, line)) {
+        spec += line.substr(0, line.find('#')) + " ";
+    }
+    return spec;
+}
+
+} // namespace
+
+void DistributedSettings::loadFromFile(const std::string& filePath) {
+    std::ifstream in(filePath);
+    std::string key;
+    std::string value;
+    while (in >> key >> value) {
+        if (key == "enabled") enabled = value != "0";
+        else if (key == "backend") backend = value;
+        else if (key == "slots") jobSlots = std::atoi(value.c_str());
+    }
+}
+
+void DistributedSettings::saveToFile(const std::string& filePath) const {
+    std::ofstream out(filePath);
+    out << "enabled " << (enabled ? 1 : 0) << "\n"
+        << "backend " << backend << "\n"
+        << "slots " << jobSlots << "\n";
+}
+
+DistributedPlan DistributedCompile::plan(const DistributedSettings& settings) {
+    DistributedPlan plan;
+    std::string distcc = findExecutable("distcc");
+    std::string icecc = findExecutable("icecc");
+    bool useDistcc = settings.backend == "distcc" || (settings.backend == "auto" && !distcc.empty());
+    bool useIcecc = !useDistcc && (settings.backend == "icecc" || settings.backend == "auto");
+
+    if (useDistcc) {
+        plan.backend = "distcc";
+        plan.tool = distcc;
+        plan.hosts = distccHosts();
+        for (const auto& host : plan.hosts) {
+            plan.jobSlots += host.jobSlots;
+        }
+        if (plan.tool.empty()) {
+            plan.error = "distcc is not installed";
+        } else if (plan.hosts.empty()) {
+            plan.error = "no distcc hosts: set DISTCC_HOSTS or write ~/.distcc/hosts";
+        }
+    } else if (useIcecc) {
+        plan.backend = "icecc";
+        plan.tool = icecc;
+        // The scheduler knows the cluster's slots, but only tells its own protocol
+        plan.jobSlots = settings.jobSlots;
+        if (plan.tool.empty()) {
+            plan.error = "neither distcc nor icecc is installed";
+        } else if (plan.jobSlots <= 0) {
+            plan.error = "set the number of slots the icecream cluster offers";
+        }
+    }
+    if (settings.jobSlots > 0) {
+        plan.jobSlots = settings.jobSlots;
+    }
+    plan.available = !plan.tool.empty() && plan.jobSlots > 0 && plan.error.empty();
+    return plan;
+}
+
+std::vector<DistccHost> DistributedCompile::distccHosts() {
+    if (const char* hosts = std::getenv("DISTCC_HOSTS")) {
+        return parseDistccHosts(hosts);
+    }
+    std::string spec = readHostFile(distccDirectory() + "/hosts");
+    if (spec.find_first_not_of(' ') == std::string::npos) {
+        spec = readHostFile("/etc/distcc/hosts");
+    }
+    return parseDistccHosts(spec);
+}
+
+std::vector<DistccHost> DistributedCompile::parseDistccHosts(const std::string& spec) {
+    // "localhost/2 10.0.0.5:3632/8,lzo @build-box/4 --randomize"
+    std::vector<DistccHost> hosts;
+    std::stringstream tokens(spec);
+    std::string token;
+    while (tokens >> token) {
+        if (token[0] == '-' || token[0] == '+') {
+            continue; // --randomize, --localslots=N, +zeroconf
+        }
+        token = token.substr(0, token.find(','));
+        DistccHost host;
+        bool ssh = false;
+        size_t at = token.find('@');
+        if (at != std::string::npos) {
+            ssh = true;
+            token = token.substr(at + 1);
+        }
+        size_t slash = token.find('/');
+        if (slash != std::string::npos) {
+            host.jobSlots = std::atoi(token.c_str() + slash + 1);
+            token = token.substr(0, slash);
+        }
+        host.name = token.substr(0, token.find(':'));
+        if (host.name.empty()) {
+            continue;
+        }
+        host.local = host.name == "localhost";
+        if (host.jobSlots <= 0) {
+            // distcc's own defaults
+            host.jobSlots = host.local || ssh ? 2 : 4;
+        }
+        hosts.push_back(host);
+    }
+    return hosts;
+}
+
+std::vector<DistccTask> DistributedCompile::distccTasks() {
+    std::vector<DistccTask> tasks;
+    std::string stateDir = distccDirectory() + "/state";
+    DIR* dir = opendir(stateDir.c_str());
+    if (!dir) {
+        return tasks;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "binstate_", 9) != 0) {
+            continue;
+        }
+        std::ifstream in(stateDir + "/" + entry->d_name, std::ios::binary);
+        DccTaskState state;
+        if (!in.read(reinterpret_cast<char*>(&state), sizeof(state)) ||
+            state.structSize != sizeof(state) || state.magic != kDccStateMagic ||
+            state.phase == kDccPhaseDone) {
+            continue;
+        }
+        // A client that crashed leaves its file behind
+        pid_t pid = static_cast<pid_t>(state.cpid);
+        if (pid <= 0 || (kill(pid, 0) != 0 && errno == ESRCH)) {
+            continue;
+        }
+        state.file[sizeof(state.file) - 1] = '\0';
+        state.host[sizeof(state.host) - 1] = '\0';
+        DistccTask task;
+        task.pid = pid;
+        task.file = state.file;
+        task.host = state.host;
+        task.slot = state.slot;
+        if (!task.host.empty()) {
+            tasks.push_back(task);
+        }
+    }
+    closedir(dir);
+    return tasks;
+}
@@ -0,0 +1,142 @@
+#include "GitPipeline.h"
+#include "ProcessSupervisor.h"
+#include "Trace.h"
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+
+GitPipeline::GitPipeline(ProcessSupervisor* supervisor, const QString& workspace, const QString& path,
+                         QObject* parent)
+    : QObject(parent), supervisor_(supervisor), workspace_(workspace), path_(path) {
+}
+
+void GitPipeline::addStage(const QString& name, const QStringList& arguments, const QString& benignOutput,
+                           bool remote) {
+    Step step;
+    step.name = name;
+    step.arguments = arguments;
+    step.benignOutput = benignOutput;
+    step.remote = remote;
+    stages_.append(QList<Step>() << step);
+}
+
+void GitPipeline::addParallelStep(const QString& name, const QStringList& arguments, bool remote) {
+    if (stages_.isEmpty()) {
+        addStage(name, arguments, QString(), remote);
+        return;
+    }
+    Step step;
+    step.name = name;
+    step.arguments = arguments;
+    step.remote = remote;
+    stages_.last().append(step);
+}
+
+void GitPipeline::start() {
+    TRACE_SCOPE("GitPipeline::start", "git", path_.toStdString());
+    running_ = true;
+    stage_ = 0;
+    failed_ = false;
+    results_.clear();
+    startStage();
+}
+
+void GitPipeline::startStage() {
+    if (stage_ >= stages_.size() || failed_) {
+        // Whatever is left is reported, so every step has a result
+        for (int i = stage_; i < stages_.size(); ++i) {
+            for (const Step& step : stages_[i]) {
+                GitStepResult result;
+                result.name = step.name;
+                result.skipped = true;
+                result.message = "skipped";
+                results_.append(result);
+                emit stepFinished(result);
+            }
+        }
+        running_ = false;
+        emit finished(!failed_);
+        return;
+    }
+
+    const QList<Step>& steps = stages_[stage_];
+    pendingSteps_ = steps.size();
+    for (const Step& step : steps) {
+        ProcessJob* job = supervisor_->create(workspace_, "git", "git " + step.arguments.join(" "));
+        job->process()->setWorkingDirectory(path_);
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        // Nobody can answer a credential prompt; fail instead of hanging
+        environment.insert("GIT_TERMINAL_PROMPT", "0");
+        // Benign outcomes are recognized by their English wording; LC_ALL
+        // overrides any LC_MESSAGES, and LANGUAGE would override even that
+        environment.insert("LC_ALL", "C");
+        environment.remove("LANGUAGE");
+        job->process()->setProcessEnvironment(environment);
+
+        QString name = step.name;
+        connect(job, &ProcessJob::output, this, [this, name](const QString& text, bool) { onOutput(name, text); });
+        connect(job, &ProcessJob::finished, this, [this, step, job](int, QProcess::ExitStatus) {
+            onStepFinished(step, job);
+        });
+        // A child that never ran emits no finished
+        connect(job, &ProcessJob::stateChanged, this, [this, step, job]() {
+            if (job->state() == ProcessJob::State::Failed && job->process()->error() == QProcess::FailedToStart) {
+                onStepFinished(step, job);
+            }
+        });
+        emit stepStarted(job, step.name, step.remote);
+        job->start("git", step.arguments);
+    }
+}
+
+void GitPipeline::onOutput(const QString& step, const QString& text) {
+    // git rewrites progress lines with \r; complete lines end with \n
+    QString buffer = partialLines_.value(step) + text;
+    int begin = 0;
+    for (int i = 0; i < buffer.size(); ++i) {
+        if (buffer[i] != QChar('\n') && buffer[i] != QChar('\r')) {
+            continue;
+        }
+        QString line = buffer.mid(begin, i - begin);
+        if (!line.trimmed().isEmpty()) {
+            if (buffer[i] == QChar('\r')) {
+                emit progress(step, line.trimmed());
+            } else {
+                emit output(step, line);
+            }
+        }
+        begin = i + 1;
+    }
+    partialLines_[step] = buffer.mid(begin);
+}
+
+void GitPipeline::onStepFinished(const Step& step, ProcessJob* job) {
+    QString rest = partialLines_.take(step.name);
+    if (!rest.trimmed().isEmpty()) {
+        emit output(step.name, rest);
+    }
+
+    GitStepResult result;
+    result.name = step.name;
+    result.exitCode = job->exitCode();
+    result.elapsedMs = job->elapsedMs();
+    result.ok = job->state() == ProcessJob::State::Finished;
+    const QString log = job->log();
+    if (!result.ok && !step.benignOutput.isEmpty() && log.contains(step.benignOutput)) {
+        result.ok = true;
+        result.message = step.benignOutput;
+    } else if (job->state() == ProcessJob::State::Cancelled) {
+        result.message = "cancelled";
+    } else {
+        // The last thing git said is the reason it failed, or its summary
+        QStringList lines = log.split(QRegularExpression("[\r\n]"), Qt::SkipEmptyParts);
+        result.message = lines.isEmpty() ? QString() : lines.last().trimmed();
+    }
+    failed_ = failed_ || !result.ok;
+    results_.append(result);
+    emit stepFinished(result);
+
+    if (--pendingSteps_ == 0) {
+        ++stage_;
+        startStage();
+    }
+}
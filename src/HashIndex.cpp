@@ -0,0 +1,392 @@
+#include "HashIndex.h"
+#include "IgnoreRules.h"
+#include "SourceStats.h"
+#include "Trace.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+constexpr size_t kFilesPerTask = 32;
+// Files are read in pieces of this size rather than mapped: a file
+// truncated while it is hashed would raise SIGBUS in a mapping
+constexpr size_t kReadChunk = 256 * 1024;
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+    acc ^= round(0, val);
+    return acc * kPrime1 + kPrime4;
+}
+
+int64_t modificationTime(const struct stat& st) {
+#ifdef __APPLE__
+    return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+// The last bytes of the input, fewer than a stripe, then the avalanche
+uint64_t finalize(uint64_t h, const unsigned char* p, const unsigned char* end) {
+    while (p + 8 <= end) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+// HashIndex::xxh64 over input that arrives in pieces; same result
+class Xxh64Stream {
+public:
+    explicit Xxh64Stream(uint64_t seed = 0)
+        : seed_(seed), v1_(seed + kPrime1 + kPrime2), v2_(seed + kPrime2), v3_(seed), v4_(seed - kPrime1) {}
+
+    void update(const unsigned char* p, size_t size) {
+        total_ += size;
+        if (buffered_ + size < sizeof(stripe_)) {
+            std::memcpy(stripe_ + buffered_, p, size);
+            buffered_ += size;
+            return;
+        }
+        const unsigned char* end = p + size;
+        if (buffered_ > 0) {
+            size_t fill = sizeof(stripe_) - buffered_;
+            std::memcpy(stripe_ + buffered_, p, fill);
+            consume(stripe_);
+            p += fill;
+            buffered_ = 0;
+        }
+        for (; p + sizeof(stripe_) <= end; p += sizeof(stripe_)) {
+            consume(p);
+        }
+        buffered_ = static_cast<size_t>(end - p);
+        std::memcpy(stripe_, p, buffered_);
+    }
+
+    uint64_t digest() const {
+        uint64_t h;
+        if (total_ >= sizeof(stripe_)) {
+            h = rotl(v1_, 1) + rotl(v2_, 7) + rotl(v3_, 12) + rotl(v4_, 18);
+            h = mergeRound(h, v1_);
+            h = mergeRound(h, v2_);
+            h = mergeRound(h, v3_);
+            h = mergeRound(h, v4_);
+        } else {
+            h = seed_ + kPrime5;
+        }
+        h += total_;
+        return finalize(h, stripe_, stripe_ + buffered_);
+    }
+
+private:
+    void consume(const unsigned char* p) {
+        v1_ = round(v1_, read64(p));
+        v2_ = round(v2_, read64(p + 8));
+        v3_ = round(v3_, read64(p + 16));
+        v4_ = round(v4_, read64(p + 24));
+    }
+
+    uint64_t seed_;
+    uint64_t v1_, v2_, v3_, v4_;
+    uint64_t total_ = 0;
+    unsigned char stripe_[32];
+    size_t buffered_ = 0;
+};
+
+bool hashFile(const std::string& path, uint64_t& hash) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    thread_local std::vector<unsigned char> buffer(kReadChunk);
+    Xxh64Stream stream;
+    bool ok = true;
+    for (off_t offset = 0;;) {
+        ssize_t length = pread(fd, buffer.data(), buffer.size(), offset);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length <= 0) {
+            ok = length == 0;
+            break;
+        }
+        stream.update(buffer.data(), static_cast<size_t>(length));
+        offset += length;
+    }
+    close(fd);
+    hash = stream.digest();
+    return ok;
+}
+
+} // namespace
+
+uint64_t HashIndex::xxh64(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    } else {
+        h = seed + kPrime5;
+    }
+
+    h += static_cast<uint64_t>(size);
+    return finalize(h, p, end);
+}
+
+HashIndex::HashIndex(const std::string& root, const std::string& indexFile,
+                     std::vector<std::string> excludedDirectories)
+    : root_(root), indexFile_(indexFile), excludedDirectories_(std::move(excludedDirectories)) {
+}
+
+void HashIndex::loadIndex() {
+    index_.clear();
+    // Format: "inode mtime size hash relative/path" per line, hash in hex
+    std::ifstream file(indexFile_);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        Entry entry;
+        if (!(in >> entry.inode >> entry.mtimeNs >> entry.size >> std::hex >> entry.hash)) {
+            continue;
+        }
+        std::string path;
+        in.get();
+        std::getline(in, path);
+        if (!path.empty()) {
+            index_[path] = entry;
+        }
+    }
+}
+
+void HashIndex::saveIndex() const {
+    std::ofstream file(indexFile_);
+    for (const auto& pair : index_) {
+        const Entry& entry = pair.second;
+        file << entry.inode << ' ' << entry.mtimeNs << ' ' << entry.size << ' ' << std::hex << entry.hash
+             << std::dec << ' ' << pair.first << '\n';
+    }
+}
+
+TreeDigest HashIndex::compute() {
+    TRACE_SCOPE("HashIndex::compute", "scan", root_);
+    uint64_t startNs = Tracer::now();
+    loadIndex();
+
+    std::mutex mutex;
+    std::condition_variable done;
+    int pending = 0;
+    std::vector<std::pair<std::string, Entry>> entries;
+    uint64_t filesHashed = 0;
+
+    WorkStealingPool& pool = WorkStealingPool::instance();
+    std::function<void(std::function<void()>)> spawn = [&](std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++pending;
+        }
+        pool.submit([&, task = std::move(task)] {
+            task();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                done.notify_all();
+            }
+        });
+    };
+
+    // Stats and, where needed, hashes a batch of files relative to root_
+    auto hashBatch = [&](std::vector<std::string> files) {
+        std::vector<std::pair<std::string, Entry>> local;
+        uint64_t hashed = 0;
+        for (auto& relative : files) {
+            std::string absolute = root_ + "/" + relative;
+            struct stat st;
+            if (lstat(absolute.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+                continue;
+            }
+            Entry current;
+            current.inode = static_cast<uint64_t>(st.st_ino);
+            current.mtimeNs = modificationTime(st);
+            current.size = static_cast<uint64_t>(st.st_size);
+
+            // The index is only read while hashing, so no lock is needed
+            auto known = index_.find(relative);
+            if (known != index_.end() && known->second.inode == current.inode &&
+                known->second.mtimeNs == current.mtimeNs && known->second.size == current.size) {
+                current.hash = known->second.hash;
+            } else if (hashFile(absolute, current.hash)) {
+                ++hashed;
+            } else {
+                continue;
+            }
+            local.emplace_back(std::move(relative), current);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        filesHashed += hashed;
+        for (auto& entry : local) {
+            entries.push_back(std::move(entry));
+        }
+    };
+
+    // Every file git would track counts, editor scratch files aside: a .qrc,
+    // a .ui or a configure_file template changes the build as much as a
+    // source does
+    std::function<void(std::string, std::shared_ptr<const IgnoreRules>)> walk =
+        [&](std::string relative, std::shared_ptr<const IgnoreRules> rules) {
+        std::string absolute = relative.empty() ? root_ : root_ + "/" + relative;
+        DIR* dir = opendir(absolute.c_str());
+        if (!dir) {
+            return;
+        }
+        rules = IgnoreRules::load(absolute + "/.gitignore", relative, rules);
+
+        std::vector<std::string> batch;
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") {
+                continue;
+            }
+            std::string child = relative.empty() ? name : relative + "/" + name;
+
+            unsigned char type = entry->d_type;
+            if (type == DT_UNKNOWN) {
+                struct stat st;
+                if (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                    continue;
+                }
+                type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+            }
+
+            if (rules && (type == DT_DIR || type == DT_REG) && rules->isIgnored(child, type == DT_DIR)) {
+                continue;
+            }
+            if (type == DT_DIR) {
+                if (SourceStats::isSkippedDirectory(name) ||
+                    std::find(excludedDirectories_.begin(), excludedDirectories_.end(), child) !=
+                        excludedDirectories_.end()) {
+                    continue;
+                }
+                spawn([&walk, child, rules] { walk(child, rules); });
+            } else if (type == DT_REG && !SourceStats::isScratchFile(name)) {
+                batch.push_back(std::move(child));
+                if (batch.size() == kFilesPerTask) {
+                    spawn([&hashBatch, files = std::move(batch)]() mutable { hashBatch(std::move(files)); });
+                    batch.clear();
+                }
+            }
+        }
+        closedir(dir);
+
+        if (!batch.empty()) {
+            hashBatch(std::move(batch));
+        }
+    };
+
+    spawn([&walk] { walk(std::string(), nullptr); });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return pending == 0; });
+    }
+
+    // Path order makes the digest independent of scheduling
+    std::sort(entries.begin(), entries.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    TreeDigest result;
+    result.files = entries.size();
+    result.filesHashed = filesHashed;
+    uint64_t digest = 0;
+    for (const auto& pair : entries) {
+        // Renames change the digest as well as edits do
+        uint64_t pathHash = xxh64(pair.first.data(), pair.first.size(), digest);
+        digest = xxh64(&pair.second.hash, sizeof(pair.second.hash), pathHash);
+    }
+    result.digest = digest;
+
+    if (filesHashed > 0 || entries.size() != index_.size()) {
+        index_.clear();
+        for (auto& pair : entries) {
+            index_.emplace(std::move(pair.first), pair.second);
+        }
+        saveIndex();
+    }
+
+    result.seconds = (Tracer::now() - startNs) / 1e9;
+    return result;
+}
@@ -0,0 +1,131 @@
+#include "IgnoreRules.h"
+#include <fstream>
+#include <fnmatch.h>
+
+namespace {
+
+std::vector<std::string> splitPath(const std::string& path) {
+    std::vector<std::string> segments;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t slash = path.find('/', start);
+        if (slash == std::string::npos) {
+            slash = path.size();
+        }
+        segments.push_back(path.substr(start, slash - start));
+        start = slash + 1;
+    }
+    return segments;
+}
+
+// Segment by segment, so '*' never crosses a '/' and "**" stands for zero
+// or more whole directories ("a/**/b" matches "a/b")
+bool matchSegments(const std::vector<std::string>& pattern, size_t p,
+                   const std::vector<std::string>& path, size_t s) {
+    if (p == pattern.size()) {
+        return s == path.size();
+    }
+    if (pattern[p] == "**") {
+        // A trailing "/**" matches what is inside, not the directory itself
+        if (p + 1 == pattern.size()) {
+            return s < path.size();
+        }
+        for (size_t next = s; next <= path.size(); ++next) {
+            if (matchSegments(pattern, p + 1, path, next)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return s < path.size() && fnmatch(pattern[p].c_str(), path[s].c_str(), 0) == 0 &&
+           matchSegments(pattern, p + 1, path, s + 1);
+}
+
+} // namespace
+
+std::shared_ptr<const IgnoreRules> IgnoreRules::load(const std::string& filePath, const std::string& base,
+                                                     std::shared_ptr<const IgnoreRules> parent) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        return parent;
+    }
+
+    auto rules = std::make_shared<IgnoreRules>();
+    rules->base_ = base;
+    rules->parent_ = std::move(parent);
+
+    std::string line;
+    while (std::getline(file, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        Rule rule;
+        if (line[0] == '!') {
+            rule.negated = true;
+            line.erase(0, 1);
+        } else if (line[0] == '\\') {
+            line.erase(0, 1);
+        }
+        if (!line.empty() && line.back() == '/') {
+            rule.directoryOnly = true;
+            line.pop_back();
+        }
+        if (line.compare(0, 3, "**/") == 0) {
+            rule.floating = true;
+            line.erase(0, 3);
+        } else if (!line.empty() && line[0] == '/') {
+            rule.anchored = true;
+            line.erase(0, 1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (line.find('/') != std::string::npos) {
+            rule.anchored = true;
+        }
+        if (rule.anchored) {
+            rule.segments = splitPath(line);
+        }
+        rule.pattern = line;
+        rules->rules_.push_back(std::move(rule));
+    }
+
+    if (rules->rules_.empty()) {
+        return rules->parent_;
+    }
+    return rules;
+}
+
+bool IgnoreRules::isIgnored(const std::string& relative, bool isDirectory) const {
+    std::string local = base_.empty() ? relative : relative.substr(base_.size() + 1);
+    size_t slash = local.rfind('/');
+    const char* name = local.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+    std::vector<std::string> segments; // Split on the first anchored rule
+
+    for (auto it = rules_.rbegin(); it != rules_.rend(); ++it) {
+        if (it->directoryOnly && !isDirectory) {
+            continue;
+        }
+        bool matched = false;
+        if (!it->anchored) {
+            matched = fnmatch(it->pattern.c_str(), name, 0) == 0;
+        } else {
+            if (segments.empty()) {
+                segments = splitPath(local);
+            }
+            // A floating pattern may start below any directory
+            size_t lastStart = it->floating ? segments.size() - 1 : 0;
+            for (size_t start = 0; start <= lastStart && !matched; ++start) {
+                matched = matchSegments(it->segments, 0, segments, start);
+            }
+        }
+        if (matched) {
+            return !it->negated;
+        }
+    }
+    return parent_ && parent_->isIgnored(relative, isDirectory);
+}
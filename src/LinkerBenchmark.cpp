@@ -0,0 +1,100 @@
+#include "LinkerBenchmark.h"
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+
+bool onPath(const std::string& name) {
+    const char* path = std::getenv("PATH");
+    std::stringstream directories(path ? path : "/usr/bin:/bin");
+    std::string directory;
+    while (std::getline(directories, directory, ':')) {
+        if (!directory.empty() && access((directory + "/" + name).c_str(), X_OK) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string shellQuote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+std::string readCommand(const std::string& cmd) {
+    std::string output;
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe) {
+        return output;
+    }
+    std::array<char, 4096> buffer;
+    size_t count;
+    while ((count = fread(buffer.data(), 1, buffer.size(), pipe)) > 0) {
+        output.append(buffer.data(), count);
+    }
+    pclose(pipe);
+    return output;
+}
+
+} // namespace
+
+const std::vector<std::string>& LinkerBenchmark::linkers() {
+    static const std::vector<std::string> names = {"bfd", "gold", "lld", "mold"};
+    return names;
+}
+
+bool LinkerBenchmark::isAvailable(const std::string& linker) {
+    // What gcc and clang look for on -fuse-ld=<linker>
+    if (linker == "mold") {
+        return onPath("mold") || onPath("ld.mold");
+    }
+    return onPath("ld." + linker);
+}
+
+LinkCommand LinkerBenchmark::linkCommand(const std::string& buildTop, const CMakeTarget& target) {
+    LinkCommand link;
+    std::string text;
+    if (access((buildTop + "/build.ninja").c_str(), R_OK) == 0) {
+        // Ninja runs every command from the top of the build tree
+        link.workingDirectory = buildTop;
+        text = readCommand("ninja -C " + shellQuote(buildTop) + " -t commands " + shellQuote(target.name) + " 2>/dev/null");
+    } else {
+        link.workingDirectory = target.buildDirectory.empty() ? buildTop : target.buildDirectory;
+        std::ifstream in(link.workingDirectory + "/CMakeFiles/" + target.name + ".dir/link.txt");
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        text = buffer.str();
+    }
+
+    // The link is the last command that writes an output; compiles come first
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.find(" -o ") != std::string::npos) {
+            link.command = line;
+        }
+    }
+    if (link.command.empty()) {
+        link.error = "no link command found for " + target.name + " (build it once first)";
+    }
+    return link;
+}
+
+std::string LinkerBenchmark::withLinker(const std::string& command, const std::string& linker, const std::string& output) {
+    static const std::regex selection(R"(\s(-fuse-ld=|--ld-path=)\S+)");
+    static const std::regex outputOption(R"(\s-o\s+\S+)");
+    std::string result = std::regex_replace(command, selection, "");
+    std::smatch match;
+    if (!std::regex_search(result, match, outputOption)) {
+        return result + " -fuse-ld=" + linker;
+    }
+    return match.prefix().str() + " -fuse-ld=" + linker + " -o " + shellQuote(output) + match.suffix().str();
+}
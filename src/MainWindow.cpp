@@ -1,4 +1,7 @@
 #include "MainWindow.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "Reaper.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QInputDialog>
@@ -13,6 +16,7 @@
 #include <QMessageBox>
 #include <QProcess>
 #include <QFile>
+#include <QTemporaryDir>
 #include <QTextStream>
 #include <QDesktopServices>
 #include <QCoreApplication>
@@ -27,21 +31,54 @@
 #include <QLineEdit>
 #include <QProgressBar>
 #include <QCloseEvent>
-#include <QThread>
+#include <QMenuBar>
+#include <QMenu>
+#include <QHeaderView>
+#include <QFormLayout>
+#include <QLocale>
+#include <QKeySequence>
+#include <QScrollBar>
+#include <QStatusBar>
+#include <QSpinBox>
+#include <QFontDatabase>
+#include <QActionGroup>
+#include "WorkStealingPool.h"
+#include "TaskExecutor.h"
+#include "CompileDatabase.h"
+#include "ParallelismTuner.h"
+#include "DistributedCompile.h"
+#include "TimeTraceReport.h"
+#include "LinkerBenchmark.h"
+#include "SourceWatcher.h"
+#include "GitPipeline.h"
+#include "RunChart.h"
+#include "RunHistory.h"
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), currentWorkspace_(nullptr), buildProcess_(nullptr), buildOutput_(nullptr), buildProgress_(nullptr), isGithubAuthenticated_(false) {
+MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), currentWorkspace_(nullptr), supervisor_(new ProcessSupervisor(this)), buildOutput_(nullptr), buildProgress_(nullptr), searchDock_(nullptr), searchEdit_(nullptr), searchRegexCheck_(nullptr), searchCaseCheck_(nullptr), searchScopeList_(nullptr), searchButton_(nullptr), searchStatus_(nullptr), searchResults_(nullptr), metricsDock_(nullptr), metricsTable_(nullptr), metricsTimer_(nullptr), jobsDock_(nullptr), jobsTable_(nullptr), jobLog_(nullptr), cancelJobButton_(nullptr), jobsTimer_(nullptr), isGithubAuthenticated_(false) {
+    MetricsRegistry::instance().loadFromFile(metricsFile_);
+    ResourceLimits limits;
+    limits.loadFromFile(limitsFile_);
+    supervisor_->setResourceLimits(limits);
     setupUI();
 }
 
 MainWindow::~MainWindow() {
+    // No reaper or search callbacks may reach this window once it is gone
+    Reaper::instance().shutdown();
+    if (activeSearch_) {
+        activeSearch_->cancel();
+    }
+    infoToken_.cancel();
+    targetsToken_.cancel();
+    TaskExecutor::instance().shutdown();
+    WorkStealingPool::instance().shutdown();
+
     // Save workspaces before exiting
     wm_.saveToFile();
+    MetricsRegistry::instance().saveToFile(metricsFile_);
     
-    // Clean up build process if running
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        buildProcess_->kill();
-        buildProcess_->waitForFinished(3000);
-    }
+    // Kill whatever children are left, with everything they spawned
+    delete supervisor_;
 }
 
 void MainWindow::setupUI() {
@@ -199,6 +236,50 @@ void MainWindow::setupUI() {
         }
     )");
 
+    // Search menu
+    QMenu *searchMenu = menuBar()->addMenu("Search");
+    QAction *findInWorkspacesAction = searchMenu->addAction("Find in Workspaces...", this, &MainWindow::showSearch);
+    findInWorkspacesAction->setShortcut(QKeySequence("Ctrl+Shift+F"));
+
+    // Build menu
+    QMenu *buildMenu = menuBar()->addMenu("Build");
+    buildMenu->addAction("Profile Compile", this, &MainWindow::profileCompile);
+    QMenu *watchMenu = buildMenu->addMenu("Watch");
+    QActionGroup *watchGroup = new QActionGroup(this);
+    watchOffAction_ = watchMenu->addAction("Off");
+    QAction *watchRebuildAction = watchMenu->addAction("Rebuild on Save");
+    QAction *watchCompileAction = watchMenu->addAction("Compile Saved File");
+    for (QAction *action : {watchOffAction_, watchRebuildAction, watchCompileAction}) {
+        action->setCheckable(true);
+        watchGroup->addAction(action);
+    }
+    watchOffAction_->setChecked(true);
+    if (!SourceWatcher::isSupported()) {
+        for (QAction *action : {watchRebuildAction, watchCompileAction}) {
+            action->setEnabled(false);
+            action->setToolTip("Watch mode needs Linux inotify");
+        }
+    }
+    connect(watchOffAction_, &QAction::triggered, this, [this]() { setWatchMode(WatchMode::Off); });
+    connect(watchRebuildAction, &QAction::triggered, this, [this]() { setWatchMode(WatchMode::Rebuild); });
+    connect(watchCompileAction, &QAction::triggered, this, [this]() { setWatchMode(WatchMode::CompileFile); });
+    // Changes saved during a build are built once it is over, whoever started it
+    connect(supervisor_, &ProcessSupervisor::jobsChanged, this, [this]() {
+        if (watchRestart_ && !supervisor_->isRunning(watchedWorkspace_, "build")) {
+            QTimer::singleShot(0, this, &MainWindow::startWatchBuild);
+        }
+    });
+    buildMenu->addSeparator();
+    buildMenu->addAction("Resource Limits...", this, &MainWindow::editResourceLimits);
+    buildMenu->addAction("Parallelism...", this, &MainWindow::tuneParallelism);
+    buildMenu->addAction("Distributed Compilation...", this, &MainWindow::editDistributedCompilation);
+    buildMenu->addAction("Linker...", this, &MainWindow::chooseLinker);
+    buildMenu->addAction("Benchmark Linkers", this, &MainWindow::benchmarkLinkers);
+
+    // Diagnostics menu
+    QMenu *diagnosticsMenu = menuBar()->addMenu("Diagnostics");
+    diagnosticsMenu->addAction("Export Trace...", this, &MainWindow::exportTrace);
+
     QWidget *centralWidget = new QWidget(this);
     setCentralWidget(centralWidget);
 
@@ -231,10 +312,19 @@ void MainWindow::setupUI() {
     infoDisplay_->setReadOnly(true);
     rightSplitter->addWidget(infoDisplay_);
 
-    // Build output area
+    // Build output area, with the last compile profile beside it
+    outputTabs_ = new QTabWidget();
     buildOutput_ = new QTextEdit();
     buildOutput_->setReadOnly(true);
-    rightSplitter->addWidget(buildOutput_);
+    outputTabs_->addTab(buildOutput_, "Build Output");
+    compileProfile_ = new QTextEdit();
+    compileProfile_->setReadOnly(true);
+    compileProfile_->setLineWrapMode(QTextEdit::NoWrap);
+    compileProfile_->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    compileProfile_->setPlaceholderText("Build > Profile Compile builds the workspace with clang's -ftime-trace "
+                                        "and lists its most expensive headers, templates and functions here.");
+    outputTabs_->addTab(compileProfile_, "Compile Profile");
+    rightSplitter->addWidget(outputTabs_);
 
     // Action panels container
     QWidget *actionsWidget = new QWidget();
@@ -259,6 +349,23 @@ void MainWindow::setupUI() {
     buildSystemCombo_->setCurrentText("Make");
     buildLayout->addWidget(buildSystemCombo_);
 
+    // Build configuration selection, each with its own build directory
+    buildLayout->addWidget(new QLabel("Configuration:"));
+    QHBoxLayout *configurationLayout = new QHBoxLayout();
+    configurationCombo_ = new QComboBox();
+    configurationCombo_->setEnabled(false);
+    newConfigurationButton_ = new QPushButton("New...");
+    newConfigurationButton_->setEnabled(false);
+    configurationLayout->addWidget(configurationCombo_, 1);
+    configurationLayout->addWidget(newConfigurationButton_);
+    buildLayout->addLayout(configurationLayout);
+
+    // Build one target, or compile one file, instead of everything
+    buildLayout->addWidget(new QLabel("Target:"));
+    targetCombo_ = new QComboBox();
+    targetCombo_->setEnabled(false);
+    buildLayout->addWidget(targetCombo_);
+
     buildButton_ = new QPushButton("Build");
     buildButton_->setObjectName("successButton");
     cleanButton_ = new QPushButton("Clean");
@@ -266,8 +373,10 @@ void MainWindow::setupUI() {
     runButton_ = new QPushButton("Run");
     runButton_->setObjectName("successButton");
     editMakefileButton_ = new QPushButton("Edit Makefile");
+    compileFileButton_ = new QPushButton("Compile File...");
 
     buildLayout->addWidget(buildButton_);
+    buildLayout->addWidget(compileFileButton_);
     buildLayout->addWidget(cleanButton_);
     buildLayout->addWidget(runButton_);
     buildLayout->addWidget(editMakefileButton_);
@@ -360,11 +469,15 @@ void MainWindow::setupUI() {
     
     // Build management connections
     connect(buildButton_, &QPushButton::clicked, this, &MainWindow::buildWorkspace);
+    connect(compileFileButton_, &QPushButton::clicked, this, &MainWindow::compileSingleFile);
     connect(cleanButton_, &QPushButton::clicked, this, &MainWindow::cleanWorkspace);
     connect(runButton_, &QPushButton::clicked, this, &MainWindow::runWorkspace);
     connect(editMakefileButton_, &QPushButton::clicked, this, &MainWindow::editMakefile);
     connect(buildSystemCombo_, QOverload<const QString &>::of(&QComboBox::currentTextChanged),
             this, &MainWindow::setBuildSystem);
+    connect(configurationCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::setConfiguration);
+    connect(newConfigurationButton_, &QPushButton::clicked, this, &MainWindow::newConfiguration);
     
     // Git versioning connections
     connect(majorButton_, &QPushButton::clicked, this, &MainWindow::gitMajorVersion);
@@ -385,6 +498,14 @@ void MainWindow::setupUI() {
     connect(runScriptButton_, &QPushButton::clicked, this, &MainWindow::runScript);
     connect(installSystemWideButton_, &QPushButton::clicked, this, &MainWindow::installSystemWide);
 
+    setupSearchDock();
+    setupMetricsDock();
+    diagnosticsMenu->addAction(metricsDock_->toggleViewAction());
+    setupJobsDock();
+    diagnosticsMenu->addAction(jobsDock_->toggleViewAction());
+    setupRunHistoryDock();
+    diagnosticsMenu->addAction(runHistoryDock_->toggleViewAction());
+
     // Initially disable action buttons
     updateActionButtons();
 
@@ -403,12 +524,563 @@ void MainWindow::setupUI() {
     }
 }
 
+void MainWindow::setupMetricsDock() {
+    metricsDock_ = new QDockWidget("Operation Latency", this);
+    metricsDock_->setObjectName("metricsDock");
+
+    QWidget *metricsWidget = new QWidget(metricsDock_);
+    QVBoxLayout *metricsLayout = new QVBoxLayout(metricsWidget);
+
+    metricsTable_ = new QTableWidget(0, 6, metricsWidget);
+    metricsTable_->setHorizontalHeaderLabels({"Operation", "Count", "p50", "p95", "p99", "Max"});
+    metricsTable_->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    metricsTable_->verticalHeader()->setVisible(false);
+    metricsTable_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    metricsLayout->addWidget(metricsTable_);
+
+    QPushButton *resetMetricsButton = new QPushButton("Reset", metricsWidget);
+    resetMetricsButton->setObjectName("dangerButton");
+    metricsLayout->addWidget(resetMetricsButton);
+    connect(resetMetricsButton, &QPushButton::clicked, this, &MainWindow::resetMetrics);
+
+    metricsDock_->setWidget(metricsWidget);
+    addDockWidget(Qt::BottomDockWidgetArea, metricsDock_);
+    metricsDock_->hide();
+
+    // Histograms are always recording; the table only refreshes while shown
+    metricsTimer_ = new QTimer(this);
+    metricsTimer_->setInterval(2000);
+    connect(metricsTimer_, &QTimer::timeout, this, &MainWindow::refreshMetrics);
+    connect(metricsDock_, &QDockWidget::visibilityChanged, [this](bool visible) {
+        if (visible) {
+            refreshMetrics();
+            metricsTimer_->start();
+        } else {
+            metricsTimer_->stop();
+        }
+    });
+}
+
+void MainWindow::setupJobsDock() {
+    jobsDock_ = new QDockWidget("Jobs", this);
+    jobsDock_->setObjectName("jobsDock");
+
+    QWidget *jobsWidget = new QWidget(jobsDock_);
+    QVBoxLayout *jobsLayout = new QVBoxLayout(jobsWidget);
+
+    jobsTable_ = new QTableWidget(0, 7, jobsWidget);
+    jobsTable_->setHorizontalHeaderLabels({"Workspace", "Action", "State", "Elapsed", "CPU", "Memory", "I/O"});
+    jobsTable_->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    jobsTable_->verticalHeader()->setVisible(false);
+    jobsTable_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    jobsTable_->setSelectionBehavior(QAbstractItemView::SelectRows);
+    jobsTable_->setSelectionMode(QAbstractItemView::SingleSelection);
+    jobsLayout->addWidget(jobsTable_);
+
+    jobLog_ = new QTextEdit(jobsWidget);
+    jobLog_->setReadOnly(true);
+    jobsLayout->addWidget(jobLog_);
+
+    cancelJobButton_ = new QPushButton("Cancel Job", jobsWidget);
+    cancelJobButton_->setObjectName("dangerButton");
+    cancelJobButton_->setEnabled(false);
+    jobsLayout->addWidget(cancelJobButton_);
+
+    jobsDock_->setWidget(jobsWidget);
+    addDockWidget(Qt::BottomDockWidgetArea, jobsDock_);
+    jobsDock_->hide();
+
+    connect(jobsTable_, &QTableWidget::itemSelectionChanged, this, &MainWindow::showSelectedJobLog);
+    connect(cancelJobButton_, &QPushButton::clicked, this, &MainWindow::cancelSelectedJob);
+    connect(supervisor_, &ProcessSupervisor::jobsChanged, this, &MainWindow::updateBuildProgress);
+
+    // Elapsed times keep moving, so the table ticks while it is shown
+    jobsTimer_ = new QTimer(this);
+    jobsTimer_->setInterval(1000);
+    connect(jobsTimer_, &QTimer::timeout, this, &MainWindow::refreshJobs);
+    connect(supervisor_, &ProcessSupervisor::jobsChanged, this, [this]() {
+        if (jobsDock_->isVisible()) {
+            refreshJobs();
+        }
+    });
+    connect(jobsDock_, &QDockWidget::visibilityChanged, [this](bool visible) {
+        if (visible) {
+            refreshJobs();
+            jobsTimer_->start();
+        } else {
+            jobsTimer_->stop();
+        }
+    });
+}
+
+void MainWindow::setupRunHistoryDock() {
+    runHistoryDock_ = new QDockWidget("Run History", this);
+    runHistoryDock_->setObjectName("runHistoryDock");
+
+    QWidget *historyWidget = new QWidget(runHistoryDock_);
+    QVBoxLayout *historyLayout = new QVBoxLayout(historyWidget);
+
+    runMetricCombo_ = new QComboBox(historyWidget);
+    for (RunChart::Metric metric : {RunChart::Metric::WallTime, RunChart::Metric::CpuTime,
+                                    RunChart::Metric::PeakMemory, RunChart::Metric::Processes,
+                                    RunChart::Metric::BytesRead, RunChart::Metric::BytesWritten}) {
+        runMetricCombo_->addItem(RunChart::metricName(metric), static_cast<int>(metric));
+    }
+    historyLayout->addWidget(runMetricCombo_);
+
+    runChart_ = new RunChart(historyWidget);
+    historyLayout->addWidget(runChart_, 1);
+
+    runTable_ = new QTableWidget(0, 9, historyWidget);
+    runTable_->setHorizontalHeaderLabels({"Finished", "Action", "Exit", "Wall", "CPU", "Peak Memory",
+                                          "Processes", "Read", "Written"});
+    runTable_->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    runTable_->verticalHeader()->setVisible(false);
+    runTable_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    runTable_->setSelectionBehavior(QAbstractItemView::SelectRows);
+    historyLayout->addWidget(runTable_, 1);
+
+    runHistoryDock_->setWidget(historyWidget);
+    addDockWidget(Qt::BottomDockWidgetArea, runHistoryDock_);
+    runHistoryDock_->hide();
+
+    connect(runMetricCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        runChart_->setMetric(static_cast<RunChart::Metric>(runMetricCombo_->currentData().toInt()));
+    });
+    connect(runHistoryDock_, &QDockWidget::visibilityChanged, [this](bool visible) {
+        if (visible) {
+            refreshRunHistory();
+        }
+    });
+}
+
+void MainWindow::setupSearchDock() {
+    searchDock_ = new QDockWidget("Search", this);
+    searchDock_->setObjectName("searchDock");
+
+    QWidget *searchWidget = new QWidget(searchDock_);
+    QHBoxLayout *searchLayout = new QHBoxLayout(searchWidget);
+
+    // Left: which workspaces to search
+    QVBoxLayout *scopeLayout = new QVBoxLayout();
+    scopeLayout->addWidget(new QLabel("Search In:", searchWidget));
+    searchScopeList_ = new QListWidget(searchWidget);
+    searchScopeList_->setMaximumWidth(220);
+    scopeLayout->addWidget(searchScopeList_);
+    searchLayout->addLayout(scopeLayout);
+
+    // Right: query and streamed results
+    QVBoxLayout *resultsLayout = new QVBoxLayout();
+    QHBoxLayout *queryLayout = new QHBoxLayout();
+    searchEdit_ = new QLineEdit(searchWidget);
+    searchEdit_->setPlaceholderText("Text or regular expression");
+    searchRegexCheck_ = new QCheckBox("Regex", searchWidget);
+    searchCaseCheck_ = new QCheckBox("Match Case", searchWidget);
+    searchCaseCheck_->setChecked(true);
+    searchButton_ = new QPushButton("Search", searchWidget);
+    searchButton_->setObjectName("successButton");
+    queryLayout->addWidget(searchEdit_, 1);
+    queryLayout->addWidget(searchRegexCheck_);
+    queryLayout->addWidget(searchCaseCheck_);
+    queryLayout->addWidget(searchButton_);
+    resultsLayout->addLayout(queryLayout);
+
+    searchResults_ = new QTableWidget(0, 4, searchWidget);
+    searchResults_->setHorizontalHeaderLabels({"Workspace", "File", "Line", "Text"});
+    searchResults_->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    searchResults_->horizontalHeader()->setStretchLastSection(true);
+    searchResults_->verticalHeader()->setVisible(false);
+    searchResults_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    searchResults_->setSelectionBehavior(QAbstractItemView::SelectRows);
+    resultsLayout->addWidget(searchResults_);
+
+    searchStatus_ = new QLabel(searchWidget);
+    resultsLayout->addWidget(searchStatus_);
+    searchLayout->addLayout(resultsLayout, 1);
+
+    connect(searchEdit_, &QLineEdit::returnPressed, this, &MainWindow::startSearch);
+    connect(searchButton_, &QPushButton::clicked, this, &MainWindow::startSearch);
+    connect(searchResults_, &QTableWidget::cellDoubleClicked, this, &MainWindow::openSearchResult);
+
+    searchDock_->setWidget(searchWidget);
+    addDockWidget(Qt::BottomDockWidgetArea, searchDock_);
+    searchDock_->hide();
+}
+
+void MainWindow::populateSearchScope() {
+    // Keep the user's choices for workspaces that are still registered
+    QStringList checked;
+    for (int i = 0; i < searchScopeList_->count(); ++i) {
+        if (searchScopeList_->item(i)->checkState() == Qt::Checked) {
+            checked << searchScopeList_->item(i)->text();
+        }
+    }
+    bool firstTime = searchScopeList_->count() == 0;
+
+    searchScopeList_->clear();
+    for (const auto& entry : wm_.listWorkspaces()) {
+        QString text = QString::fromStdString(entry);
+        QString name = text.left(text.indexOf(':'));
+        QListWidgetItem *item = new QListWidgetItem(name, searchScopeList_);
+        item->setToolTip(text.mid(text.indexOf(':') + 2));
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        bool include = firstTime ? name == currentWorkspaceName_ : checked.contains(name);
+        item->setCheckState(include ? Qt::Checked : Qt::Unchecked);
+    }
+}
+
+void MainWindow::showSearch() {
+    populateSearchScope();
+    searchDock_->show();
+    searchDock_->raise();
+    searchEdit_->setFocus();
+    searchEdit_->selectAll();
+}
+
+void MainWindow::startSearch() {
+    TRACE_SCOPE("MainWindow::startSearch", "ui");
+    // The same button stops a running search
+    if (activeSearch_) {
+        activeSearch_->cancel();
+        return;
+    }
+
+    QString pattern = searchEdit_->text();
+    if (pattern.isEmpty()) return;
+
+    std::vector<SearchRoot> roots;
+    for (int i = 0; i < searchScopeList_->count(); ++i) {
+        QListWidgetItem *item = searchScopeList_->item(i);
+        if (item->checkState() == Qt::Checked) {
+            roots.push_back({item->text().toStdString(), item->toolTip().toStdString()});
+        }
+    }
+    if (roots.empty()) {
+        QMessageBox::warning(this, "No Workspaces Selected", "Check at least one workspace to search in.");
+        return;
+    }
+
+    SearchQuery query;
+    query.pattern = pattern.toStdString();
+    query.regex = searchRegexCheck_->isChecked();
+    query.caseSensitive = searchCaseCheck_->isChecked();
+    query.maxMatches = 5000;
+
+    uint64_t generation = ++searchGeneration_;
+    searchResults_->setRowCount(0);
+    searchStatus_->setText("Searching...");
+
+    // Both callbacks arrive on pool threads
+    activeSearch_ = TextSearch::create(query, roots,
+        [this, generation](std::vector<SearchMatch> matches) {
+            QMetaObject::invokeMethod(this, [this, generation, matches = std::move(matches)]() {
+                if (generation == searchGeneration_) {
+                    appendSearchMatches(matches);
+                }
+            }, Qt::QueuedConnection);
+        },
+        [this, generation](const SearchSummary& summary) {
+            QMetaObject::invokeMethod(this, [this, generation, summary]() {
+                if (generation != searchGeneration_) return;
+                activeSearch_.reset();
+                searchButton_->setText("Search");
+                QString status = QString("%1 matches in %2 files searched (%3 s)")
+                                 .arg(summary.matches)
+                                 .arg(summary.filesSearched)
+                                 .arg(summary.seconds, 0, 'f', 2);
+                if (summary.truncated) {
+                    status += " - stopped at the first 5000 matches";
+                } else if (summary.cancelled) {
+                    status += " - stopped";
+                }
+                searchStatus_->setText(status);
+            }, Qt::QueuedConnection);
+        });
+
+    std::string error;
+    if (!activeSearch_->start(&error)) {
+        activeSearch_.reset();
+        searchStatus_->clear();
+        QMessageBox::warning(this, "Invalid Pattern",
+                             QString("The regular expression is not valid:\n%1").arg(QString::fromStdString(error)));
+        return;
+    }
+    searchButton_->setText("Stop");
+}
+
+void MainWindow::appendSearchMatches(const std::vector<SearchMatch>& matches) {
+    int row = searchResults_->rowCount();
+    int available = std::max(0, 5000 - row);
+    int count = std::min(available, static_cast<int>(matches.size()));
+    searchResults_->setRowCount(row + count);
+
+    for (int i = 0; i < count; ++i, ++row) {
+        const SearchMatch& match = matches[i];
+        searchResults_->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(match.workspace)));
+        searchResults_->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(match.path)));
+        searchResults_->setItem(row, 2, new QTableWidgetItem(QString::number(match.line)));
+        searchResults_->setItem(row, 3, new QTableWidgetItem(QString::fromStdString(match.text).trimmed()));
+    }
+    searchStatus_->setText(QString("Searching... %1 matches").arg(searchResults_->rowCount()));
+}
+
+void MainWindow::openSearchResult(int row, int column) {
+    Q_UNUSED(column);
+    QTableWidgetItem *workspaceItem = searchResults_->item(row, 0);
+    QTableWidgetItem *fileItem = searchResults_->item(row, 1);
+    if (!workspaceItem || !fileItem) return;
+
+    Workspace *ws = wm_.getWorkspace(workspaceItem->text().toStdString());
+    if (!ws) return;
+    QString filePath = QString::fromStdString(ws->getPath()) + "/" + fileItem->text();
+    QDesktopServices::openUrl(QUrl::fromLocalFile(filePath));
+}
+
+static QString formatLatency(uint64_t micros) {
+    if (micros < 1000) {
+        return QString("%1 us").arg(micros);
+    }
+    if (micros < 1000000) {
+        return QString("%1 ms").arg(micros / 1000.0, 0, 'f', 1);
+    }
+    return QString("%1 s").arg(micros / 1000000.0, 0, 'f', 2);
+}
+
+void MainWindow::refreshMetrics() {
+    auto histograms = MetricsRegistry::instance().snapshot();
+    metricsTable_->setRowCount(static_cast<int>(histograms.size()));
+
+    int row = 0;
+    for (const auto& pair : histograms) {
+        const LatencyHistogram& histogram = pair.second;
+        QStringList cells = {
+            QString::fromStdString(pair.first),
+            QString::number(histogram.count()),
+            formatLatency(histogram.percentile(50)),
+            formatLatency(histogram.percentile(95)),
+            formatLatency(histogram.percentile(99)),
+            formatLatency(histogram.max())
+        };
+        for (int column = 0; column < cells.size(); ++column) {
+            metricsTable_->setItem(row, column, new QTableWidgetItem(cells[column]));
+        }
+        ++row;
+    }
+}
+
+static const char* jobStateName(ProcessJob::State state) {
+    switch (state) {
+    case ProcessJob::State::Pending: return "Pending";
+    case ProcessJob::State::Running: return "Running";
+    case ProcessJob::State::Finished: return "Finished";
+    case ProcessJob::State::Failed: return "Failed";
+    case ProcessJob::State::Cancelled: return "Cancelled";
+    }
+    return "";
+}
+
+static ProcessJob* findJob(const ProcessSupervisor* supervisor, quint64 id) {
+    for (ProcessJob* job : supervisor->jobs()) {
+        if (job->id() == id) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void MainWindow::refreshJobs() {
+    QList<QTableWidgetItem*> selected = jobsTable_->selectedItems();
+    quint64 selectedId = selected.isEmpty() ? 0 : selected.first()->data(Qt::UserRole).toULongLong();
+
+    // Newest first
+    const QList<ProcessJob*>& jobs = supervisor_->jobs();
+    jobsTable_->blockSignals(true);
+    jobsTable_->setRowCount(jobs.size());
+    for (int row = 0; row < jobs.size(); ++row) {
+        ProcessJob* job = jobs[jobs.size() - 1 - row];
+        QString state = jobStateName(job->state());
+        QString cpu = "-", memory = "-", io = "-";
+        // Running jobs only have numbers while their cgroup can be read;
+        // finished ones report what the helper's wait4 returned
+        CgroupUsage live = job->isActive() ? job->cgroupUsage() : CgroupUsage();
+        const ProcessUsage& usage = job->usage();
+        if (live.valid) {
+            cpu = QString("%1 s").arg(live.cpuUsec / 1e6, 0, 'f', 2);
+            memory = QString("%1 MB").arg(live.memoryCurrent / (1024.0 * 1024.0), 0, 'f', 1);
+            io = QString("%1 MB").arg((live.ioReadBytes + live.ioWriteBytes) / (1024.0 * 1024.0), 0, 'f', 1);
+            state += QString(" (%1 processes)").arg(live.processes);
+        } else if (usage.valid) {
+            cpu = QString("%1 s").arg(usage.userSeconds + usage.systemSeconds, 0, 'f', 2);
+            memory = QString("%1 MB peak").arg(usage.maxRssKb / 1024.0, 0, 'f', 1);
+            io = QString("%1 MB").arg((usage.blockInputs + usage.blockOutputs) * 512 / (1024.0 * 1024.0), 0, 'f', 1);
+        }
+        if (job->isConfined()) {
+            state += " [cgroup]";
+        }
+        QStringList cells = {
+            job->workspace().isEmpty() ? QString("-") : job->workspace(),
+            job->action(),
+            state,
+            formatLatency(static_cast<uint64_t>(job->elapsedNs() / 1000)),
+            cpu,
+            memory,
+            io
+        };
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem(cells[column]);
+            item->setData(Qt::UserRole, job->id());
+            item->setToolTip(job->description());
+            jobsTable_->setItem(row, column, item);
+        }
+        if (job->id() == selectedId) {
+            jobsTable_->selectRow(row);
+        }
+    }
+    jobsTable_->blockSignals(false);
+
+    ProcessJob *job = findJob(supervisor_, selectedId);
+    if (job && job->isActive()) {
+        showSelectedJobLog();
+    }
+    cancelJobButton_->setEnabled(job && job->isActive());
+}
+
+void MainWindow::showSelectedJobLog() {
+    QList<QTableWidgetItem*> selected = jobsTable_->selectedItems();
+    ProcessJob *job = selected.isEmpty() ? nullptr : findJob(supervisor_, selected.first()->data(Qt::UserRole).toULongLong());
+    cancelJobButton_->setEnabled(job && job->isActive());
+    if (!job) {
+        jobLog_->clear();
+        return;
+    }
+    jobLog_->setPlainText(job->log());
+    jobLog_->verticalScrollBar()->setValue(jobLog_->verticalScrollBar()->maximum());
+}
+
+void MainWindow::cancelSelectedJob() {
+    QList<QTableWidgetItem*> selected = jobsTable_->selectedItems();
+    ProcessJob *job = selected.isEmpty() ? nullptr : findJob(supervisor_, selected.first()->data(Qt::UserRole).toULongLong());
+    if (job) {
+        job->cancel();
+    }
+}
+
+void MainWindow::refreshRunHistory() {
+    std::vector<RunRecord> records;
+    if (currentWorkspace_) {
+        RunHistory history(currentWorkspace_->runHistoryFile());
+        history.load();
+        records = history.records();
+    }
+    runHistoryDock_->setWindowTitle(currentWorkspace_ ? "Run History: " + currentWorkspaceName_ : "Run History");
+    runChart_->setRecords(records);
+
+    // Newest first
+    runTable_->setRowCount(static_cast<int>(records.size()));
+    for (int row = 0; row < static_cast<int>(records.size()); ++row) {
+        const RunRecord& record = records[records.size() - 1 - row];
+        QStringList cells = {
+            QDateTime::fromSecsSinceEpoch(record.time).toString("yyyy-MM-dd HH:mm:ss"),
+            QString::fromStdString(record.action),
+            QString::number(record.exitCode),
+            RunChart::formatValue(RunChart::value(record, RunChart::Metric::WallTime), RunChart::Metric::WallTime),
+            RunChart::formatValue(RunChart::value(record, RunChart::Metric::CpuTime), RunChart::Metric::CpuTime),
+            RunChart::formatValue(RunChart::value(record, RunChart::Metric::PeakMemory), RunChart::Metric::PeakMemory),
+            QString::number(record.processes),
+            RunChart::formatValue(RunChart::value(record, RunChart::Metric::BytesRead), RunChart::Metric::BytesRead),
+            RunChart::formatValue(RunChart::value(record, RunChart::Metric::BytesWritten), RunChart::Metric::BytesWritten)
+        };
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem(cells[column]);
+            item->setToolTip(QString::fromStdString(record.description));
+            runTable_->setItem(row, column, item);
+        }
+    }
+}
+
+static RunRecord runRecordOf(const ProcessJob* job) {
+    const ProcessUsage& usage = job->usage();
+    RunRecord record;
+    record.time = QDateTime::currentSecsSinceEpoch();
+    record.action = job->action().toStdString();
+    // A crash has no exit code of its own
+    record.exitCode = job->state() == ProcessJob::State::Finished ? 0 : job->exitCode() != 0 ? job->exitCode() : -1;
+    record.wallSeconds = job->elapsedNs() / 1e9;
+    record.userSeconds = usage.userSeconds;
+    record.systemSeconds = usage.systemSeconds;
+    record.maxRssKb = static_cast<uint64_t>(usage.maxRssKb);
+    record.processes = usage.processes;
+    record.readBytes = usage.readChars;
+    record.writtenBytes = usage.writtenChars;
+    // A cgroup saw the whole tree at once, including processes that left
+    // its process group, and without gaps between samples
+    const CgroupUsage& group = usage.cgroup;
+    record.peakKb = group.valid && group.memoryPeak > 0 ? group.memoryPeak / 1024
+                                                         : static_cast<uint64_t>(usage.peakTreeRssKb);
+    bool groupIo = group.valid && group.ioReadBytes + group.ioWriteBytes > 0;
+    record.storageReadBytes = groupIo ? group.ioReadBytes : usage.storageReadBytes;
+    record.storageWriteBytes = groupIo ? group.ioWriteBytes : usage.storageWriteBytes;
+    record.description = job->description().toStdString();
+    return record;
+}
+
+void MainWindow::recordRun(const ProcessJob* job, const QString& action) {
+    // A cancelled run says nothing about what a whole one costs
+    if (job->state() == ProcessJob::State::Cancelled || !job->usage().valid) {
+        return;
+    }
+    Workspace *ws = wm_.getWorkspace(job->workspace().toStdString());
+    if (!ws) {
+        return;
+    }
+    RunRecord record = runRecordOf(job);
+    if (!action.isEmpty()) {
+        record.action = action.toStdString();
+    }
+    ws->prepareStateDirectory();
+    RunHistory history(ws->runHistoryFile());
+    history.load();
+    history.append(record);
+
+    if (showsOutputOf(job)) {
+        using Metric = RunChart::Metric;
+        buildOutput_->append(QString("Resources: %1 CPU (%2 user, %3 system) in %4, peak memory %5 "
+                                     "(largest process %6), %7 processes, read %8, wrote %9 (disk %10 in, %11 out)\n")
+                             .arg(RunChart::formatValue(record.cpuSeconds(), Metric::CpuTime))
+                             .arg(RunChart::formatValue(record.userSeconds, Metric::CpuTime))
+                             .arg(RunChart::formatValue(record.systemSeconds, Metric::CpuTime))
+                             .arg(RunChart::formatValue(record.wallSeconds, Metric::WallTime))
+                             .arg(RunChart::formatValue(RunChart::value(record, Metric::PeakMemory), Metric::PeakMemory))
+                             .arg(RunChart::formatValue(record.maxRssKb * 1024.0, Metric::PeakMemory))
+                             .arg(record.processes)
+                             .arg(RunChart::formatValue(static_cast<double>(record.readBytes), Metric::BytesRead))
+                             .arg(RunChart::formatValue(static_cast<double>(record.writtenBytes), Metric::BytesWritten))
+                             .arg(RunChart::formatValue(static_cast<double>(record.storageReadBytes), Metric::BytesRead))
+                             .arg(RunChart::formatValue(static_cast<double>(record.storageWriteBytes), Metric::BytesWritten)));
+    }
+    if (ws == currentWorkspace_ && runHistoryDock_->isVisible()) {
+        refreshRunHistory();
+    }
+}
+
+void MainWindow::resetMetrics() {
+    int ret = QMessageBox::question(this, "Reset Metrics",
+                                   "Discard all recorded operation latencies, including previous sessions?",
+                                   QMessageBox::Yes | QMessageBox::No);
+    if (ret == QMessageBox::Yes) {
+        MetricsRegistry::instance().reset();
+        MetricsRegistry::instance().saveToFile(metricsFile_);
+        refreshMetrics();
+    }
+}
+
 void MainWindow::addWorkspace() {
     // This function is kept for compatibility but redirects to addLocalWorkspace
     addLocalWorkspace();
 }
 
 void MainWindow::addLocalWorkspace() {
+    TRACE_SCOPE("MainWindow::addLocalWorkspace", "ui");
     QString path = QFileDialog::getExistingDirectory(this, "Select Workspace Directory", QDir::homePath());
     if (!path.isEmpty()) {
         // Automatically generate workspace name from folder name
@@ -436,6 +1108,7 @@ void MainWindow::addLocalWorkspace() {
 }
 
 void MainWindow::cloneGithubRepo() {
+    TRACE_SCOPE("MainWindow::cloneGithubRepo", "github");
     QString repoUrl = QInputDialog::getText(this, "Clone GitHub Repository", 
                                           "GitHub Repository URL:\n(https://github.com/user/repo or git@github.com:user/repo.git)");
     
@@ -461,53 +1134,11 @@ void MainWindow::cloneGithubRepo() {
         return;
     }
     
-    QString clonePath = baseDir + "/" + repoName;
-    
-    // Check if directory already exists
-    if (QDir(clonePath).exists()) {
-        int ret = QMessageBox::question(this, "Directory Exists", 
-                                      QString("Directory '%1' already exists. Continue anyway?").arg(clonePath),
-                                      QMessageBox::Yes | QMessageBox::No);
-        if (ret != QMessageBox::Yes) {
-            return;
-        }
-    }
-    
-    // Show progress and start clone process
-    buildOutput_->clear();
-    buildOutput_->append(QString("=== Cloning repository: %1 ===").arg(repoUrl));
-    buildOutput_->append(QString("Destination: %1").arg(clonePath));
-    buildOutput_->append("");
-    
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "Process Running", "Another process is already running. Please wait for it to finish.");
-        return;
-    }
-    
-    buildProcess_ = new QProcess(this);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            [this, repoName, clonePath](int exitCode, QProcess::ExitStatus exitStatus) {
-                onCloneFinished(exitCode, exitStatus, repoName, clonePath);
-            });
-    connect(buildProcess_, &QProcess::readyReadStandardOutput, this, &MainWindow::onScriptOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError, this, &MainWindow::onScriptOutput);
-    
-    buildProgress_->setVisible(true);
-    buildProgress_->setRange(0, 0); // Indeterminate progress
-    
-    // Start git clone
-    buildProcess_->setWorkingDirectory(baseDir);
-    buildProcess_->start("git", QStringList() << "clone" << repoUrl << repoName);
-    
-    if (!buildProcess_->waitForStarted()) {
-        QMessageBox::critical(this, "Clone Failed", "Failed to start git clone process.");
-        buildProgress_->setVisible(false);
-        buildProcess_->deleteLater();
-        buildProcess_ = nullptr;
-    }
+    startCloneProcess(repoUrl, repoName, baseDir + "/" + repoName);
 }
 
 void MainWindow::removeWorkspace() {
+    TRACE_SCOPE("MainWindow::removeWorkspace", "ui");
     QListWidgetItem* currentItem = workspaceList_->currentItem();
     if (!currentItem) {
         QMessageBox::warning(this, "No Workspace Selected", "Please select a workspace to remove.");
@@ -538,10 +1169,15 @@ void MainWindow::removeWorkspace() {
         if (currentWorkspaceName_ == name) {
             currentWorkspace_ = nullptr;
             currentWorkspaceName_.clear();
+            updateWatcher();
+            infoToken_.cancel();
             infoDisplay_->clear();
             infoDisplay_->setText("No workspace selected");
+            if (runHistoryDock_->isVisible()) {
+                refreshRunHistory();
+            }
         }
-        
+
         // Update button states
         updateActionButtons();
         
@@ -550,29 +1186,106 @@ void MainWindow::removeWorkspace() {
     }
 }
 
-void MainWindow::onBuildFinished(int exitCode, QProcess::ExitStatus exitStatus) {
+void MainWindow::onBuildFinished(const BuildRequest& request, const ProcessJob* job, int exitCode, QProcess::ExitStatus exitStatus) {
+    Workspace *built = wm_.getWorkspace(request.workspace.toStdString());
+    if (!request.distributedTool.isEmpty() && !distributedCompiles_.isEmpty() && showsOutputOf(job)) {
+        sampleDistributedCompiles();
+        QStringList perHost;
+        for (auto it = distributedCompiles_.constBegin(); it != distributedCompiles_.constEnd(); ++it) {
+            perHost << QString("%1 %2").arg(it.key()).arg(it.value());
+        }
+        buildOutput_->append(QString("Compiles per host (sampled): %1\n").arg(perHost.join(", ")));
+    }
+    if (job->state() == ProcessJob::State::Cancelled) {
+        if (showsOutputOf(job)) {
+            buildOutput_->append("Build cancelled.\n");
+        }
+        return;
+    }
+    recordRun(job, request.historyAction);
+    if (request.automatic) {
+        // Errors are in the build output already; a dialog per save would be in the way
+        bool succeeded = exitCode == 0 && exitStatus == QProcess::NormalExit;
+        if (succeeded && built && request.recordDigest) {
+            built->recordSuccessfulBuild(request.configuration,
+                                         built->buildKey(request.configuration, request.digest, request.generator));
+        }
+        if (succeeded && built && built == currentWorkspace_) {
+            populateTargets();
+        }
+        statusBar()->showMessage(QString("Watch: %1 %2 after %3 s")
+                                 .arg(job->description(), succeeded ? "succeeded" : "FAILED")
+                                 .arg(job->elapsedNs() / 1e9, 0, 'f', 1), 10000);
+        return;
+    }
     if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
-        QMessageBox::information(this, "Build Complete", "Build completed successfully!");
+        if (built && request.recordDigest) {
+            // Keyed with the settings as built; configuring may have rewritten the cache
+            built->recordSuccessfulBuild(request.configuration,
+                                         built->buildKey(request.configuration, request.digest, request.generator));
+        }
+        if (request.profile) {
+            showCompileProfile(request);
+        }
+        if (built && request.trial && job->usage().valid) {
+            ParallelismSample sample;
+            sample.jobs = request.jobs;
+            sample.wallSeconds = job->elapsedNs() / 1e9;
+            sample.cpuSeconds = job->usage().userSeconds + job->usage().systemSeconds;
+            ParallelismTuner tuner(built->parallelismFile());
+            tuner.load();
+            bool settled = tuner.record(sample);
+            tuner.save();
+            if (showsOutputOf(job)) {
+                buildOutput_->append(QString("Autotune: %1 jobs kept %2 cores busy (%3% efficiency)\n")
+                                     .arg(sample.jobs).arg(sample.speedup(), 0, 'f', 1)
+                                     .arg(sample.efficiency() * 100.0, 0, 'f', 0));
+                if (settled) {
+                    buildOutput_->append(QString("Autotune finished: building '%1' with %2 jobs from now on\n")
+                                         .arg(request.workspace).arg(tuner.tunedJobs()));
+                }
+            }
+        }
+        // A reconfigure may have added or removed targets
+        if (built && built == currentWorkspace_) {
+            populateTargets();
+        }
+        QMessageBox::information(this, "Build Complete",
+                                 QString("Build of '%1' completed successfully!").arg(request.workspace));
     } else {
-        QMessageBox::warning(this, "Build Failed", "Build failed. Check the project configuration.");
+        QMessageBox::warning(this, "Build Failed",
+                             QString("Build of '%1' failed. Check the project configuration.").arg(request.workspace));
     }
+}
 
-    buildProgress_->setVisible(false);
-    buildProcess_->deleteLater();
-    buildProcess_ = nullptr;
+bool MainWindow::showsOutputOf(const ProcessJob* job) {
+    return !job || job->workspace() == currentWorkspaceName_ || !wm_.getWorkspace(job->workspace().toStdString());
+}
+
+void MainWindow::updateBuildProgress() {
+    bool active = false;
+    for (const ProcessJob* job : supervisor_->jobs()) {
+        active = active || job->isActive();
+    }
+    buildProgress_->setVisible(active);
 }
 
-void MainWindow::onBuildOutput() {
-    QString output = buildProcess_->readAllStandardOutput();
-    buildOutput_->append(output);
+void MainWindow::onBuildOutput(const QString& text, bool isError) {
+    if (!showsOutputOf(qobject_cast<ProcessJob*>(sender()))) {
+        return;
+    }
+    buildOutput_->append(text);
+    if (isError) {
+        return;
+    }
 
     // Parse progress
-    if (output.contains('[', Qt::CaseInsensitive) && output.contains('%')) {
-        int start = output.indexOf('[');
+    if (text.contains('[', Qt::CaseInsensitive) && text.contains('%')) {
+        int start = text.indexOf('[');
         if (start != -1) {
-            int pct = output.mid(start + 1).indexOf('%');
+            int pct = text.mid(start + 1).indexOf('%');
             if (pct != -1) {
-                QString progressStr = output.mid(start + 1, pct - start);
+                QString progressStr = text.mid(start + 1, pct - start);
                 bool ok;
                 int progress = progressStr.toInt(&ok);
                 if (ok && progress >= 0 && progress <= 100) {
@@ -581,81 +1294,172 @@ void MainWindow::onBuildOutput() {
             }
         }
     }
-
-    QString error = buildProcess_->readAllStandardError();
-    if (!error.isEmpty()) {
-        buildOutput_->append(error);
-    }
 }
 
-void MainWindow::onCmakeFinished(int exitCode, QProcess::ExitStatus exitStatus) {
+void MainWindow::onCmakeFinished(const BuildRequest& request, const ProcessJob* job, int exitCode, QProcess::ExitStatus exitStatus) {
+    if (job->state() == ProcessJob::State::Cancelled) {
+        buildOutput_->append("CMake configuration cancelled.\n");
+        return;
+    }
     if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
         buildOutput_->append("CMake configuration completed successfully!\n");
+        if (Workspace *configured = wm_.getWorkspace(request.workspace.toStdString())) {
+            configured->recordConfigureCache();
+        }
         buildOutput_->append("Starting make build...\n");
-        startMakeBuild();
+        startMakeBuild(request);
     } else {
         buildOutput_->append("CMake configuration failed!\n");
-        buildProgress_->setVisible(false);
-        QMessageBox::warning(this, "CMake Failed", "CMake configuration failed. Check the build output for details.");
-        
-        if (buildProcess_) {
-            buildProcess_->deleteLater();
-            buildProcess_ = nullptr;
+        if (request.automatic) {
+            statusBar()->showMessage(QString("Watch: configuring '%1' FAILED").arg(request.workspace), 10000);
+            return;
         }
+        QMessageBox::warning(this, "CMake Failed", "CMake configuration failed. Check the build output for details.");
     }
 }
 
-void MainWindow::startMakeBuild() {
-    if (!currentWorkspace_) return;
-    
-    QString buildDir = QString::fromStdString(currentWorkspace_->getPath()) + "/build";
-    
-    if (buildProcess_) {
-        buildProcess_->deleteLater();
+void MainWindow::startMakeBuild(const BuildRequest& request) {
+    TRACE_SCOPE("MainWindow::startMakeBuild", "build");
+    ProcessJob *job = supervisor_->create(request.workspace, "build", "cmake --build " + request.buildDir);
+    if (request.automatic) {
+        watchJobs_.insert(job->id());
     }
+    job->setScope(request.buildDir);
+    job->process()->setWorkingDirectory(request.buildDir);
+    connect(job, &ProcessJob::output, this, &MainWindow::onBuildOutput);
+    connect(job, &ProcessJob::finished, this, [this, request, job](int exitCode, QProcess::ExitStatus exitStatus) {
+        onBuildFinished(request, job, exitCode, exitStatus);
+    });
     
-    buildProcess_ = new QProcess(this);
-    buildProcess_->setWorkingDirectory(buildDir);
-    
-    connect(buildProcess_, &QProcess::readyReadStandardOutput, this, &MainWindow::onBuildOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError, this, &MainWindow::onBuildOutput);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &MainWindow::onBuildFinished);
-    
-    buildOutput_->append("Running make...\n");
-    buildProcess_->start("make", QStringList());
+    // Drive whichever generator was configured, and only the chosen target
+    QStringList arguments;
+    arguments << "--build" << "." << "--parallel" << QString::number(request.jobs);
+    if (request.profile) {
+        arguments << "--clean-first";
+    }
+    if (!request.target.isEmpty()) {
+        arguments << "--target" << request.target;
+    }
+
+    buildOutput_->append(QString("Executing: cmake %1\n").arg(arguments.join(" ")));
+    setBuildEnvironment(job, request);
+    instrumentProcess(job, "build", request.buildDir, "build");
+    job->start("cmake", arguments);
 }
 
 void MainWindow::selectWorkspace(QListWidgetItem* item) {
+    TRACE_SCOPE("MainWindow::selectWorkspace", "ui");
+    ScopedLatency selectLatency("select");
     QString text = item->text();
     size_t colon = text.indexOf(':');
     QString name = text.left(colon);
     currentWorkspaceName_ = name;
     currentWorkspace_ = wm_.getWorkspace(name.toStdString());
     if (currentWorkspace_) {
+        populateConfigurations();
+        populateTargets();
         displayWorkspaceInfo(currentWorkspace_);
         updateActionButtons();
     }
+    // Watch mode follows the selection
+    updateWatcher();
+    if (runHistoryDock_->isVisible()) {
+        refreshRunHistory();
+    }
     removeButton_->setEnabled(true);
 }
 
 void MainWindow::refreshWorkspace() {
+    TRACE_SCOPE("MainWindow::refreshWorkspace", "ui");
     if (currentWorkspace_) {
         displayWorkspaceInfo(currentWorkspace_);
     }
 }
 
 void MainWindow::displayWorkspaceInfo(Workspace* ws) {
-    infoDisplay_->clear();
-    QString info = "Path: " + QString::fromStdString(ws->getPath()) + "\n\n";
+    TRACE_SCOPE("MainWindow::displayWorkspaceInfo", "ui");
+    QString path = QString::fromStdString(ws->getPath());
+
+    // Stale-while-revalidate: show the last snapshot at once, marked as
+    // such, and recompute everything in the background
+    InfoSnapshot cached;
+    bool haveCached = ws->loadInfoSnapshot(cached);
+    if (haveCached) {
+        showWorkspaceInfo(path, cached, true);
+    } else {
+        infoDisplay_->setText("Path: " + path + "\n\nCollecting workspace information...");
+        versionLabel_->setText("Current Version: ...");
+    }
+
+    // A newer selection or refresh supersedes this one
+    infoToken_.cancel();
+    std::string workspacePath = ws->getPath();
+    infoToken_ = TaskExecutor::instance().submit(TaskLane::Interactive,
+                                                 [this, workspacePath, cached = std::move(cached)](const CancellationToken& token) {
+        // A private instance: the GUI's Workspace is not shared across threads
+        Workspace workspace(workspacePath);
+        InfoSnapshot fresh;
+        if (!collectWorkspaceInfo(workspace, token, fresh)) {
+            return;
+        }
+        workspace.saveInfoSnapshot(fresh);
+
+        int changed = 0;
+        for (const auto& section : fresh.sections) {
+            auto previous = std::find_if(cached.sections.begin(), cached.sections.end(),
+                                         [&](const InfoSection& s) { return s.title == section.title; });
+            changed += previous == cached.sections.end() || previous->body != section.body;
+        }
+
+        QMetaObject::invokeMethod(this, [this, token, workspacePath, fresh, changed]() {
+            if (token.isCancelled()) return;
+            int scroll = infoDisplay_->verticalScrollBar()->value();
+            showWorkspaceInfo(QString::fromStdString(workspacePath), fresh, false);
+            infoDisplay_->verticalScrollBar()->setValue(scroll);
+            if (changed > 0) {
+                statusBar()->showMessage(QString("Workspace info updated: %1 section(s) changed").arg(changed), 3000);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::showWorkspaceInfo(const QString& path, const InfoSnapshot& snapshot, bool stale) {
+    QString info = "Path: " + path + "\n\n";
+    for (size_t i = 0; i < snapshot.sections.size(); ++i) {
+        const InfoSection& section = snapshot.sections[i];
+        info += "=== " + QString::fromStdString(section.title) + " ===";
+        if (stale) {
+            info += " (cached, refreshing...)";
+        }
+        info += "\n" + QString::fromStdString(section.body);
+        if (i + 1 < snapshot.sections.size()) {
+            info += "\n";
+        }
+    }
+    infoDisplay_->setText(info);
+    versionLabel_->setText("Current Version: " + QString::fromStdString(snapshot.version));
+}
+
+bool MainWindow::collectWorkspaceInfo(Workspace& ws, const CancellationToken& token, InfoSnapshot& snapshot) {
+    TRACE_SCOPE("MainWindow::collectWorkspaceInfo", "scan", ws.getPath());
+    snapshot = InfoSnapshot();
+    // Each section ends with a cancellation check
+    auto addSection = [&snapshot, &token](const char* title, const QString& body) {
+        snapshot.sections.push_back(InfoSection{title, body.toStdString()});
+        return !token.isCancelled();
+    };
+
+    // Everything derived from the root listing comes from one directory read
+    WorkspaceProfile profile = ws.getProfile();
 
     // Build System Information
-    info += "=== Build System ===\n";
-    info += "Type: " + QString::fromStdString(ws->getBuildSystemName()) + "\n";
-    info += "Build Directory: " + QString::fromStdString(ws->getBuildDirectory()) + "\n";
-    info += "Build Command: " + QString::fromStdString(ws->getPreferredBuildCommand()) + "\n";
+    QString info;
+    info += "Type: " + QString::fromStdString(ws.getBuildSystemName()) + "\n";
+    info += "Configuration: " + QString::fromStdString(ws.getActiveConfiguration().name) + "\n";
+    info += "Build Directory: " + QString::fromStdString(ws.getBuildDirectory()) + "\n";
+    info += "Build Command: " + QString::fromStdString(ws.getPreferredBuildCommand()) + "\n";
     
-    auto buildScripts = ws->getBuildScripts();
+    const auto& buildScripts = profile.buildScripts;
     if (!buildScripts.empty()) {
         info += "Build Scripts: ";
         for (size_t i = 0; i < buildScripts.size(); ++i) {
@@ -664,11 +1468,11 @@ void MainWindow::displayWorkspaceInfo(Workspace* ws) {
         }
         info += "\n";
     }
-    info += "\n";
+    if (!addSection("Build System", info)) return false;
 
     // Executable Information
-    info += "=== Executables ===\n";
-    auto executables = ws->findExecutables();
+    info.clear();
+    auto executables = ws.findExecutables();
     if (executables.empty()) {
         info += "No executables found\n";
     } else {
@@ -680,20 +1484,36 @@ void MainWindow::displayWorkspaceInfo(Workspace* ws) {
                    .arg(exe.isGUI ? " [GUI]" : "");
         }
         
-        auto mainExe = ws->findMainExecutable();
+        auto mainExe = ws.findMainExecutable();
         if (!mainExe.name.empty()) {
             info += QString("Main: %1\n").arg(QString::fromStdString(mainExe.name));
         }
     }
-    info += "\n";
+    if (!addSection("Executables", info)) return false;
+
+    // Source Statistics
+    info.clear();
+    SourceStatsResult stats = ws.getSourceStats();
+    if (stats.files == 0) {
+        info += "No source files found\n";
+    } else {
+        QLocale locale;
+        info += QString("%1 files, %2 lines, %3 KB\n")
+                .arg(locale.toString(static_cast<qulonglong>(stats.files)))
+                .arg(locale.toString(static_cast<qulonglong>(stats.lines)))
+                .arg(locale.toString(static_cast<qulonglong>(stats.bytes / 1024)));
+        for (const auto& language : stats.languages) {
+            info += QString("- %1: %2 files, %3 lines\n")
+                    .arg(QString::fromStdString(language.language))
+                    .arg(locale.toString(static_cast<qulonglong>(language.files)))
+                    .arg(locale.toString(static_cast<qulonglong>(language.lines)));
+        }
+    }
+    if (!addSection("Source Statistics", info)) return false;
 
     // Git Information
-    info += "=== Git Information ===\n";
-    std::string cmd = "git remote -v";
-    std::string cwd = std::filesystem::current_path().string();
-    std::filesystem::current_path(ws->getPath());
-    std::string result = ws->runCommand(cmd);
-    std::filesystem::current_path(cwd);
+    info.clear();
+    std::string result = ws.runInWorkspace("git remote -v");
     
     if (!result.empty() && result.find("fatal") == std::string::npos) {
         QString remoteUrl = QString::fromStdString(result).split('\n')[0];
@@ -704,25 +1524,21 @@ void MainWindow::displayWorkspaceInfo(Workspace* ws) {
         info += "Remote URL: Not a git repository\n";
     }
 
-    // Git tags
-    cmd = "git describe --tags --abbrev=0";
-    cwd = std::filesystem::current_path().string();
-    std::filesystem::current_path(ws->getPath());
-    result = ws->runCommand(cmd);
-    std::filesystem::current_path(cwd);
-    
-    if (!result.empty() && result.find("fatal") == std::string::npos) {
-        info += "Latest Tag: " + QString::fromStdString(result).trimmed() + "\n";
+    // Version tags; the highest one is also the current version
+    const TagIndex& tags = ws.getTagIndex();
+    snapshot.version = ws.getCurrentVersion();
+    if (const SemVer* latest = tags.latest()) {
+        info += QString("Latest Tag: %1 (%2 version tags)\n")
+                .arg(QString::fromStdString(latest->tag)).arg(tags.versions().size());
+        if (latest->isPreRelease() && tags.latestRelease()) {
+            info += "Latest Release: " + QString::fromStdString(tags.latestRelease()->tag) + "\n";
+        }
     } else {
         info += "Latest Tag: None\n";
     }
 
     // Git status
-    cmd = "git status --porcelain";
-    cwd = std::filesystem::current_path().string();
-    std::filesystem::current_path(ws->getPath());
-    result = ws->runCommand(cmd);
-    std::filesystem::current_path(cwd);
+    result = ws.runInWorkspace("git status --porcelain");
     QStringList fileStatus = QString::fromStdString(result).split('\n', Qt::SkipEmptyParts);
     
     if (fileStatus.isEmpty()) {
@@ -730,43 +1546,26 @@ void MainWindow::displayWorkspaceInfo(Workspace* ws) {
     } else {
         info += QString("Status: %1 changed file(s)\n").arg(fileStatus.size());
     }
-    info += "\n";
+    if (!addSection("Git Information", info)) return false;
 
     // Project Structure
-    info += "=== Project Structure ===\n";
+    info.clear();
     
     // Actions scripts (GitHub actions)
-    std::filesystem::path actionsPath = std::filesystem::path(ws->getPath()) / ".github" / "workflows";
-    if (std::filesystem::exists(actionsPath)) {
-        info += "GitHub Actions: Available\n";
-    } else {
-        info += "GitHub Actions: None\n";
-    }
+    info += profile.hasWorkflows ? "GitHub Actions: Available\n" : "GitHub Actions: None\n";
 
     // Scripts directory
-    std::filesystem::path scriptsPath = std::filesystem::path(ws->getPath()) / "scripts";
-    if (std::filesystem::exists(scriptsPath)) {
-        info += "Scripts Directory: Available\n";
-    } else {
-        info += "Scripts Directory: None\n";
-    }
+    info += profile.hasScriptsDirectory ? "Scripts Directory: Available\n" : "Scripts Directory: None\n";
 
     // Documentation
-    std::filesystem::path docsPath = std::filesystem::path(ws->getPath()) / "docs";
-    std::filesystem::path readmePath = std::filesystem::path(ws->getPath()) / "README.md";
-    if (std::filesystem::exists(docsPath)) {
+    if (profile.hasDocsDirectory) {
         info += "Documentation: docs/ directory\n";
-    } else if (std::filesystem::exists(readmePath)) {
+    } else if (profile.hasReadme) {
         info += "Documentation: README.md\n";
     } else {
         info += "Documentation: None\n";
     }
-
-    infoDisplay_->setText(info);
-    
-    // Update version label
-    QString version = getCurrentVersion(ws);
-    versionLabel_->setText("Current Version: " + version);
+    return addSection("Project Structure", info);
 }
 
 void MainWindow::updateActionButtons() {
@@ -777,6 +1576,10 @@ void MainWindow::updateActionButtons() {
     cleanButton_->setEnabled(hasWorkspace);
     runButton_->setEnabled(hasWorkspace);
     removeButton_->setEnabled(hasWorkspaceInList);
+    configurationCombo_->setEnabled(hasWorkspace);
+    newConfigurationButton_->setEnabled(hasWorkspace);
+    targetCombo_->setEnabled(hasWorkspace);
+    compileFileButton_->setEnabled(hasWorkspace);
 
     majorButton_->setEnabled(hasWorkspace);
     minorButton_->setEnabled(hasWorkspace);
@@ -795,69 +1598,73 @@ void MainWindow::updateActionButtons() {
 }
 
 QString MainWindow::getCurrentVersion(Workspace* ws) {
+    TRACE_SCOPE("MainWindow::getCurrentVersion", "git");
     if (!ws) return "N/A";
-    
-    std::string cmd = "git describe --tags --abbrev=0";
-    std::string cwd = std::filesystem::current_path().string();
-    std::filesystem::current_path(ws->getPath());
-    std::string result = ws->runCommand(cmd);
-    std::filesystem::current_path(cwd);
-    
-    if (result.empty() || result.find("fatal") != std::string::npos) {
-        return "0.0.0";
-    }
-    
-    QString version = QString::fromStdString(result).trimmed();
-    if (version.startsWith("v")) {
-        version = version.mid(1);
-    }
-    return version;
+    // The highest version tag, not the nearest one git describe would find
+    return QString::fromStdString(ws->getCurrentVersion());
 }
 
 QString MainWindow::incrementVersion(const QString& version, int type) {
-    QStringList parts = version.split('.');
-    if (parts.size() != 3) {
+    SemVer current;
+    if (!SemVer::parse(version.toStdString(), current)) {
         return "1.0.0";
     }
-    
-    int major = parts[0].toInt();
-    int minor = parts[1].toInt();
-    int patch = parts[2].toInt();
-    
-    switch(type) {
-        case 2: // Major
-            major++;
-            minor = 0;
-            patch = 0;
-            break;
-        case 1: // Minor
-            minor++;
-            patch = 0;
-            break;
-        case 0: // Patch
-        default:
-            patch++;
-            break;
-    }
-    
-    return QString("%1.%2.%3").arg(major).arg(minor).arg(patch);
+    return QString::fromStdString(current.bumped(type).toString());
 }
 
 // Build management actions
 void MainWindow::buildWorkspace() {
+    startBuild(false);
+}
+
+void MainWindow::profileCompile() {
+    startBuild(true);
+}
+
+// The workspace's launcher shim, or cppm itself in trees configured before the shim
+static bool configuredWithLauncher(const QString& buildDir) {
+    QFile cache(buildDir + "/CMakeCache.txt");
+    return cache.open(QIODevice::ReadOnly) && cache.readAll().contains("compile-launcher");
+}
+
+// cppm-launcher next to cppm; cppm itself takes --compile-launcher too, only slower to start
+static QString compileLauncherPath() {
+    QString launcher = QCoreApplication::applicationDirPath() + "/cppm-launcher";
+    return QFileInfo(launcher).isExecutable() ? launcher : QCoreApplication::applicationFilePath();
+}
+
+void MainWindow::startBuild(bool profile, bool automatic) {
+    TRACE_SCOPE("MainWindow::startBuild", "build");
     if (!currentWorkspace_) return;
 
-    if (buildProcess_ && buildProcess_->state() == QProcess::Running) {
-        QMessageBox::warning(this, "Build in Progress", "Another build is already running.");
-        return;
+    // Only the compile launcher can add -ftime-trace without reconfiguring
+    if (profile) {
+        QString profiledDir = QString::fromStdString(currentWorkspace_->getBuildDirectory());
+        if (currentWorkspace_->detectBuildSystem() != BuildSystem::CMake) {
+            QMessageBox::information(this, "Profile Compile", "Compile profiles need a CMake workspace built with Clang.");
+            return;
+        }
+        if (QFile::exists(profiledDir + "/CMakeCache.txt") && !configuredWithLauncher(profiledDir)) {
+            QMessageBox::information(this, "Profile Compile",
+                                     "This build tree was configured without the cppm compile launcher. "
+                                     "Clean the workspace so that the next build reconfigures it, then profile again.");
+            return;
+        }
     }
 
-    buildOutput_->clear();
+    // Configurations build into trees of their own and may build side by side
+    QString buildDir = QString::fromStdString(currentWorkspace_->getBuildDirectory());
+    if (supervisor_->isRunning(currentWorkspaceName_, "build", buildDir)) {
+        QMessageBox::warning(this, "Build in Progress", "A build of this configuration is already running.");
+        return;
+    }
+    if (!supervisor_->isRunning(currentWorkspaceName_, "build")) {
+        buildOutput_->clear();
+    }
     
     // Get build system information
     QString buildSystemName = QString::fromStdString(currentWorkspace_->getBuildSystemName());
     QString buildCommand = QString::fromStdString(currentWorkspace_->getPreferredBuildCommand());
-    QString buildDir = QString::fromStdString(currentWorkspace_->getBuildDirectory());
     QString workspacePath = QString::fromStdString(currentWorkspace_->getPath());
     
     buildOutput_->append(QString("Starting build for workspace: %1\n").arg(workspacePath));
@@ -865,6 +1672,135 @@ void MainWindow::buildWorkspace() {
     buildOutput_->append(QString("Build Directory: %1\n").arg(buildDir));
     buildOutput_->append(QString("Build Command: %1\n\n").arg(buildCommand));
 
+    BuildRequest request;
+    request.workspace = currentWorkspaceName_;
+    request.buildDir = buildDir;
+    request.target = targetCombo_->currentIndex() > 0 ? targetCombo_->currentText() : QString();
+    request.recordDigest = request.target.isEmpty();
+    request.configuration = currentWorkspace_->getActiveConfiguration().name;
+    request.generator = buildSystemCombo_->currentText().toStdString();
+    request.compileMemoryLog = QString::fromStdString(currentWorkspace_->compileMemoryLog());
+    request.profile = profile;
+    request.automatic = automatic;
+
+    // Hashing a large tree takes a while, even with most hashes cached; a
+    // private instance, as the GUI's Workspace is not shared across threads
+    std::string path = currentWorkspace_->getPath();
+    TaskExecutor::instance().submit(TaskLane::Interactive, [this, path, request](const CancellationToken& token) {
+        if (token.isCancelled()) return;
+        Workspace workspace(path);
+        TreeDigest digest = workspace.computeSourceDigest();
+        // Nothing to do if neither a file nor a build setting changed since
+        // the last successful build; a profile compiles everything regardless
+        bool upToDate = !request.profile &&
+                        workspace.isBuildUpToDate(workspace.buildKey(request.configuration, digest.digest, request.generator));
+        QMetaObject::invokeMethod(this, [this, request, digest, upToDate]() {
+            onSourceDigest(request, digest, upToDate);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::onSourceDigest(BuildRequest request, const TreeDigest& digest, bool upToDate) {
+    TRACE_SCOPE("MainWindow::onSourceDigest", "build");
+    Workspace *ws = wm_.getWorkspace(request.workspace.toStdString());
+    if (!ws) return;
+    if (upToDate) {
+        buildOutput_->append(QString("Up to date: none of %1 files and no build setting changed since the last "
+                                     "successful build (checked in %2 ms). Clean to force a rebuild.\n")
+                             .arg(digest.files)
+                             .arg(digest.seconds * 1000.0, 0, 'f', 0));
+        return;
+    }
+    // Another Build may have started while the sources were hashed
+    const QString& buildDir = request.buildDir;
+    if (supervisor_->isRunning(request.workspace, "build", buildDir)) {
+        if (!request.automatic) {
+            QMessageBox::warning(this, "Build in Progress", "A build of this configuration is already running.");
+        } else if (request.workspace == watchedWorkspace_) {
+            // Its saves may be newer than what that build read; rebuild once it is over
+            watchOverflowed_ = true;
+            watchRestart_ = true;
+        }
+        return;
+    }
+    bool buildingAlongside = supervisor_->isRunning(request.workspace, "build");
+    bool profile = request.profile;
+    bool automatic = request.automatic;
+    QString buildCommand = QString::fromStdString(ws->getPreferredBuildCommand());
+    QString workspacePath = QString::fromStdString(ws->getPath());
+    request.digest = digest.digest;
+    request.profileSinceNs = QDateTime::currentMSecsSinceEpoch() * 1000000;
+    // Autotuning and the compile launcher record into .cppm
+    ws->prepareStateDirectory();
+    const QString& target = request.target;
+
+    // As many compiles as fit into memory, going by what they took last time,
+    // and no more than autotuning found to pay off
+    JobsChoice jobs = ws->chooseBuildJobs();
+    ParallelismTuner tuner(ws->parallelismFile());
+    tuner.load();
+    // A candidate memory does not allow now would never get its trials
+    if (tuner.isTuning() && tuner.skipCandidatesAbove(jobs.jobs)) {
+        tuner.save();
+        buildOutput_->append(QString("Autotune: skipping job counts above %1, which do not fit into memory\n")
+                             .arg(jobs.jobs));
+        if (!tuner.isTuning()) {
+            buildOutput_->append(QString("Autotune finished: building '%1' with %2 jobs from now on\n")
+                                 .arg(request.workspace).arg(tuner.tunedJobs()));
+        }
+    }
+    request.jobs = tuner.nextJobs(jobs.jobs);
+    // A build sharing the cores with another one says nothing about -j
+    request.trial = !profile && !buildingAlongside && tuner.isTuning() && tuner.isTrial(request.jobs);
+    if (jobs.perJobKb > 0) {
+        buildOutput_->append(QString("Memory allows %1 of %2 cores (%3 MB available, ~%4 MB per compile over %5 sources)\n")
+                             .arg(jobs.jobs).arg(jobs.cores)
+                             .arg(jobs.availableKb / 1024).arg(jobs.perJobKb / 1024).arg(jobs.sources));
+    }
+
+    // Distributed mode: compiles run on the distcc or icecream hosts, so -j
+    // follows their slots rather than the local cores and memory
+    DistributedSettings distributed;
+    distributed.loadFromFile(ws->distributedSettingsFile());
+    if (distributed.enabled && profile) {
+        buildOutput_->append("Profiling compiles locally: remote compiles leave no trace here.\n");
+    } else if (distributed.enabled) {
+        DistributedPlan plan = DistributedCompile::plan(distributed);
+        BuildSystem system = ws->detectBuildSystem();
+        bool launched = system != BuildSystem::CMake || !QFile::exists(buildDir + "/CMakeCache.txt") ||
+                        configuredWithLauncher(buildDir);
+        if (!plan.available) {
+            buildOutput_->append(QString("Distributed build unavailable: %1. Compiling locally.\n")
+                                 .arg(QString::fromStdString(plan.error)));
+        } else if (system == BuildSystem::Ninja || system == BuildSystem::Script) {
+            buildOutput_->append("Distributed builds need a CMake or Make workspace. Compiling locally.\n");
+        } else if (!launched) {
+            buildOutput_->append("This build tree was configured without the cppm compile launcher; "
+                                 "clean the workspace to reconfigure it for distributed builds. Compiling locally.\n");
+        } else {
+            request.distributedTool = QString::fromStdString(plan.tool);
+            request.jobs = qMax(request.jobs, plan.jobSlots);
+            request.trial = false;
+            QStringList hosts;
+            for (const auto& host : plan.hosts) {
+                hosts << QString("%1/%2").arg(QString::fromStdString(host.name)).arg(host.jobSlots);
+            }
+            buildOutput_->append(QString("Distributed build through %1: %2 slots%3\n")
+                                 .arg(QString::fromStdString(plan.backend)).arg(plan.jobSlots)
+                                 .arg(hosts.isEmpty() ? QString() : " on " + hosts.join(" ")));
+        }
+    }
+
+    if (!request.distributedTool.isEmpty()) {
+        buildOutput_->append(QString("Parallel jobs: %1 (distributed)\n").arg(request.jobs));
+    } else if (request.trial) {
+        buildOutput_->append(QString("Parallel jobs: %1 (autotune trial)\n").arg(request.jobs));
+    } else if (tuner.tunedJobs() > 0) {
+        buildOutput_->append(QString("Parallel jobs: %1 (tuned for this workspace)\n").arg(request.jobs));
+    } else {
+        buildOutput_->append(QString("Parallel jobs: %1\n").arg(request.jobs));
+    }
+
     buildProgress_->setValue(0);
     buildProgress_->setVisible(true);
 
@@ -880,9 +1816,6 @@ void MainWindow::buildWorkspace() {
         }
     }
 
-    // Set up the build process
-    buildProcess_ = new QProcess(this);
-    
     // Parse the build command
     QStringList commandParts = buildCommand.split(' ', Qt::SkipEmptyParts);
     if (commandParts.isEmpty()) {
@@ -895,62 +1828,163 @@ void MainWindow::buildWorkspace() {
     QStringList arguments = commandParts.mid(1);
     
     // Handle special cases for different build systems
-    BuildSystem buildSystem = currentWorkspace_->detectBuildSystem();
-    QString selectedBuildSystem = buildSystemCombo_->currentText();
+    BuildSystem buildSystem = ws->detectBuildSystem();
+    QString selectedBuildSystem = QString::fromStdString(request.generator);
+    QString workingDirectory = buildDir;
     
     if (buildSystem == BuildSystem::CMake) {
-        // For CMake projects, check if we need to configure first
-        if (!QFile::exists(buildDir + "/CMakeCache.txt")) {
+        // Configure when there is no cache yet, or once more so that a tree
+        // configured before the File API query existed gets a reply
+        ws->prepareConfigure();
+        // A configured tree runs the shim for every compile; it is written
+        // again should it have gone missing since
+        std::string shim = ws->compileLauncherShim();
+        if (!QFile::exists(buildDir + "/CMakeCache.txt") || !CMakeFileApi(buildDir.toStdString()).hasReply()) {
             buildOutput_->append("Running CMake configuration...\n");
-            buildProcess_->setWorkingDirectory(buildDir);
+            ProcessJob *job = supervisor_->create(request.workspace, "build", "cmake configure " + buildDir);
+            job->setScope(buildDir);
+            if (automatic) {
+                watchJobs_.insert(job->id());
+            }
+            job->process()->setWorkingDirectory(buildDir);
             
-            connect(buildProcess_, &QProcess::readyReadStandardOutput, this, &MainWindow::onBuildOutput);
-            connect(buildProcess_, &QProcess::readyReadStandardError, this, &MainWindow::onBuildOutput);
-            connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                    this, &MainWindow::onCmakeFinished);
+            connect(job, &ProcessJob::output, this, &MainWindow::onBuildOutput);
+            connect(job, &ProcessJob::finished, this, [this, request, job](int exitCode, QProcess::ExitStatus exitStatus) {
+                onCmakeFinished(request, job, exitCode, exitStatus);
+            });
             
-            // Configure CMake with selected generator
+            // Configure the active configuration with the selected generator
             QStringList cmakeArgs;
-            cmakeArgs << "..";
+            // The launcher records each compile's peak memory and holds compiles back under
+            // memory pressure; the tree only names the workspace's shim, and builds pass the launcher
+            std::vector<std::string> launcher;
+            if (!shim.empty()) {
+                launcher.push_back(shim);
+            }
+            // The configuration hashed, should the selection have moved on since
+            BuildConfiguration configuration = ws->getActiveConfiguration();
+            for (const auto& candidate : ws->getConfigurations()) {
+                if (candidate.name == request.configuration) {
+                    configuration = candidate;
+                }
+            }
+            for (const auto& arg : ws->getConfigureArguments(configuration, launcher)) {
+                cmakeArgs << QString::fromStdString(arg);
+            }
             if (selectedBuildSystem == "Ninja") {
                 cmakeArgs << "-G" << "Ninja";
             } else {
                 cmakeArgs << "-G" << "Unix Makefiles";
             }
+            if (cmakeArgs.contains("-C")) {
+                buildOutput_->append("Reusing configure checks cached for this toolchain\n");
+            }
             
-            buildProcess_->start("cmake", cmakeArgs);
+            instrumentProcess(job, "cmake configure", buildDir, "configure");
+            job->start("cmake", cmakeArgs);
             return;
         } else {
             // CMake already configured, use cmake --build with appropriate backend
-            buildProcess_->setWorkingDirectory(buildDir);
             program = "cmake";
             arguments = QStringList() << "--build" << ".";
             
-            // Add parallel jobs for the selected build system
-            if (selectedBuildSystem == "Ninja") {
-                arguments << "--parallel";
-            } else {
-                arguments << "--parallel" << QString::number(QThread::idealThreadCount());
+            // Ninja would otherwise pick its own job count, regardless of memory
+            arguments << "--parallel" << QString::number(request.jobs);
+            if (profile) {
+                arguments << "--clean-first";
+            }
+            if (!target.isEmpty()) {
+                arguments << "--target" << target;
             }
         }
     } else if (buildSystem == BuildSystem::Script) {
         // For build scripts, run from the project root
-        buildProcess_->setWorkingDirectory(workspacePath);
+        workingDirectory = workspacePath;
     } else {
-        // For Make, Ninja, etc., run from build directory
-        buildProcess_->setWorkingDirectory(buildDir);
+        // For Make, Ninja, etc., run from build directory; make is serial unless told otherwise
+        if (program == "make" || program == "ninja") {
+            arguments << "-j" << QString::number(request.jobs);
+        }
+        // There is no launcher in a plain Makefile; distcc's documented way in is CC
+        if (!request.distributedTool.isEmpty() && program == "make") {
+            arguments << "CC=" + request.distributedTool + " cc" << "CXX=" + request.distributedTool + " c++";
+        }
+        if (!target.isEmpty()) {
+            arguments << target;
+        }
     }
 
-    connect(buildProcess_, &QProcess::readyReadStandardOutput, this, &MainWindow::onBuildOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError, this, &MainWindow::onBuildOutput);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &MainWindow::onBuildFinished);
+    ProcessJob *job = supervisor_->create(request.workspace, "build", program + " " + arguments.join(" "));
+    if (automatic) {
+        watchJobs_.insert(job->id());
+    }
+    job->setScope(buildDir);
+    job->process()->setWorkingDirectory(workingDirectory);
+    connect(job, &ProcessJob::output, this, &MainWindow::onBuildOutput);
+    connect(job, &ProcessJob::finished, this, [this, request, job](int exitCode, QProcess::ExitStatus exitStatus) {
+        onBuildFinished(request, job, exitCode, exitStatus);
+    });
     
     buildOutput_->append(QString("Executing: %1 %2\n").arg(program, arguments.join(" ")));
-    buildProcess_->start(program, arguments);
+    setBuildEnvironment(job, request);
+    instrumentProcess(job, "build", program + " " + arguments.join(" "), "build");
+    job->start(program, arguments);
+}
+
+bool MainWindow::chooseRunTarget(const CMakeCodeModel& model, ExecutableInfo& chosen, const QString& verb) {
+    std::vector<const CMakeTarget*> executables;
+    for (const auto& target : model.targets) {
+        if (target.type == "EXECUTABLE" && !target.artifacts.empty()) {
+            executables.push_back(&target);
+        }
+    }
+    if (executables.empty()) {
+        QMessageBox::warning(this, "No Executable Targets",
+                             "The CMake project does not define any executable targets.");
+        return false;
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(verb + " Target");
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    layout->addWidget(new QLabel(QString("Executable targets of %1:")
+                                 .arg(QString::fromStdString(model.projectName)), &dialog));
+
+    QListWidget *targetList = new QListWidget(&dialog);
+    for (const CMakeTarget* target : executables) {
+        bool built = QFile::exists(QString::fromStdString(target->artifacts.front()));
+        QString text = QString::fromStdString(target->name);
+        if (target->linksGuiToolkit) text += " [GUI]";
+        if (!built) text += " (not built)";
+        QListWidgetItem *item = new QListWidgetItem(text, targetList);
+        item->setToolTip(QString::fromStdString(target->artifacts.front()));
+        if (target->name == model.projectName || targetList->count() == 1) {
+            targetList->setCurrentItem(item);
+        }
+    }
+    layout->addWidget(targetList);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    buttons->button(QDialogButtonBox::Ok)->setText(verb);
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    connect(targetList, &QListWidget::itemDoubleClicked, &dialog, &QDialog::accept);
+
+    if (dialog.exec() != QDialog::Accepted || targetList->currentRow() < 0) {
+        return false;
+    }
+
+    const CMakeTarget* target = executables[targetList->currentRow()];
+    chosen.name = target->name;
+    chosen.path = target->artifacts.front();
+    chosen.relativePath = target->artifacts.front();
+    chosen.isGUI = target->linksGuiToolkit;
+    return true;
 }
 
 void MainWindow::cleanWorkspace() {
+    TRACE_SCOPE("MainWindow::cleanWorkspace", "build");
     if (!currentWorkspace_) return;
     
     int ret = QMessageBox::question(this, "Clean Workspace", 
@@ -958,59 +1992,83 @@ void MainWindow::cleanWorkspace() {
                                    QMessageBox::Yes | QMessageBox::No);
     
     if (ret == QMessageBox::Yes) {
-        bool success = currentWorkspace_->clean();
+        QString workspaceName = currentWorkspaceName_;
+        std::string error;
+        bool success = currentWorkspace_->clean([this, workspaceName](const ReapResult& result) {
+            // Reported from a reaper thread; hand over to the GUI thread
+            QMetaObject::invokeMethod(this, [this, workspaceName, result]() {
+                QString message = QString("Reclaimed %1 MB (%2 files) from the old build directory of '%3' in %4 s")
+                                  .arg(result.bytesReclaimed / (1024.0 * 1024.0), 0, 'f', 1)
+                                  .arg(result.filesRemoved)
+                                  .arg(workspaceName)
+                                  .arg(result.seconds, 0, 'f', 1);
+                if (result.errors > 0) {
+                    message += QString(" (%1 entries could not be removed)").arg(result.errors);
+                }
+                buildOutput_->append(message);
+            }, Qt::QueuedConnection);
+        }, &error);
         if (success) {
+            buildOutput_->append("Build directory moved to trash, deleting it in the background...");
             QMessageBox::information(this, "Clean Complete", "Build directory cleaned successfully!");
         } else {
-            QMessageBox::warning(this, "Clean Failed", "Failed to clean build directory.");
+            QMessageBox::warning(this, "Clean Failed",
+                                 QString("The build directory was left as it is: %1.").arg(QString::fromStdString(error)));
         }
     }
 }
 
 void MainWindow::runWorkspace() {
+    TRACE_SCOPE("MainWindow::runWorkspace", "build");
     if (!currentWorkspace_) return;
 
-    // Find executables in the workspace
-    auto executables = currentWorkspace_->findExecutables();
-    
-    if (executables.empty()) {
-        QMessageBox::warning(this, "No Executable Found", 
-                           "No executable files found in the workspace.\n"
-                           "Make sure the project has been built successfully.");
-        return;
-    }
-
     ExecutableInfo execToRun;
-    
-    if (executables.size() == 1) {
-        // Only one executable, use it
-        execToRun = executables[0];
+
+    CMakeCodeModel model;
+    if (currentWorkspace_->getCodeModel(model)) {
+        // CMake reported its targets: pick one of them
+        if (!chooseRunTarget(model, execToRun)) return;
     } else {
-        // Multiple executables, try to find the main one
-        execToRun = currentWorkspace_->findMainExecutable();
+        // Find executables in the workspace
+        auto executables = currentWorkspace_->findExecutables();
+    
+        if (executables.empty()) {
+            QMessageBox::warning(this, "No Executable Found", 
+                               "No executable files found in the workspace.\n"
+                               "Make sure the project has been built successfully.");
+            return;
+        }
+
+        if (executables.size() == 1) {
+            // Only one executable, use it
+            execToRun = executables[0];
+        } else {
+            // Multiple executables, try to find the main one
+            execToRun = currentWorkspace_->findMainExecutable();
         
-        if (execToRun.name.empty()) {
-            // Ask user to choose
-            QStringList execNames;
-            for (const auto& exe : executables) {
-                execNames << QString("%1 (%2)%3")
-                            .arg(QString::fromStdString(exe.name))
-                            .arg(QString::fromStdString(exe.relativePath))
-                            .arg(exe.isGUI ? " [GUI]" : "");
-            }
+            if (execToRun.name.empty()) {
+                // Ask user to choose
+                QStringList execNames;
+                for (const auto& exe : executables) {
+                    execNames << QString("%1 (%2)%3")
+                                .arg(QString::fromStdString(exe.name))
+                                .arg(QString::fromStdString(exe.relativePath))
+                                .arg(exe.isGUI ? " [GUI]" : "");
+                }
             
-            bool ok;
-            QString selected = QInputDialog::getItem(this, "Select Executable", 
-                                                   "Multiple executables found. Select one to run:",
-                                                   execNames, 0, false, &ok);
+                bool ok;
+                QString selected = QInputDialog::getItem(this, "Select Executable", 
+                                                       "Multiple executables found. Select one to run:",
+                                                       execNames, 0, false, &ok);
             
-            if (!ok) return;
+                if (!ok) return;
             
-            int index = execNames.indexOf(selected);
-            if (index >= 0 && index < executables.size()) {
-                execToRun = executables[index];
-            } else {
-                return;
+                int index = execNames.indexOf(selected);
+                if (index >= 0 && index < executables.size()) {
+                    execToRun = executables[index];
+                } else {
+                    return;
+                }
             }
         }
     }
@@ -1048,10 +2106,6 @@ void MainWindow::runWorkspace() {
     buildOutput_->append(QString("Type: %1\n\n").arg(execToRun.isGUI ? "GUI Application" : "Console Application"));
 
     // Start the process
-    QProcess* runProcess = new QProcess(this);
-    runProcess->setWorkingDirectory(workingDir);
-    runProcess->setEnvironment(environment);
-    
     if (execToRun.isGUI) {
         // For GUI applications, start detached so they don't block
         if (QProcess::startDetached(exePath, QStringList(), workingDir, nullptr)) {
@@ -1062,240 +2116,1138 @@ void MainWindow::runWorkspace() {
             buildOutput_->append("Failed to start application!\n");
             QMessageBox::warning(this, "Launch Failed", "Failed to start the application.");
         }
-        runProcess->deleteLater();
     } else {
         // For console applications, run and show output
-        connect(runProcess, &QProcess::readyReadStandardOutput, [this, runProcess]() {
-            buildOutput_->append(runProcess->readAllStandardOutput());
+        ProcessJob *job = supervisor_->create(currentWorkspaceName_, "run", exePath);
+        job->process()->setWorkingDirectory(workingDir);
+        job->process()->setEnvironment(environment);
+
+        connect(job, &ProcessJob::output, this, [this, job](const QString& text, bool) {
+            if (showsOutputOf(job)) {
+                buildOutput_->append(text);
+            }
         });
         
-        connect(runProcess, &QProcess::readyReadStandardError, [this, runProcess]() {
-            buildOutput_->append(runProcess->readAllStandardError());
+        connect(job, &ProcessJob::finished, this, [this, job](int exitCode, QProcess::ExitStatus) {
+            if (showsOutputOf(job)) {
+                buildOutput_->append(QString("\nApplication finished with exit code %1\n").arg(exitCode));
+            }
+            recordRun(job);
         });
         
-        connect(runProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                [this, runProcess](int exitCode, QProcess::ExitStatus exitStatus) {
-                    buildOutput_->append(QString("\nApplication finished with exit code %1\n").arg(exitCode));
-                    runProcess->deleteLater();
-                });
-        
         buildOutput_->append("Starting console application...\n");
-        runProcess->start(exePath, QStringList());
-        
-        if (!runProcess->waitForStarted(3000)) {
-            buildOutput_->append("Failed to start application!\n");
-            QMessageBox::warning(this, "Launch Failed", "Failed to start the application.");
-            runProcess->deleteLater();
+        instrumentProcess(job, "run", exePath);
+        job->start(exePath, QStringList());
+    }
+}
+
+// Git versioning actions
+void MainWindow::gitMajorVersion() {
+    TRACE_SCOPE("MainWindow::gitMajorVersion", "git");
+    if (!currentWorkspace_) return;
+    
+    QString currentVer = getCurrentVersion(currentWorkspace_);
+    QString newVer = incrementVersion(currentVer, 2);
+    
+    int ret = QMessageBox::question(this, "Create Major Version", 
+                                   QString("Create new major version tag?\n%1 -> %2").arg(currentVer, newVer),
+                                   QMessageBox::Yes | QMessageBox::No);
+    
+    if (ret == QMessageBox::Yes) {
+        createVersionTag(newVer);
+    }
+}
+
+void MainWindow::gitMinorVersion() {
+    TRACE_SCOPE("MainWindow::gitMinorVersion", "git");
+    if (!currentWorkspace_) return;
+    
+    QString currentVer = getCurrentVersion(currentWorkspace_);
+    QString newVer = incrementVersion(currentVer, 1);
+    
+    int ret = QMessageBox::question(this, "Create Minor Version", 
+                                   QString("Create new minor version tag?\n%1 -> %2").arg(currentVer, newVer),
+                                   QMessageBox::Yes | QMessageBox::No);
+    
+    if (ret == QMessageBox::Yes) {
+        createVersionTag(newVer);
+    }
+}
+
+void MainWindow::gitPatchVersion() {
+    TRACE_SCOPE("MainWindow::gitPatchVersion", "git");
+    if (!currentWorkspace_) return;
+    
+    QString currentVer = getCurrentVersion(currentWorkspace_);
+    QString newVer = incrementVersion(currentVer, 0);
+    
+    int ret = QMessageBox::question(this, "Create Patch Version", 
+                                   QString("Create new patch version tag?\n%1 -> %2").arg(currentVer, newVer),
+                                   QMessageBox::Yes | QMessageBox::No);
+    
+    if (ret == QMessageBox::Yes) {
+        createVersionTag(newVer);
+    }
+}
+
+void MainWindow::createVersionTag(const QString& version) {
+    TRACE_SCOPE("MainWindow::createVersionTag", "git");
+    if (!currentWorkspace_) return;
+    if (supervisor_->isRunning(currentWorkspaceName_, "git")) {
+        QMessageBox::warning(this, "Git Busy", "A git operation of this workspace is still running.");
+        return;
+    }
+
+    GitPipeline *pipeline = new GitPipeline(supervisor_, currentWorkspaceName_,
+                                            QString::fromStdString(currentWorkspace_->getPath()), this);
+    // Annotated tag
+    pipeline->addStage("tag v" + version, QStringList() << "tag" << "-a" << "v" + version << "-m" << "Version " + version);
+    QString workspace = currentWorkspaceName_;
+    runGitPipeline(pipeline, "Tag v" + version, [this, workspace, version]() {
+        if (Workspace *tagged = wm_.getWorkspace(workspace.toStdString())) {
+            tagged->addTag("v" + version.toStdString());
+        }
+        if (currentWorkspaceName_ == workspace) {
+            versionLabel_->setText("Current Version: " + version);
+        }
+    });
+}
+
+bool MainWindow::chooseRemotes(const QString& title, const QString& branch, QStringList& remotes) {
+    std::vector<std::string> configured = currentWorkspace_->getGitRemotes();
+    if (configured.empty()) {
+        QMessageBox::warning(this, title, "This repository has no remote to push to.");
+        return false;
+    }
+    if (configured.size() == 1) {
+        QString remote = QString::fromStdString(configured.front());
+        int ret = QMessageBox::question(this, title, QString("Push branch %1 with tags to %2?").arg(branch, remote),
+                                        QMessageBox::Yes | QMessageBox::No);
+        if (ret != QMessageBox::Yes) return false;
+        remotes = QStringList() << remote;
+        return true;
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(title);
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    layout->addWidget(new QLabel(QString("Push branch %1 with tags to:").arg(branch), &dialog));
+    bool hasOrigin = std::find(configured.begin(), configured.end(), "origin") != configured.end();
+    QList<QCheckBox*> checks;
+    for (const auto& remote : configured) {
+        QCheckBox *check = new QCheckBox(QString::fromStdString(remote), &dialog);
+        check->setChecked(hasOrigin ? remote == "origin" : checks.isEmpty());
+        layout->addWidget(check);
+        checks << check;
+    }
+    layout->addWidget(new QLabel("Pushes to several remotes run at the same time.", &dialog));
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    buttons->button(QDialogButtonBox::Ok)->setText("Push");
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    for (QCheckBox *check : checks) {
+        if (check->isChecked()) {
+            remotes << check->text();
+        }
+    }
+    return !remotes.isEmpty();
+}
+
+static void addPushSteps(GitPipeline* pipeline, const QString& branch, const QStringList& remotes) {
+    for (int i = 0; i < remotes.size(); ++i) {
+        const QString& remote = remotes[i];
+        // git only reports progress to a terminal unless asked to
+        QStringList arguments = QStringList() << "push" << "--progress" << remote << branch << "--tags";
+        if (i == 0) {
+            pipeline->addStage("push " + remote, arguments, QString(), true);
+        } else {
+            pipeline->addParallelStep("push " + remote, arguments, true);
+        }
+    }
+}
+
+void MainWindow::runGitPipeline(GitPipeline* pipeline, const QString& title, std::function<void()> onSuccess) {
+    QString workspace = pipeline->workspace();
+    buildOutput_->append(QString("\n=== %1 (%2) ===\n").arg(title, workspace));
+
+    connect(pipeline, &GitPipeline::stepStarted, this, [this](ProcessJob* job, const QString& step, bool remote) {
+        // Pushes wait on the network; only local calls feed the git histogram
+        instrumentProcess(job, "git", "git " + step, remote ? nullptr : "git");
+    });
+    connect(pipeline, &GitPipeline::output, this, [this, workspace](const QString& step, const QString& text) {
+        if (workspace == currentWorkspaceName_) {
+            buildOutput_->append(QString("[%1] %2").arg(step, text));
+        }
+    });
+    connect(pipeline, &GitPipeline::progress, this, [this](const QString& step, const QString& text) {
+        statusBar()->showMessage(QString("%1: %2").arg(step, text), 3000);
+    });
+    connect(pipeline, &GitPipeline::stepFinished, this, [this, workspace](const GitStepResult& result) {
+        if (workspace == currentWorkspaceName_ && !result.skipped) {
+            buildOutput_->append(QString("[%1] %2 after %3 s\n").arg(result.name, result.ok ? "done" : "FAILED")
+                                 .arg(result.elapsedMs / 1000.0, 0, 'f', 1));
+        }
+    });
+    connect(pipeline, &GitPipeline::finished, this, [this, pipeline, title, workspace, onSuccess](bool ok) {
+        // Every step, so a partial failure shows what did and did not happen
+        QStringList report;
+        for (const GitStepResult& result : pipeline->results()) {
+            QString state = result.skipped ? QString("skipped") : result.ok ? QString("ok") : QString("FAILED");
+            QString line = QString("%1: %2").arg(result.name, state);
+            if (!result.skipped && !result.message.isEmpty()) {
+                line += " - " + result.message;
+            }
+            report << line;
+        }
+        statusBar()->clearMessage();
+        if (ok) {
+            if (onSuccess) onSuccess();
+            if (workspace == currentWorkspaceName_) refreshWorkspace();
+            QMessageBox::information(this, title, QString("%1 of '%2' completed.\n\n%3")
+                                     .arg(title, workspace, report.join("\n")));
+        } else {
+            QMessageBox::warning(this, title + " Failed", QString("%1 of '%2' did not complete.\n\n%3")
+                                 .arg(title, workspace, report.join("\n")));
         }
+        pipeline->deleteLater();
+    });
+    pipeline->start();
+}
+
+void MainWindow::gitPush() {
+    TRACE_SCOPE("MainWindow::gitPush", "git");
+    if (!currentWorkspace_) return;
+    if (supervisor_->isRunning(currentWorkspaceName_, "git")) {
+        QMessageBox::warning(this, "Git Busy", "A git operation of this workspace is still running.");
+        return;
     }
+
+    QString branch = branchCombo_->currentText();
+    QStringList remotes;
+    if (!chooseRemotes("Git Push", branch, remotes)) return;
+
+    GitPipeline *pipeline = new GitPipeline(supervisor_, currentWorkspaceName_,
+                                            QString::fromStdString(currentWorkspace_->getPath()), this);
+    addPushSteps(pipeline, branch, remotes);
+    runGitPipeline(pipeline, "Push", nullptr);
+}
+
+void MainWindow::gitCommitAndPush() {
+    TRACE_SCOPE("MainWindow::gitCommitAndPush", "git");
+    if (!currentWorkspace_) return;
+    if (supervisor_->isRunning(currentWorkspaceName_, "git")) {
+        QMessageBox::warning(this, "Git Busy", "A git operation of this workspace is still running.");
+        return;
+    }
+
+    bool ok;
+    QString commitMsg = QInputDialog::getText(this, "Commit Message",
+                                            "Enter commit message:", QLineEdit::Normal, "", &ok);
+    if (!ok || commitMsg.isEmpty()) return;
+
+    QString branch = branchCombo_->currentText();
+    QStringList remotes;
+    if (!chooseRemotes("Commit and Push", branch, remotes)) return;
+
+    // add -> commit -> push; a clean tree still pushes what is not pushed yet
+    GitPipeline *pipeline = new GitPipeline(supervisor_, currentWorkspaceName_,
+                                            QString::fromStdString(currentWorkspace_->getPath()), this);
+    pipeline->addStage("add", QStringList() << "add" << ".");
+    pipeline->addStage("commit", QStringList() << "commit" << "-m" << commitMsg, "nothing to commit");
+    addPushSteps(pipeline, branch, remotes);
+    runGitPipeline(pipeline, "Commit and Push", nullptr);
+}
+
+void MainWindow::editMakefile() {
+    TRACE_SCOPE("MainWindow::editMakefile", "build");
+    if (!currentWorkspace_) {
+        QMessageBox::warning(this, "No Workspace", "Please select a workspace first.");
+        return;
+    }
+    
+    QString makefilePath;
+    QDir workspaceDir(QString::fromStdString(currentWorkspace_->getPath()));
+    
+    // Look for Makefile in common locations
+    QStringList makefileNames = {"Makefile", "makefile", "GNUmakefile"};
+    for (const QString& name : makefileNames) {
+        if (workspaceDir.exists(name)) {
+            makefilePath = workspaceDir.absoluteFilePath(name);
+            break;
+        }
+    }
+    
+    // Check build directory for generated Makefiles
+    if (makefilePath.isEmpty()) {
+        QString buildDir = QString::fromStdString(currentWorkspace_->getBuildDirectory());
+        QDir buildDirObj(buildDir);
+        for (const QString& name : makefileNames) {
+            if (buildDirObj.exists(name)) {
+                makefilePath = buildDirObj.absoluteFilePath(name);
+                break;
+            }
+        }
+    }
+    
+    if (makefilePath.isEmpty()) {
+        QMessageBox::information(this, "No Makefile", "No Makefile found in the workspace.");
+        return;
+    }
+    
+    // Use the default system editor or code editor
+    QProcess* editorProcess = new QProcess(this);
+    QString command;
+    QStringList args;
+    
+    // Try to use VS Code first, then gedit as fallback
+    if (QProcess::execute("which", QStringList() << "code") == 0) {
+        command = "code";
+        args << makefilePath;
+    } else if (QProcess::execute("which", QStringList() << "gedit") == 0) {
+        command = "gedit";
+        args << makefilePath;
+    } else {
+        command = "xdg-open";
+        args << makefilePath;
+    }
+    
+    editorProcess->start(command, args);
+    if (!editorProcess->waitForStarted()) {
+        QMessageBox::warning(this, "Editor Failed", "Failed to open Makefile in editor.");
+    }
+}
+
+void MainWindow::setBuildSystem() {
+    if (!currentWorkspace_) return;
+    
+    QString buildSystem = buildSystemCombo_->currentText();
+    // You can store this preference in workspace settings or globally
+    // For now, it affects the next build command
+    
+    infoDisplay_->append(QString("Build system set to: %1").arg(buildSystem));
+}
+
+void MainWindow::populateTargets() {
+    // A newer selection or build supersedes this listing
+    targetsToken_.cancel();
+    if (!currentWorkspace_) {
+        targetCombo_->clear();
+        targetCombo_->addItem("All Targets");
+        return;
+    }
+
+    // Listing runs ninja or reads the CMake file API, which takes too long
+    // for the GUI thread on a large tree; the old list stays until then
+    std::string workspacePath = currentWorkspace_->getPath();
+    targetsToken_ = TaskExecutor::instance().submit(TaskLane::Interactive,
+                                                    [this, workspacePath](const CancellationToken& token) {
+        if (token.isCancelled()) return;
+        Workspace workspace(workspacePath);
+        std::vector<std::string> targets = workspace.getBuildTargets();
+        QMetaObject::invokeMethod(this, [this, token, workspacePath, targets]() {
+            if (token.isCancelled() || !currentWorkspace_ || currentWorkspace_->getPath() != workspacePath) return;
+            QString previous = targetCombo_->currentText();
+            targetCombo_->clear();
+            targetCombo_->addItem("All Targets");
+            for (const auto& target : targets) {
+                targetCombo_->addItem(QString::fromStdString(target));
+            }
+            // Keep iterating on the same target across rebuilds
+            int index = targetCombo_->findText(previous);
+            targetCombo_->setCurrentIndex(index > 0 ? index : 0);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::compileSingleFile() {
+    TRACE_SCOPE("MainWindow::compileSingleFile", "build");
+    if (!currentWorkspace_) return;
+
+    if (supervisor_->isRunning(currentWorkspaceName_, "build")) {
+        QMessageBox::warning(this, "Build in Progress", "A build of this workspace is already running.");
+        return;
+    }
+
+    std::string databasePath = currentWorkspace_->getCompileDatabasePath();
+    if (databasePath.empty() || !compileDatabase_.refresh(databasePath)) {
+        QMessageBox::warning(this, "No Compile Commands",
+                             "No compile_commands.json was found for this configuration.\n"
+                             "CMake projects export one when they are configured; for other build systems "
+                             "generate it with a tool such as bear.");
+        return;
+    }
+
+    QString workspacePath = QString::fromStdString(currentWorkspace_->getPath());
+    QString file = QFileDialog::getOpenFileName(this, "Compile File", workspacePath,
+                                                "C/C++ Sources (*.c *.cc *.cpp *.cxx *.c++ *.m *.mm);;All Files (*)");
+    if (file.isEmpty()) return;
+
+    const CompileCommand* command = compileDatabase_.find(file.toStdString());
+    if (!command) {
+        QMessageBox::warning(this, "Not a Translation Unit",
+                             QString("%1 is not compiled by this configuration.\n"
+                                     "Headers are compiled as part of the sources that include them.")
+                             .arg(QDir(workspacePath).relativeFilePath(file)));
+        return;
+    }
+
+    startCompile(*command, file, false);
+}
+
+void MainWindow::startCompile(const CompileCommand& command, const QString& file, bool automatic) {
+    TRACE_SCOPE("MainWindow::startCompile", "build");
+    QString workspacePath = QString::fromStdString(currentWorkspace_->getPath());
+    QString program;
+    QStringList arguments;
+    if (!command.arguments.empty()) {
+        program = QString::fromStdString(command.arguments.front());
+        for (size_t i = 1; i < command.arguments.size(); ++i) {
+            arguments << QString::fromStdString(command.arguments[i]);
+        }
+    } else {
+        // "command" is already shell-quoted
+        program = "/bin/sh";
+        arguments << "-c" << QString::fromStdString(command.command);
+    }
+
+    buildOutput_->clear();
+    buildOutput_->append(QString("Compiling %1\n").arg(QDir(workspacePath).relativeFilePath(file)));
+    buildOutput_->append(QString("Executing: %1 %2\n").arg(program, arguments.join(" ")));
+    buildProgress_->setValue(0);
+    buildProgress_->setVisible(true);
+
+    // Never recorded as up to date
+    BuildRequest request;
+    request.workspace = currentWorkspaceName_;
+    request.buildDir = QString::fromStdString(command.directory);
+    request.automatic = automatic;
+    // One translation unit would pull the build series down
+    request.historyAction = "compile";
+
+    ProcessJob *job = supervisor_->create(currentWorkspaceName_, "build", "compile " + file);
+    if (automatic) {
+        watchJobs_.insert(job->id());
+    }
+    job->process()->setWorkingDirectory(request.buildDir);
+    connect(job, &ProcessJob::output, this, &MainWindow::onBuildOutput);
+    connect(job, &ProcessJob::finished, this, [this, request, job](int exitCode, QProcess::ExitStatus exitStatus) {
+        onBuildFinished(request, job, exitCode, exitStatus);
+    });
+
+    instrumentProcess(job, "compile", file, "compile");
+    job->start(program, arguments);
+}
+
+void MainWindow::setWatchMode(WatchMode mode) {
+    TRACE_SCOPE("MainWindow::setWatchMode", "ui");
+    watchMode_ = mode;
+    updateWatcher();
+}
+
+void MainWindow::updateWatcher() {
+    QString wanted = watchMode_ != WatchMode::Off && currentWorkspace_ ? currentWorkspaceName_ : QString();
+    if (watcher_ && wanted == watchedWorkspace_) {
+        return;
+    }
+    delete watcher_;
+    watcher_ = nullptr;
+    watchedWorkspace_.clear();
+    watchChanges_.clear();
+    watchOverflowed_ = false;
+    watchRestart_ = false;
+    watchJobs_.clear();
+    if (wanted.isEmpty()) {
+        return;
+    }
+
+    // Build trees are left out, or every build would trigger the next one
+    watcher_ = new SourceWatcher(currentWorkspace_->getPath(), currentWorkspace_->getBuildDirectories(), this);
+    if (!watcher_->start()) {
+        QMessageBox::warning(this, "Watch", watcher_->error());
+        delete watcher_;
+        watcher_ = nullptr;
+        watchMode_ = WatchMode::Off;
+        watchOffAction_->setChecked(true);
+        return;
+    }
+    watchedWorkspace_ = wanted;
+    connect(watcher_, &SourceWatcher::changed, this, &MainWindow::onSourcesChanged);
+    statusBar()->showMessage(QString("Watching %1 directories of '%2'").arg(watcher_->directories()).arg(wanted), 5000);
+}
+
+void MainWindow::onSourcesChanged(const QStringList& paths, bool overflowed) {
+    if (sender() != watcher_) {
+        return;
+    }
+    for (const QString& path : paths) {
+        watchChanges_.insert(path);
+    }
+    watchOverflowed_ = watchOverflowed_ || overflowed;
+    startWatchBuild();
+}
+
+void MainWindow::startWatchBuild() {
+    TRACE_SCOPE("MainWindow::startWatchBuild", "build");
+    if (!watcher_ || !currentWorkspace_ || watchedWorkspace_ != currentWorkspaceName_) {
+        return;
+    }
+    if (watchChanges_.isEmpty() && !watchOverflowed_) {
+        return;
+    }
+
+    // A watch build that started before these saves compiles stale sources
+    // and is cancelled; the user's builds and reconfigures are left to
+    // finish. Either way, the next build starts once none is running.
+    if (supervisor_->isRunning(currentWorkspaceName_, "build")) {
+        if (!watchRestart_) {
+            watchRestart_ = true;
+            bool restarting = false;
+            for (ProcessJob *job : supervisor_->jobs()) {
+                if (job->isActive() && watchJobs_.contains(job->id())) {
+                    job->cancel();
+                    restarting = true;
+                }
+            }
+            statusBar()->showMessage(restarting ? "Watch: sources changed again, restarting the build"
+                                                : "Watch: building once the running build has finished", 5000);
+        }
+        return;
+    }
+    watchRestart_ = false;
+    watchJobs_.clear();
+
+    QStringList changed = watchChanges_.values();
+    changed.sort();
+    bool overflowed = watchOverflowed_;
+    watchChanges_.clear();
+    watchOverflowed_ = false;
+    statusBar()->showMessage(QString("Watch: %1 changed")
+                             .arg(overflowed ? QString("many files") :
+                                  changed.size() == 1 ? changed.front() : QString("%1 files").arg(changed.size())), 5000);
+
+    // One saved translation unit compiles on its own; headers and build
+    // files reach further, so they rebuild
+    if (watchMode_ == WatchMode::CompileFile && !overflowed && changed.size() == 1) {
+        QString file = QDir(QString::fromStdString(currentWorkspace_->getPath())).filePath(changed.front());
+        // Every save lands here; parsing the database each time costs more
+        // than the compile on a large project
+        std::string databasePath = currentWorkspace_->getCompileDatabasePath();
+        if (!databasePath.empty() && compileDatabase_.refresh(databasePath)) {
+            if (const CompileCommand* command = compileDatabase_.find(file.toStdString())) {
+                startCompile(*command, file, true);
+                return;
+            }
+        }
+    }
+    startBuild(false, true);
+}
+
+void MainWindow::editResourceLimits() {
+    TRACE_SCOPE("MainWindow::editResourceLimits", "ui");
+    ResourceLimits limits = supervisor_->resourceLimits();
+    Cgroup::Method method = Cgroup::availableMethod();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Resource Limits");
+    QFormLayout *form = new QFormLayout(&dialog);
+
+    QCheckBox *enabledCheck = new QCheckBox("Run builds and scripts in their own cgroup");
+    enabledCheck->setChecked(limits.enabled);
+    QSpinBox *cpuWeightSpin = new QSpinBox();
+    cpuWeightSpin->setRange(1, 10000);
+    cpuWeightSpin->setValue(limits.cpuWeight);
+    cpuWeightSpin->setToolTip("Share of CPU time under contention; everything else runs at 100");
+    QSpinBox *memorySpin = new QSpinBox();
+    memorySpin->setRange(0, 1024 * 1024);
+    memorySpin->setSuffix(" MB");
+    memorySpin->setSpecialValueText("Unlimited");
+    memorySpin->setValue(static_cast<int>(limits.memoryMaxMb));
+    memorySpin->setToolTip("Hard limit; the kernel reclaims and finally OOM-kills inside the build only");
+    QSpinBox *ioWeightSpin = new QSpinBox();
+    ioWeightSpin->setRange(1, 10000);
+    ioWeightSpin->setValue(limits.ioWeight);
+    ioWeightSpin->setToolTip("Share of disk bandwidth under contention; everything else runs at 100");
+
+    form->addRow(enabledCheck);
+    form->addRow("CPU Weight:", cpuWeightSpin);
+    form->addRow("Memory Limit:", memorySpin);
+    form->addRow("I/O Weight:", ioWeightSpin);
+    form->addRow("Method:", new QLabel(Cgroup::methodName(method)));
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    form->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    limits.enabled = enabledCheck->isChecked();
+    limits.cpuWeight = cpuWeightSpin->value();
+    limits.memoryMaxMb = static_cast<uint64_t>(memorySpin->value());
+    limits.ioWeight = ioWeightSpin->value();
+    limits.saveToFile(limitsFile_);
+    supervisor_->setResourceLimits(limits);
+
+    // Setting up the delegation is left until limits are actually wanted
+    if (limits.enabled && Cgroup::prepare() == Cgroup::Method::None) {
+        QMessageBox::warning(this, "Resource Limits",
+                             "Resource limits need a cgroup-v2 system with either a systemd user manager "
+                             "(systemd-run --user) or a delegated cgroup with the cpu, memory and io "
+                             "controllers. Builds run without them for now.");
+    }
+}
+
+void MainWindow::tuneParallelism() {
+    TRACE_SCOPE("MainWindow::tuneParallelism", "ui");
+    if (!currentWorkspace_) {
+        QMessageBox::information(this, "Parallelism", "Select a workspace first.");
+        return;
+    }
+    JobsChoice memory = currentWorkspace_->chooseBuildJobs();
+    ParallelismTuner tuner(currentWorkspace_->parallelismFile());
+    tuner.load();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Parallelism - " + currentWorkspaceName_);
+    dialog.resize(460, 320);
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+
+    QString status;
+    if (tuner.isTuning()) {
+        status = QString("Autotuning: each build tries one of the job counts below, %1 builds each.")
+                 .arg(ParallelismTuner::kBuildsPerCandidate);
+    } else if (tuner.tunedJobs() > 0) {
+        status = QString("Builds use %1 jobs, tuned for this workspace on this machine.").arg(tuner.tunedJobs());
+    } else {
+        status = "Not tuned: builds use one job per core, as far as memory allows.";
+    }
+    QLabel *statusLabel = new QLabel(status + QString("\nCores: %1, memory allows %2 jobs right now.")
+                                     .arg(memory.cores).arg(memory.jobs));
+    statusLabel->setWordWrap(true);
+    layout->addWidget(statusLabel);
+
+    auto candidates = tuner.candidates();
+    QTableWidget *table = new QTableWidget(static_cast<int>(candidates.size()), 4, &dialog);
+    table->setHorizontalHeaderLabels({"Jobs", "Builds", "Cores Busy", "Efficiency"});
+    table->verticalHeader()->setVisible(false);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    for (int row = 0; row < static_cast<int>(candidates.size()); ++row) {
+        const auto& candidate = candidates[row];
+        bool measured = candidate.builds > 0;
+        table->setItem(row, 0, new QTableWidgetItem(QString::number(candidate.jobs)));
+        table->setItem(row, 1, new QTableWidgetItem(QString::number(candidate.builds)));
+        table->setItem(row, 2, new QTableWidgetItem(measured ? QString::number(candidate.medianSpeedup, 'f', 2) : "-"));
+        table->setItem(row, 3, new QTableWidgetItem(measured ? QString::number(candidate.medianEfficiency * 100.0, 'f', 0) + "%" : "-"));
+    }
+    layout->addWidget(table);
+    layout->addWidget(new QLabel(QString("Builds shorter than %1 s are not counted.").arg(ParallelismTuner::kMinWallSeconds)));
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    QPushButton *startButton = buttons->addButton(tuner.isTuning() ? "Stop Autotune" : "Start Autotune",
+                                                  QDialogButtonBox::ActionRole);
+    QPushButton *forgetButton = buttons->addButton("Forget", QDialogButtonBox::ResetRole);
+    forgetButton->setEnabled(tuner.isTuning() || tuner.tunedJobs() > 0 || !tuner.samples().empty());
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    connect(startButton, &QPushButton::clicked, &dialog, [&dialog]() { dialog.done(1); });
+    connect(forgetButton, &QPushButton::clicked, &dialog, [&dialog]() { dialog.done(2); });
+
+    int choice = dialog.exec();
+    if (choice == 1) {
+        if (tuner.isTuning()) {
+            tuner.stopTuning();
+        } else {
+            tuner.startTuning(memory.cores, memory.jobs);
+        }
+    } else if (choice == 2) {
+        tuner.forget();
+    } else {
+        return;
+    }
+    if (!currentWorkspace_->prepareStateDirectory() || !tuner.save()) {
+        QMessageBox::warning(this, "Parallelism", "Failed to save the parallelism settings of this workspace.");
+    }
+}
+
+void MainWindow::editDistributedCompilation() {
+    TRACE_SCOPE("MainWindow::editDistributedCompilation", "ui");
+    if (!currentWorkspace_) {
+        QMessageBox::information(this, "Distributed Compilation", "Select a workspace first.");
+        return;
+    }
+    DistributedSettings settings;
+    settings.loadFromFile(currentWorkspace_->distributedSettingsFile());
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Distributed Compilation - " + currentWorkspaceName_);
+    QFormLayout *form = new QFormLayout(&dialog);
+
+    QCheckBox *enabledCheck = new QCheckBox("Distribute this workspace's compiles");
+    enabledCheck->setChecked(settings.enabled);
+    QComboBox *backendCombo = new QComboBox();
+    backendCombo->addItems({"auto", "distcc", "icecc"});
+    backendCombo->setCurrentText(QString::fromStdString(settings.backend));
+    backendCombo->setToolTip("auto prefers distcc when it is installed");
+    QSpinBox *slotsSpin = new QSpinBox();
+    slotsSpin->setRange(0, 4096);
+    slotsSpin->setSpecialValueText("From the distcc host list");
+    slotsSpin->setValue(settings.jobSlots);
+    slotsSpin->setToolTip("Compiles the cluster accepts at once; builds run with at least this many jobs");
+    QLabel *planLabel = new QLabel();
+    planLabel->setWordWrap(true);
+
+    auto describePlan = [&]() {
+        DistributedSettings probe;
+        probe.backend = backendCombo->currentText().toStdString();
+        probe.jobSlots = slotsSpin->value();
+        DistributedPlan plan = DistributedCompile::plan(probe);
+        if (!plan.error.empty()) {
+            planLabel->setText(QString::fromStdString(plan.error));
+            return;
+        }
+        QStringList hosts;
+        for (const auto& host : plan.hosts) {
+            hosts << QString("%1 (%2)").arg(QString::fromStdString(host.name)).arg(host.jobSlots);
+        }
+        planLabel->setText(QString("%1, %2 slots%3").arg(QString::fromStdString(plan.tool)).arg(plan.jobSlots)
+                           .arg(hosts.isEmpty() ? QString() : ": " + hosts.join(", ")));
+    };
+    describePlan();
+    connect(backendCombo, &QComboBox::currentTextChanged, &dialog, describePlan);
+    connect(slotsSpin, QOverload<int>::of(&QSpinBox::valueChanged), &dialog, describePlan);
+
+    form->addRow(enabledCheck);
+    form->addRow("Backend:", backendCombo);
+    form->addRow("Slots:", slotsSpin);
+    form->addRow("Detected:", planLabel);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    form->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    settings.enabled = enabledCheck->isChecked();
+    settings.backend = backendCombo->currentText().toStdString();
+    settings.jobSlots = slotsSpin->value();
+    currentWorkspace_->prepareStateDirectory();
+    settings.saveToFile(currentWorkspace_->distributedSettingsFile());
+}
+
+void MainWindow::showCompileProfile(const BuildRequest& request) {
+    compileProfile_->setPlainText("Aggregating -ftime-trace output...");
+    outputTabs_->setCurrentWidget(compileProfile_);
+    std::string buildDir = request.buildDir.toStdString();
+    Workspace *built = wm_.getWorkspace(request.workspace.toStdString());
+    std::string reportFile = built ? (built->stateDirectory() / "compile-profile.txt").string() : std::string();
+    int64_t sinceNs = request.profileSinceNs;
+    QString workspace = request.workspace;
+
+    // Large builds leave thousands of traces of several MB each
+    TaskExecutor::instance().submit(TaskLane::Background,
+                                    [this, buildDir, reportFile, sinceNs, workspace](const CancellationToken& token) {
+        if (token.isCancelled()) return;
+        std::vector<std::string> traces = TimeTraceReport::findTraces(buildDir, sinceNs);
+        std::string report;
+        if (traces.empty()) {
+            report = "No -ftime-trace output was found in " + buildDir +
+                     ". Compile profiles need the workspace to be built with Clang 9 or newer.\n";
+        } else {
+            report = TimeTraceReport::format(TimeTraceReport::aggregate(traces, buildDir));
+            QFile file(QString::fromStdString(reportFile));
+            if (!reportFile.empty() && file.open(QIODevice::WriteOnly)) {
+                file.write(QByteArray::fromStdString(report));
+            }
+        }
+        QMetaObject::invokeMethod(this, [this, report, workspace]() {
+            compileProfile_->setPlainText("Workspace: " + workspace + "\n" + QString::fromStdString(report));
+        }, Qt::QueuedConnection);
+    });
 }
 
-// Git versioning actions
-void MainWindow::gitMajorVersion() {
-    if (!currentWorkspace_) return;
-    
-    QString currentVer = getCurrentVersion(currentWorkspace_);
-    QString newVer = incrementVersion(currentVer, 2);
-    
-    int ret = QMessageBox::question(this, "Create Major Version", 
-                                   QString("Create new major version tag?\n%1 -> %2").arg(currentVer, newVer),
-                                   QMessageBox::Yes | QMessageBox::No);
-    
-    if (ret == QMessageBox::Yes) {
-        createVersionTag(newVer);
+void MainWindow::setBuildEnvironment(ProcessJob* job, const BuildRequest& request) {
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    // Only builds from here run the launcher the tree's shim looks for
+    environment.insert(CompileMemory::kLauncherVariable, compileLauncherPath());
+    environment.insert(CompileMemory::kLogVariable, request.compileMemoryLog);
+    if (request.profile) {
+        environment.insert(TimeTraceReport::kLauncherVariable, "1");
+        // A cache hit would compile nothing and so trace nothing
+        environment.insert("CCACHE_DISABLE", "1");
     }
-}
+    if (!request.distributedTool.isEmpty()) {
+        environment.insert(DistributedCompile::kLauncherVariable, request.distributedTool);
+    }
+    job->process()->setProcessEnvironment(environment);
+    if (request.distributedTool.isEmpty()) return;
 
-void MainWindow::gitMinorVersion() {
-    if (!currentWorkspace_) return;
-    
-    QString currentVer = getCurrentVersion(currentWorkspace_);
-    QString newVer = incrementVersion(currentVer, 1);
-    
-    int ret = QMessageBox::question(this, "Create Minor Version", 
-                                   QString("Create new minor version tag?\n%1 -> %2").arg(currentVer, newVer),
-                                   QMessageBox::Yes | QMessageBox::No);
-    
-    if (ret == QMessageBox::Yes) {
-        createVersionTag(newVer);
+    // Per-host counts come from distcc's state files; icecream has icemon
+    if (!request.distributedTool.endsWith("distcc")) return;
+    distributedSeen_.clear();
+    distributedCompiles_.clear();
+    if (!distributedTimer_) {
+        distributedTimer_ = new QTimer(this);
+        distributedTimer_->setInterval(250);
+        connect(distributedTimer_, &QTimer::timeout, this, &MainWindow::sampleDistributedCompiles);
     }
+    distributedTimer_->start();
 }
 
-void MainWindow::gitPatchVersion() {
-    if (!currentWorkspace_) return;
-    
-    QString currentVer = getCurrentVersion(currentWorkspace_);
-    QString newVer = incrementVersion(currentVer, 0);
-    
-    int ret = QMessageBox::question(this, "Create Patch Version", 
-                                   QString("Create new patch version tag?\n%1 -> %2").arg(currentVer, newVer),
-                                   QMessageBox::Yes | QMessageBox::No);
-    
-    if (ret == QMessageBox::Yes) {
-        createVersionTag(newVer);
+void MainWindow::sampleDistributedCompiles() {
+    QMap<QString, int> running;
+    for (const auto& task : DistributedCompile::distccTasks()) {
+        QString host = QString::fromStdString(task.host);
+        running[host]++;
+        // Each compile is a distcc client process of its own
+        QString key = QString("%1 %2").arg(task.pid).arg(QString::fromStdString(task.file));
+        if (!distributedSeen_.contains(key)) {
+            distributedSeen_.insert(key);
+            distributedCompiles_[host]++;
+        }
     }
-}
 
-void MainWindow::createVersionTag(const QString& version) {
-    if (!currentWorkspace_) return;
-    
-    std::string cwd = std::filesystem::current_path().string();
-    std::filesystem::current_path(currentWorkspace_->getPath());
-    
-    // Create annotated tag
-    std::string cmd = "git tag -a v" + version.toStdString() + " -m \"Version " + version.toStdString() + "\"";
-    std::string result = currentWorkspace_->runCommand(cmd);
-    
-    std::filesystem::current_path(cwd);
-    
-    if (result.find("fatal") == std::string::npos) {
-        QMessageBox::information(this, "Version Tagged", "Version " + version + " tagged successfully!");
-        versionLabel_->setText("Current Version: " + version);
-    } else {
-        QMessageBox::warning(this, "Tag Failed", "Failed to create version tag.\n" + QString::fromStdString(result));
+    bool building = false;
+    for (const ProcessJob* job : supervisor_->jobs()) {
+        building = building || (job->isActive() && job->action() == "build");
     }
+    if (!building) {
+        distributedTimer_->stop();
+        statusBar()->clearMessage();
+        return;
+    }
+    QStringList perHost;
+    for (auto it = running.constBegin(); it != running.constEnd(); ++it) {
+        perHost << QString("%1 %2").arg(it.key()).arg(it.value());
+    }
+    statusBar()->showMessage(QString("distcc compiling on: %1")
+                             .arg(perHost.isEmpty() ? QString("no host right now") : perHost.join(", ")), 1000);
 }
 
-void MainWindow::gitPush() {
-    if (!currentWorkspace_) return;
-    
-    QString branch = branchCombo_->currentText();
-    int ret = QMessageBox::question(this, "Git Push", 
-                                   "Push to branch: " + branch + " with tags?",
-                                   QMessageBox::Yes | QMessageBox::No);
-    
-    if (ret == QMessageBox::Yes) {
-        std::string cwd = std::filesystem::current_path().string();
-        std::filesystem::current_path(currentWorkspace_->getPath());
-        
-        // Push branch and tags
-        std::string cmd = "git push origin " + branch.toStdString() + " --tags";
-        std::string result = currentWorkspace_->runCommand(cmd);
-        
-        std::filesystem::current_path(cwd);
-        
-        if (result.find("fatal") == std::string::npos && result.find("error") == std::string::npos) {
-            QMessageBox::information(this, "Push Complete", "Successfully pushed to " + branch + " with tags!");
-            refreshWorkspace();
-        } else {
-            QMessageBox::warning(this, "Push Failed", "Failed to push.\n" + QString::fromStdString(result));
+void MainWindow::chooseLinker() {
+    TRACE_SCOPE("MainWindow::chooseLinker", "ui");
+    if (!currentWorkspace_) {
+        QMessageBox::information(this, "Linker", "Select a workspace first.");
+        return;
+    }
+    std::string current = currentWorkspace_->getLinker();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Linker - " + currentWorkspaceName_);
+    QFormLayout *form = new QFormLayout(&dialog);
+    QComboBox *linkerCombo = new QComboBox();
+    linkerCombo->addItem("Toolchain default", QString());
+    for (const auto& linker : LinkerBenchmark::linkers()) {
+        bool available = LinkerBenchmark::isAvailable(linker);
+        linkerCombo->addItem(QString::fromStdString(linker) + (available ? "" : " (not installed)"),
+                             QString::fromStdString(linker));
+        if (linker == current) {
+            linkerCombo->setCurrentIndex(linkerCombo->count() - 1);
         }
     }
+    form->addRow("Linker:", linkerCombo);
+    QLabel *note = new QLabel("Selected with CMAKE_LINKER_TYPE on CMake 3.29 and newer, -fuse-ld otherwise. "
+                              "Changing it reconfigures the build tree; only link steps rerun.");
+    note->setWordWrap(true);
+    form->addRow(note);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    QPushButton *benchmarkButton = buttons->addButton("Benchmark...", QDialogButtonBox::ActionRole);
+    form->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    connect(benchmarkButton, &QPushButton::clicked, &dialog, [&dialog]() { dialog.done(2); });
+
+    int choice = dialog.exec();
+    if (choice == 2) {
+        benchmarkLinkers();
+        return;
+    }
+    if (choice != QDialog::Accepted) return;
+
+    std::string chosen = linkerCombo->currentData().toString().toStdString();
+    if (chosen == current) return;
+    if (!chosen.empty() && !LinkerBenchmark::isAvailable(chosen)) {
+        QMessageBox::warning(this, "Linker", QString("%1 is not installed.").arg(QString::fromStdString(chosen)));
+        return;
+    }
+    if (!currentWorkspace_->setLinker(chosen)) {
+        QMessageBox::warning(this, "Linker", "Failed to save the linker of this workspace.");
+        return;
+    }
+    reconfigureWorkspace(QString("Linking with %1").arg(chosen.empty() ? QString("the toolchain default")
+                                                                        : QString::fromStdString(chosen)));
 }
 
-void MainWindow::gitCommitAndPush() {
-    if (!currentWorkspace_) return;
-    
-    bool ok;
-    QString commitMsg = QInputDialog::getText(this, "Commit Message", 
-                                            "Enter commit message:", QLineEdit::Normal, "", &ok);
-    
-    if (ok && !commitMsg.isEmpty()) {
-        std::string cwd = std::filesystem::current_path().string();
-        std::filesystem::current_path(currentWorkspace_->getPath());
-        
-        // Add all changes
-        currentWorkspace_->runCommand("git add .");
-        
-        // Commit
-        std::string cmd = "git commit -m \"" + commitMsg.toStdString() + "\"";
-        std::string result = currentWorkspace_->runCommand(cmd);
-        
-        std::filesystem::current_path(cwd);
-        
-        if (result.find("nothing to commit") != std::string::npos) {
-            QMessageBox::information(this, "Nothing to Commit", "No changes to commit.");
-            return;
+void MainWindow::reconfigureWorkspace(const QString& reason) {
+    QString buildDir = QString::fromStdString(currentWorkspace_->getBuildDirectory());
+    // A tree that was never configured picks the change up on its first build
+    if (currentWorkspace_->detectBuildSystem() != BuildSystem::CMake || !QFile::exists(buildDir + "/CMakeCache.txt")) {
+        return;
+    }
+    if (supervisor_->isRunning(currentWorkspaceName_, "build")) {
+        buildOutput_->append(reason + ": reconfigure once the running build has finished (Build reconfigures on its own after Clean).\n");
+        return;
+    }
+    buildOutput_->append(reason + ", reconfiguring " + buildDir + "\n");
+    ProcessJob *job = supervisor_->create(currentWorkspaceName_, "build", "cmake configure " + buildDir);
+    job->process()->setWorkingDirectory(buildDir);
+    connect(job, &ProcessJob::output, this, &MainWindow::onBuildOutput);
+    QString workspace = currentWorkspaceName_;
+    std::string configuration = currentWorkspace_->getActiveConfiguration().name;
+    connect(job, &ProcessJob::finished, this, [this, workspace, configuration](int exitCode, QProcess::ExitStatus exitStatus) {
+        Workspace *configured = wm_.getWorkspace(workspace.toStdString());
+        // Whatever the outcome, the tree no longer matches its last build
+        if (configured) {
+            configured->forgetSuccessfulBuild(configuration);
         }
-        
-        if (result.find("fatal") == std::string::npos) {
-            // Now push
-            gitPush();
+        if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
+            if (configured) {
+                configured->recordConfigureCache();
+            }
+            buildOutput_->append("Reconfigured; the next build relinks with the new settings.\n");
         } else {
-            QMessageBox::warning(this, "Commit Failed", "Failed to commit changes.\n" + QString::fromStdString(result));
+            buildOutput_->append("Reconfiguring failed.\n");
         }
+    });
+    QStringList cmakeArgs;
+    for (const auto& arg : currentWorkspace_->getConfigureArguments(currentWorkspace_->getActiveConfiguration())) {
+        cmakeArgs << QString::fromStdString(arg);
     }
+    instrumentProcess(job, "cmake configure", buildDir, "configure");
+    job->start("cmake", cmakeArgs);
 }
 
-void MainWindow::editMakefile() {
-    if (!currentWorkspace_) {
-        QMessageBox::warning(this, "No Workspace", "Please select a workspace first.");
+// Runs queued one after another, so linkers do not compete for the disk
+struct MainWindow::LinkBenchmarkRun {
+    QString workspace;
+    QString target;
+    QString workingDirectory;
+    QStringList queue;                 // Linker of each pending run
+    QMap<QString, QString> commands;   // Per linker
+    QMap<QString, QString> outputs;    // Scratch artifact per linker
+    // Private (0700) home of the outputs, so no other user can plant a link
+    // for a linker to write through
+    QTemporaryDir scratch{QDir::tempPath() + "/cppm-link-XXXXXX"};
+    QMap<QString, QList<double>> times;
+    QMap<QString, QString> errors;
+    QString current;
+};
+
+void MainWindow::benchmarkLinkers() {
+    TRACE_SCOPE("MainWindow::benchmarkLinkers", "build");
+    if (!currentWorkspace_) return;
+    if (supervisor_->isRunning(currentWorkspaceName_, "build") ||
+        supervisor_->isRunning(currentWorkspaceName_, "link benchmark")) {
+        QMessageBox::warning(this, "Benchmark Linkers", "Wait for the running build or benchmark of this workspace to finish.");
         return;
     }
-    
-    QString makefilePath;
-    QDir workspaceDir(QString::fromStdString(currentWorkspace_->getPath()));
-    
-    // Look for Makefile in common locations
-    QStringList makefileNames = {"Makefile", "makefile", "GNUmakefile"};
-    for (const QString& name : makefileNames) {
-        if (workspaceDir.exists(name)) {
-            makefilePath = workspaceDir.absoluteFilePath(name);
-            break;
+    CMakeCodeModel model;
+    if (!currentWorkspace_->getCodeModel(model)) {
+        QMessageBox::information(this, "Benchmark Linkers", "Linker benchmarks need a configured and built CMake workspace.");
+        return;
+    }
+    ExecutableInfo chosen;
+    if (!chooseRunTarget(model, chosen, "Benchmark")) return;
+    auto target = std::find_if(model.targets.begin(), model.targets.end(),
+                               [&](const CMakeTarget& t) { return t.name == chosen.name; });
+    if (target == model.targets.end()) return;
+
+    std::string buildTop = currentWorkspace_->getBuildDirectory();
+    LinkCommand link = LinkerBenchmark::linkCommand(buildTop, *target);
+    if (!link.error.empty()) {
+        QMessageBox::warning(this, "Benchmark Linkers", QString::fromStdString(link.error));
+        return;
+    }
+
+    auto run = std::make_shared<LinkBenchmarkRun>();
+    if (!run->scratch.isValid()) {
+        QMessageBox::warning(this, "Benchmark Linkers", "Could not create a scratch directory in " + QDir::tempPath() + ".");
+        return;
+    }
+    run->workspace = currentWorkspaceName_;
+    run->target = QString::fromStdString(target->name);
+    run->workingDirectory = QString::fromStdString(link.workingDirectory);
+    // The first of three runs warms the page cache; the best one is reported
+    const int runsPerLinker = 3;
+    for (const auto& linker : LinkerBenchmark::linkers()) {
+        QString name = QString::fromStdString(linker);
+        if (!LinkerBenchmark::isAvailable(linker)) {
+            run->errors[name] = "not installed";
+            continue;
+        }
+        QString output = run->scratch.filePath(name);
+        run->outputs[name] = output;
+        run->commands[name] = QString::fromStdString(LinkerBenchmark::withLinker(link.command, linker, output.toStdString()));
+        for (int i = 0; i < runsPerLinker; ++i) {
+            run->queue << name;
         }
     }
-    
-    // Check build directory for generated Makefiles
-    if (makefilePath.isEmpty()) {
-        QString buildDir = QString::fromStdString(currentWorkspace_->getBuildDirectory());
-        QDir buildDirObj(buildDir);
-        for (const QString& name : makefileNames) {
-            if (buildDirObj.exists(name)) {
-                makefilePath = buildDirObj.absoluteFilePath(name);
-                break;
+
+    outputTabs_->setCurrentWidget(buildOutput_);
+    buildOutput_->append(QString("\n=== Linker benchmark: %1 ===\nLink command: %2\n")
+                         .arg(run->target, QString::fromStdString(link.command)));
+    runLinkBenchmark(run);
+}
+
+void MainWindow::runLinkBenchmark(std::shared_ptr<LinkBenchmarkRun> run) {
+    // Next run, skipping linkers that already failed once
+    while (!run->queue.isEmpty() && run->errors.contains(run->queue.front())) {
+        run->queue.pop_front();
+    }
+    if (run->queue.isEmpty()) {
+        Workspace *ws = wm_.getWorkspace(run->workspace.toStdString());
+        QString selected = ws ? QString::fromStdString(ws->getLinker()) : QString();
+        QString report = QString("%1  %2  %3  %4\n").arg("Linker", -8).arg("Best", 10).arg("Median", 10).arg("Output", 10);
+        for (const auto& linker : LinkerBenchmark::linkers()) {
+            QString name = QString::fromStdString(linker);
+            QString marker = name == selected ? "  (selected)" : QString();
+            if (run->errors.contains(name)) {
+                report += QString("%1  %2%3\n").arg(name, -8).arg(run->errors[name]).arg(marker);
+                continue;
             }
+            QList<double> times = run->times[name];
+            std::sort(times.begin(), times.end());
+            report += QString("%1  %2  %3  %4%5\n").arg(name, -8)
+                      .arg(QString::number(times.front(), 'f', 0) + " ms", 10)
+                      .arg(QString::number(times[times.size() / 2], 'f', 0) + " ms", 10)
+                      .arg(QString::number(QFileInfo(run->outputs[name]).size() / (1024.0 * 1024.0), 'f', 1) + " MB", 10)
+                      .arg(marker);
         }
-    }
-    
-    if (makefilePath.isEmpty()) {
-        QMessageBox::information(this, "No Makefile", "No Makefile found in the workspace.");
+        if (run->workspace == currentWorkspaceName_) {
+            buildOutput_->append(report + "Build > Linker... selects one for this workspace.\n");
+        }
+        run->scratch.remove();
         return;
     }
-    
-    // Use the default system editor or code editor
-    QProcess* editorProcess = new QProcess(this);
-    QString command;
-    QStringList args;
-    
-    // Try to use VS Code first, then gedit as fallback
-    if (QProcess::execute("which", QStringList() << "code") == 0) {
-        command = "code";
-        args << makefilePath;
-    } else if (QProcess::execute("which", QStringList() << "gedit") == 0) {
-        command = "gedit";
-        args << makefilePath;
-    } else {
-        command = "xdg-open";
-        args << makefilePath;
+
+    QString linker = run->queue.takeFirst();
+    run->current = linker;
+    ProcessJob *job = supervisor_->create(run->workspace, "link benchmark", run->target + " with " + linker);
+    job->process()->setWorkingDirectory(run->workingDirectory);
+    connect(job, &ProcessJob::finished, this, [this, run, job](int exitCode, QProcess::ExitStatus exitStatus) {
+        if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
+            run->times[run->current] << job->elapsedNs() / 1e6;
+        } else {
+            QString log = job->log().trimmed();
+            run->errors[run->current] = "failed: " + log.split('\n').first();
+        }
+        runLinkBenchmark(run);
+    });
+    job->start("sh", QStringList() << "-c" << run->commands[linker]);
+}
+
+void MainWindow::populateConfigurations() {
+    // Rebuilding the list must not be mistaken for a user selection
+    QSignalBlocker blocker(configurationCombo_);
+    configurationCombo_->clear();
+    if (!currentWorkspace_) return;
+
+    std::string active = currentWorkspace_->getActiveConfiguration().name;
+    for (const auto& config : currentWorkspace_->getConfigurations()) {
+        configurationCombo_->addItem(QString::fromStdString(config.name));
+        configurationCombo_->setItemData(configurationCombo_->count() - 1,
+                                         QString::fromStdString(config.directory), Qt::ToolTipRole);
     }
-    
-    editorProcess->start(command, args);
-    if (!editorProcess->waitForStarted()) {
-        QMessageBox::warning(this, "Editor Failed", "Failed to open Makefile in editor.");
+    configurationCombo_->setCurrentText(QString::fromStdString(active));
+}
+
+void MainWindow::setConfiguration() {
+    if (!currentWorkspace_ || configurationCombo_->currentIndex() < 0) return;
+
+    std::string name = configurationCombo_->currentText().toStdString();
+    if (currentWorkspace_->setActiveConfiguration(name)) {
+        buildOutput_->append(QString("Configuration set to: %1 (%2)")
+                             .arg(configurationCombo_->currentText(),
+                                  QString::fromStdString(currentWorkspace_->getBuildDirectory())));
+        populateTargets();
+        displayWorkspaceInfo(currentWorkspace_);
     }
 }
 
-void MainWindow::setBuildSystem() {
+void MainWindow::newConfiguration() {
+    TRACE_SCOPE("MainWindow::newConfiguration", "ui");
     if (!currentWorkspace_) return;
-    
-    QString buildSystem = buildSystemCombo_->currentText();
-    // You can store this preference in workspace settings or globally
-    // For now, it affects the next build command
-    
-    infoDisplay_->append(QString("Build system set to: %1").arg(buildSystem));
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("New Build Configuration");
+    QFormLayout *form = new QFormLayout(&dialog);
+
+    QLineEdit *nameEdit = new QLineEdit();
+    QComboBox *buildTypeCombo = new QComboBox();
+    buildTypeCombo->addItems({"Debug", "Release", "RelWithDebInfo", "MinSizeRel", ""});
+    QLineEdit *directoryEdit = new QLineEdit();
+    directoryEdit->setPlaceholderText("build-<name>");
+    QLineEdit *toolchainEdit = new QLineEdit();
+    toolchainEdit->setPlaceholderText("Optional toolchain file");
+    QLineEdit *cacheEdit = new QLineEdit();
+    cacheEdit->setPlaceholderText("e.g. CMAKE_CXX_COMPILER=clang++;ENABLE_TESTS=ON");
+
+    form->addRow("Name:", nameEdit);
+    form->addRow("Build Type:", buildTypeCombo);
+    form->addRow("Directory:", directoryEdit);
+    form->addRow("Toolchain File:", toolchainEdit);
+    form->addRow("Cache Entries:", cacheEdit);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    form->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    QString name = nameEdit->text().trimmed();
+    if (name.isEmpty()) {
+        QMessageBox::warning(this, "Invalid Configuration", "Please enter a configuration name.");
+        return;
+    }
+
+    BuildConfiguration config;
+    config.name = name.toStdString();
+    config.buildType = buildTypeCombo->currentText().toStdString();
+    QString directory = directoryEdit->text().trimmed();
+    config.directory = directory.isEmpty() ? ("build-" + name.toLower()).toStdString() : directory.toStdString();
+    config.toolchainFile = toolchainEdit->text().trimmed().toStdString();
+    for (const QString& entry : cacheEdit->text().split(';', Qt::SkipEmptyParts)) {
+        config.cacheEntries.push_back(entry.trimmed().toStdString());
+    }
+
+    std::string error;
+    if (!currentWorkspace_->addConfiguration(config, &error)) {
+        QMessageBox::warning(this, "Invalid Configuration",
+                             QString("Cannot add the configuration: %1.").arg(QString::fromStdString(error)));
+        return;
+    }
+
+    currentWorkspace_->setActiveConfiguration(config.name);
+    populateConfigurations();
+    buildOutput_->append(QString("Added configuration '%1' building into %2")
+                         .arg(name, QString::fromStdString(config.directory)));
+    // The watcher has to leave the new build tree out as well
+    if (watcher_) {
+        delete watcher_;
+        watcher_ = nullptr;
+        updateWatcher();
+    }
 }
 
 void MainWindow::closeEvent(QCloseEvent *event) {
     // Save workspaces before closing
     wm_.saveToFile();
+    MetricsRegistry::instance().saveToFile(metricsFile_);
     
-    // Clean up build process if running
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        buildProcess_->terminate();
-        if (!buildProcess_->waitForFinished(3000)) {
-            buildProcess_->kill();
-        }
+    // Stop every child and its descendants; their finished handlers would
+    // only pop up dialogs now. Whatever outlives the grace period is killed
+    // when the supervisor is destroyed.
+    for (ProcessJob* job : supervisor_->jobs()) {
+        job->disconnect(this);
     }
+    supervisor_->cancelAll();
+    supervisor_->waitForAll(3000);
     
     // Accept the close event
     event->accept();
@@ -1338,6 +3290,7 @@ void MainWindow::discoverScripts() {
 }
 
 void MainWindow::runScript() {
+    TRACE_SCOPE("MainWindow::runScript", "build");
     if (scriptCombo_->currentIndex() < 0 || scriptCombo_->currentIndex() >= availableScripts_.size()) {
         QMessageBox::warning(this, "No Script Selected", "Please select a script to run.");
         return;
@@ -1362,36 +3315,27 @@ void MainWindow::runScript() {
     buildOutput_->append(""); // Empty line
     
     // Create process to run the script
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "Process Running", "Another process is already running. Please wait for it to finish.");
+    if (supervisor_->isRunning(scriptName, "script")) {
+        QMessageBox::warning(this, "Process Running", "This script is already running. Please wait for it to finish.");
         return;
     }
     
-    buildProcess_ = new QProcess(this);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &MainWindow::onScriptFinished);
-    connect(buildProcess_, &QProcess::readyReadStandardOutput,
-            this, &MainWindow::onScriptOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError,
-            this, &MainWindow::onScriptOutput);
+    ProcessJob *job = supervisor_->create(scriptName, "script", scriptPath);
+    connect(job, &ProcessJob::finished, this, &MainWindow::onScriptFinished);
+    connect(job, &ProcessJob::output, this, &MainWindow::onScriptOutput);
     
     // Show progress
     buildProgress_->setVisible(true);
     buildProgress_->setRange(0, 0); // Indeterminate progress
     
-    // Start the script
-    buildProcess_->setWorkingDirectory(QDir::currentPath());
-    buildProcess_->start("bash", QStringList() << scriptPath);
-    
-    if (!buildProcess_->waitForStarted()) {
-        QMessageBox::critical(this, "Script Failed", "Failed to start the script.");
-        buildProgress_->setVisible(false);
-        buildProcess_->deleteLater();
-        buildProcess_ = nullptr;
-    }
+    // Start the script; a script that cannot run fails with exit code 127
+    job->process()->setWorkingDirectory(QDir::currentPath());
+    instrumentProcess(job, "script", scriptPath);
+    job->start("bash", QStringList() << scriptPath);
 }
 
 void MainWindow::installSystemWide() {
+    TRACE_SCOPE("MainWindow::installSystemWide", "build");
     // Confirm system-wide installation
     int ret = QMessageBox::question(this, "System-Wide Installation", 
                                   "This will install C++ Workspace Manager system-wide. "
@@ -1408,18 +3352,14 @@ void MainWindow::installSystemWide() {
     buildOutput_->append("");
     
     // Create process to run system-wide installation
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "Process Running", "Another process is already running. Please wait for it to finish.");
+    if (supervisor_->isRunning(QString(), "install")) {
+        QMessageBox::warning(this, "Process Running", "An installation is already running. Please wait for it to finish.");
         return;
     }
     
-    buildProcess_ = new QProcess(this);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &MainWindow::onInstallFinished);
-    connect(buildProcess_, &QProcess::readyReadStandardOutput,
-            this, &MainWindow::onScriptOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError,
-            this, &MainWindow::onScriptOutput);
+    ProcessJob *job = supervisor_->create(QString(), "install", "System-wide installation");
+    connect(job, &ProcessJob::finished, this, &MainWindow::onInstallFinished);
+    connect(job, &ProcessJob::output, this, &MainWindow::onScriptOutput);
     
     // Show progress
     buildProgress_->setVisible(true);
@@ -1433,20 +3373,12 @@ void MainWindow::installSystemWide() {
     }
     
     // Start the installation script
-    buildProcess_->setWorkingDirectory(QDir::currentPath());
-    buildProcess_->start("bash", QStringList() << installScript);
-    
-    if (!buildProcess_->waitForStarted()) {
-        QMessageBox::critical(this, "Installation Failed", "Failed to start the installation script.");
-        buildProgress_->setVisible(false);
-        buildProcess_->deleteLater();
-        buildProcess_ = nullptr;
-    }
+    job->process()->setWorkingDirectory(QDir::currentPath());
+    instrumentProcess(job, "install", installScript);
+    job->start("bash", QStringList() << installScript);
 }
 
 void MainWindow::onScriptFinished(int exitCode, QProcess::ExitStatus exitStatus) {
-    buildProgress_->setVisible(false);
-    
     if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
         buildOutput_->append("\n=== Script completed successfully! ===");
         QMessageBox::information(this, "Script Complete", "Script executed successfully!");
@@ -1454,14 +3386,9 @@ void MainWindow::onScriptFinished(int exitCode, QProcess::ExitStatus exitStatus)
         buildOutput_->append(QString("\n=== Script failed with exit code: %1 ===").arg(exitCode));
         QMessageBox::warning(this, "Script Failed", "Script execution failed. Check the output for details.");
     }
-    
-    buildProcess_->deleteLater();
-    buildProcess_ = nullptr;
 }
 
 void MainWindow::onInstallFinished(int exitCode, QProcess::ExitStatus exitStatus) {
-    buildProgress_->setVisible(false);
-    
     if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
         buildOutput_->append("\n=== System-wide installation completed successfully! ===");
         QMessageBox::information(this, "Installation Complete", 
@@ -1471,23 +3398,16 @@ void MainWindow::onInstallFinished(int exitCode, QProcess::ExitStatus exitStatus
         buildOutput_->append(QString("\n=== Installation failed with exit code: %1 ===").arg(exitCode));
         QMessageBox::warning(this, "Installation Failed", "System-wide installation failed. Check the output for details.");
     }
-    
-    buildProcess_->deleteLater();
-    buildProcess_ = nullptr;
 }
 
-void MainWindow::onScriptOutput() {
-    if (buildProcess_) {
-        QByteArray data = buildProcess_->readAllStandardOutput();
-        QString output = QString::fromLocal8Bit(data);
-        buildOutput_->append(output);
-        
-        // Also read stderr
-        data = buildProcess_->readAllStandardError();
-        if (!data.isEmpty()) {
-            QString errorOutput = QString::fromLocal8Bit(data);
-            buildOutput_->append(QString("<font color='red'>%1</font>").arg(errorOutput));
-        }
+void MainWindow::onScriptOutput(const QString& text, bool isError) {
+    if (!showsOutputOf(qobject_cast<ProcessJob*>(sender()))) {
+        return;
+    }
+    if (isError) {
+        buildOutput_->append(QString("<font color='red'>%1</font>").arg(text));
+    } else {
+        buildOutput_->append(text);
     }
 }
 
@@ -1505,15 +3425,15 @@ void MainWindow::createSystemWideInstallScript(const QString& scriptPath) {
         out << "echo \"Installing C++ Workspace Manager system-wide...\"\n";
         out << "\n";
         out << "# Check if executable exists\n";
-        out << "if [ ! -f \"build/cppm\" ]; then\n";
-        out << "    echo \"Error: build/cppm not found. Please build the project first.\"\n";
+        out << "if [ ! -f \"build/cppm\" ] || [ ! -f \"build/cppm-launcher\" ]; then\n";
+        out << "    echo \"Error: build/cppm or build/cppm-launcher not found. Please build the project first.\"\n";
         out << "    exit 1\n";
         out << "fi\n";
         out << "\n";
         out << "# Install executable to /usr/local/bin\n";
         out << "echo \"Installing executable to /usr/local/bin...\"\n";
-        out << "sudo cp build/cppm /usr/local/bin/\n";
-        out << "sudo chmod +x /usr/local/bin/cppm\n";
+        out << "sudo cp build/cppm build/cppm-launcher /usr/local/bin/\n";
+        out << "sudo chmod +x /usr/local/bin/cppm /usr/local/bin/cppm-launcher\n";
         out << "\n";
         out << "# Create desktop entry\n";
         out << "echo \"Creating desktop entry...\"\n";
@@ -1545,8 +3465,6 @@ void MainWindow::createSystemWideInstallScript(const QString& scriptPath) {
 }
 
 void MainWindow::onCloneFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& repoName, const QString& clonePath) {
-    buildProgress_->setVisible(false);
-    
     if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
         buildOutput_->append("\n=== Clone completed successfully! ===");
         
@@ -1565,12 +3483,10 @@ void MainWindow::onCloneFinished(int exitCode, QProcess::ExitStatus exitStatus,
         buildOutput_->append(QString("\n=== Clone failed with exit code: %1 ===").arg(exitCode));
         QMessageBox::warning(this, "Clone Failed", "Repository clone failed. Check the output for details.");
     }
-    
-    buildProcess_->deleteLater();
-    buildProcess_ = nullptr;
 }
 
 void MainWindow::renameRepository() {
+    TRACE_SCOPE("MainWindow::renameRepository", "git");
     if (!currentWorkspace_) {
         QMessageBox::warning(this, "No Workspace", "Please select a workspace first.");
         return;
@@ -1629,6 +3545,7 @@ void MainWindow::renameRepository() {
 }
 
 void MainWindow::createGithubRelease() {
+    TRACE_SCOPE("MainWindow::createGithubRelease", "github");
     if (!currentWorkspace_) {
         QMessageBox::warning(this, "No Workspace", "Please select a workspace first.");
         return;
@@ -1662,22 +3579,20 @@ void MainWindow::createGithubRelease() {
     buildOutput_->append(QString("=== Creating GitHub release: %1 ===").arg(releaseVersion));
     buildOutput_->append("");
     
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "Process Running", "Another process is already running. Please wait for it to finish.");
+    if (supervisor_->isRunning(currentWorkspaceName_, "release")) {
+        QMessageBox::warning(this, "Process Running", "A release of this workspace is already in progress. Please wait for it to finish.");
         return;
     }
     
-    buildProcess_ = new QProcess(this);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &MainWindow::onGithubActionFinished);
-    connect(buildProcess_, &QProcess::readyReadStandardOutput, this, &MainWindow::onScriptOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError, this, &MainWindow::onScriptOutput);
+    ProcessJob *job = supervisor_->create(currentWorkspaceName_, "release", "git tag " + releaseVersion);
+    connect(job, &ProcessJob::finished, this, &MainWindow::onGithubActionFinished);
+    connect(job, &ProcessJob::output, this, &MainWindow::onScriptOutput);
     
     buildProgress_->setVisible(true);
     buildProgress_->setRange(0, 0);
     
     // Create a tag first, then try to create release using gh CLI if available
-    buildProcess_->setWorkingDirectory(currentPath);
+    job->process()->setWorkingDirectory(currentPath);
     
     // First create and push the tag
     QStringList tagArgs;
@@ -1686,17 +3601,12 @@ void MainWindow::createGithubRelease() {
         tagArgs << "-m" << releaseNotes;
     }
     
-    buildProcess_->start("git", tagArgs);
-    
-    if (!buildProcess_->waitForStarted()) {
-        QMessageBox::critical(this, "Release Failed", "Failed to create git tag.");
-        buildProgress_->setVisible(false);
-        buildProcess_->deleteLater();
-        buildProcess_ = nullptr;
-    }
+    instrumentProcess(job, "git tag", releaseVersion, "git");
+    job->start("git", tagArgs);
 }
 
 void MainWindow::openGithubRepo() {
+    TRACE_SCOPE("MainWindow::openGithubRepo", "github");
     if (!currentWorkspace_) {
         QMessageBox::warning(this, "No Workspace", "Please select a workspace first.");
         return;
@@ -1734,6 +3644,7 @@ void MainWindow::openGithubRepo() {
 }
 
 void MainWindow::viewGithubIssues() {
+    TRACE_SCOPE("MainWindow::viewGithubIssues", "github");
     if (!currentWorkspace_) {
         QMessageBox::warning(this, "No Workspace", "Please select a workspace first.");
         return;
@@ -1774,8 +3685,6 @@ void MainWindow::viewGithubIssues() {
 }
 
 void MainWindow::onGithubActionFinished(int exitCode, QProcess::ExitStatus exitStatus) {
-    buildProgress_->setVisible(false);
-    
     if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
         buildOutput_->append("\n=== GitHub action completed successfully! ===");
         QMessageBox::information(this, "Action Complete", "GitHub action completed successfully!");
@@ -1783,12 +3692,10 @@ void MainWindow::onGithubActionFinished(int exitCode, QProcess::ExitStatus exitS
         buildOutput_->append(QString("\n=== GitHub action failed with exit code: %1 ===").arg(exitCode));
         QMessageBox::warning(this, "Action Failed", "GitHub action failed. Check the output for details.");
     }
-    
-    buildProcess_->deleteLater();
-    buildProcess_ = nullptr;
 }
 
 void MainWindow::authenticateGithub() {
+    TRACE_SCOPE("MainWindow::authenticateGithub", "github");
     bool ok;
     QString token = QInputDialog::getText(this, "GitHub Authentication", 
                                         "Enter your GitHub Personal Access Token:\n"
@@ -1805,18 +3712,16 @@ void MainWindow::authenticateGithub() {
     buildOutput_->append("=== Verifying GitHub authentication ===");
     buildOutput_->append("");
     
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "Process Running", "Another process is already running. Please wait for it to finish.");
+    if (supervisor_->isRunning(QString(), "github auth")) {
+        QMessageBox::warning(this, "Process Running", "Authentication is already in progress. Please wait for it to finish.");
         return;
     }
     
-    buildProcess_ = new QProcess(this);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            [this, token](int exitCode, QProcess::ExitStatus exitStatus) {
-                onGithubAuthFinished(exitCode, exitStatus, token);
-            });
-    connect(buildProcess_, &QProcess::readyReadStandardOutput, this, &MainWindow::onScriptOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError, this, &MainWindow::onScriptOutput);
+    ProcessJob *job = supervisor_->create(QString(), "github auth", "https://api.github.com/user");
+    connect(job, &ProcessJob::finished, this, [this, job, token](int exitCode, QProcess::ExitStatus exitStatus) {
+        onGithubAuthFinished(exitCode, exitStatus, token, job->standardOutput());
+    });
+    connect(job, &ProcessJob::output, this, &MainWindow::onScriptOutput);
     
     buildProgress_->setVisible(true);
     buildProgress_->setRange(0, 0);
@@ -1827,14 +3732,8 @@ void MainWindow::authenticateGithub() {
          << "-H" << "Accept: application/vnd.github.v3+json"
          << "https://api.github.com/user";
     
-    buildProcess_->start("curl", args);
-    
-    if (!buildProcess_->waitForStarted()) {
-        QMessageBox::critical(this, "Authentication Failed", "Failed to verify GitHub token. Make sure curl is installed.");
-        buildProgress_->setVisible(false);
-        buildProcess_->deleteLater();
-        buildProcess_ = nullptr;
-    }
+    instrumentProcess(job, "github auth", "https://api.github.com/user");
+    job->start("curl", args);
 }
 
 void MainWindow::openGithubTokenPage() {
@@ -1853,6 +3752,7 @@ void MainWindow::openGithubTokenPage() {
 }
 
 void MainWindow::browseGithubRepos() {
+    TRACE_SCOPE("MainWindow::browseGithubRepos", "github");
     if (!isGithubAuthenticated_) {
         QMessageBox::warning(this, "Not Authenticated", "Please authenticate with GitHub first.");
         return;
@@ -1862,16 +3762,16 @@ void MainWindow::browseGithubRepos() {
     buildOutput_->append("=== Fetching your GitHub repositories ===");
     buildOutput_->append("");
     
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "Process Running", "Another process is already running. Please wait for it to finish.");
+    if (supervisor_->isRunning(QString(), "github repos")) {
+        QMessageBox::warning(this, "Process Running", "Your repositories are already being fetched. Please wait for it to finish.");
         return;
     }
     
-    buildProcess_ = new QProcess(this);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &MainWindow::onBrowseReposFinished);
-    connect(buildProcess_, &QProcess::readyReadStandardOutput, this, &MainWindow::onScriptOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError, this, &MainWindow::onScriptOutput);
+    ProcessJob *job = supervisor_->create(QString(), "github repos", "https://api.github.com/user/repos");
+    connect(job, &ProcessJob::finished, this, [this, job](int exitCode, QProcess::ExitStatus exitStatus) {
+        onBrowseReposFinished(exitCode, exitStatus, job->standardOutput());
+    });
+    connect(job, &ProcessJob::output, this, &MainWindow::onScriptOutput);
     
     buildProgress_->setVisible(true);
     buildProgress_->setRange(0, 0);
@@ -1882,17 +3782,12 @@ void MainWindow::browseGithubRepos() {
          << "-H" << "Accept: application/vnd.github.v3+json"
          << "https://api.github.com/user/repos?per_page=100&sort=updated";
     
-    buildProcess_->start("curl", args);
-    
-    if (!buildProcess_->waitForStarted()) {
-        QMessageBox::critical(this, "Failed", "Failed to fetch repositories. Make sure curl is installed.");
-        buildProgress_->setVisible(false);
-        buildProcess_->deleteLater();
-        buildProcess_ = nullptr;
-    }
+    instrumentProcess(job, "github list repos", "https://api.github.com/user/repos");
+    job->start("curl", args);
 }
 
 void MainWindow::createGithubRepo() {
+    TRACE_SCOPE("MainWindow::createGithubRepo", "github");
     if (!isGithubAuthenticated_) {
         QMessageBox::warning(this, "Not Authenticated", "Please authenticate with GitHub first.");
         return;
@@ -1921,18 +3816,16 @@ void MainWindow::createGithubRepo() {
     buildOutput_->append(QString("=== Creating GitHub repository: %1 ===").arg(repoName));
     buildOutput_->append("");
     
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "Process Running", "Another process is already running. Please wait for it to finish.");
+    if (supervisor_->isRunning(repoName, "github create")) {
+        QMessageBox::warning(this, "Process Running", "This repository is already being created. Please wait for it to finish.");
         return;
     }
     
-    buildProcess_ = new QProcess(this);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            [this, repoName](int exitCode, QProcess::ExitStatus exitStatus) {
-                onCreateRepoFinished(exitCode, exitStatus, repoName);
-            });
-    connect(buildProcess_, &QProcess::readyReadStandardOutput, this, &MainWindow::onScriptOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError, this, &MainWindow::onScriptOutput);
+    ProcessJob *job = supervisor_->create(repoName, "github create", "https://api.github.com/user/repos");
+    connect(job, &ProcessJob::finished, this, [this, job, repoName](int exitCode, QProcess::ExitStatus exitStatus) {
+        onCreateRepoFinished(exitCode, exitStatus, repoName, job->standardOutput());
+    });
+    connect(job, &ProcessJob::output, this, &MainWindow::onScriptOutput);
     
     buildProgress_->setVisible(true);
     buildProgress_->setRange(0, 0);
@@ -1957,22 +3850,14 @@ void MainWindow::createGithubRepo() {
          << "--data" << jsonData
          << "https://api.github.com/user/repos";
     
-    buildProcess_->start("curl", args);
-    
-    if (!buildProcess_->waitForStarted()) {
-        QMessageBox::critical(this, "Failed", "Failed to create repository. Make sure curl is installed.");
-        buildProgress_->setVisible(false);
-        buildProcess_->deleteLater();
-        buildProcess_ = nullptr;
-    }
+    instrumentProcess(job, "github create repo", repoName);
+    job->start("curl", args);
 }
 
-void MainWindow::onGithubAuthFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& token) {
-    buildProgress_->setVisible(false);
-    
+void MainWindow::onGithubAuthFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& token, const QByteArray& response) {
     if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
         // Parse the response to get username
-        QString output = buildProcess_->readAllStandardOutput();
+        QString output = QString::fromUtf8(response);
         
         // Simple JSON parsing to extract username
         QRegularExpression usernamePattern("\"login\"\\s*:\\s*\"([^\"]+)\"");
@@ -2001,16 +3886,11 @@ void MainWindow::onGithubAuthFinished(int exitCode, QProcess::ExitStatus exitSta
         buildOutput_->append(QString("\\n=== Authentication failed with exit code: %1 ===").arg(exitCode));
         QMessageBox::warning(this, "Authentication Failed", "Failed to authenticate with GitHub. Please check your token and internet connection.");
     }
-    
-    buildProcess_->deleteLater();
-    buildProcess_ = nullptr;
 }
 
-void MainWindow::onBrowseReposFinished(int exitCode, QProcess::ExitStatus exitStatus) {
-    buildProgress_->setVisible(false);
-    
+void MainWindow::onBrowseReposFinished(int exitCode, QProcess::ExitStatus exitStatus, const QByteArray& response) {
     if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
-        QString output = buildProcess_->readAllStandardOutput();
+        QString output = QString::fromUtf8(response);
         
         // Parse repository information (name, description, private status, language)
         QList<MainWindow::RepoInfo> repositories;
@@ -2080,16 +3960,11 @@ void MainWindow::onBrowseReposFinished(int exitCode, QProcess::ExitStatus exitSt
         buildOutput_->append(QString("\\n=== Failed to fetch repositories with exit code: %1 ===").arg(exitCode));
         QMessageBox::warning(this, "Failed", "Failed to fetch repositories from GitHub.");
     }
-    
-    buildProcess_->deleteLater();
-    buildProcess_ = nullptr;
 }
 
-void MainWindow::onCreateRepoFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& repoName) {
-    buildProgress_->setVisible(false);
-    
+void MainWindow::onCreateRepoFinished(int exitCode, QProcess::ExitStatus exitStatus, const QString& repoName, const QByteArray& response) {
     if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
-        QString output = buildProcess_->readAllStandardOutput();
+        QString output = QString::fromUtf8(response);
         
         // Check if creation was successful
         if (output.contains("\"full_name\"")) {
@@ -2116,12 +3991,10 @@ void MainWindow::onCreateRepoFinished(int exitCode, QProcess::ExitStatus exitSta
         buildOutput_->append(QString("\\n=== Repository creation failed with exit code: %1 ===").arg(exitCode));
         QMessageBox::warning(this, "Creation Failed", "Failed to create repository on GitHub.");
     }
-    
-    buildProcess_->deleteLater();
-    buildProcess_ = nullptr;
 }
 
 void MainWindow::startCloneProcess(const QString& repoUrl, const QString& repoName, const QString& clonePath) {
+    TRACE_SCOPE("MainWindow::startCloneProcess", "github");
     // Check if directory already exists
     if (QDir(clonePath).exists()) {
         int ret = QMessageBox::question(this, "Directory Exists", 
@@ -2138,32 +4011,61 @@ void MainWindow::startCloneProcess(const QString& repoUrl, const QString& repoNa
     buildOutput_->append(QString("Destination: %1").arg(clonePath));
     buildOutput_->append("");
     
-    if (buildProcess_ && buildProcess_->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "Process Running", "Another process is already running. Please wait for it to finish.");
+    if (supervisor_->isRunning(repoName, "clone")) {
+        QMessageBox::warning(this, "Process Running", "This repository is already being cloned. Please wait for it to finish.");
         return;
     }
     
-    buildProcess_ = new QProcess(this);
-    connect(buildProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            [this, repoName, clonePath](int exitCode, QProcess::ExitStatus exitStatus) {
-                onCloneFinished(exitCode, exitStatus, repoName, clonePath);
-            });
-    connect(buildProcess_, &QProcess::readyReadStandardOutput, this, &MainWindow::onScriptOutput);
-    connect(buildProcess_, &QProcess::readyReadStandardError, this, &MainWindow::onScriptOutput);
+    ProcessJob *job = supervisor_->create(repoName, "clone", repoUrl);
+    connect(job, &ProcessJob::finished, this, [this, repoName, clonePath](int exitCode, QProcess::ExitStatus exitStatus) {
+        onCloneFinished(exitCode, exitStatus, repoName, clonePath);
+    });
+    connect(job, &ProcessJob::output, this, &MainWindow::onScriptOutput);
     
     buildProgress_->setVisible(true);
     buildProgress_->setRange(0, 0); // Indeterminate progress
     
     // Start git clone
     QString baseDir = QFileInfo(clonePath).absolutePath();
-    buildProcess_->setWorkingDirectory(baseDir);
-    buildProcess_->start("git", QStringList() << "clone" << repoUrl << repoName);
-    
-    if (!buildProcess_->waitForStarted()) {
-        QMessageBox::critical(this, "Clone Failed", "Failed to start git clone process.");
-        buildProgress_->setVisible(false);
-        buildProcess_->deleteLater();
-        buildProcess_ = nullptr;
+    job->process()->setWorkingDirectory(baseDir);
+    instrumentProcess(job, "git clone", repoUrl, "clone");
+    job->start("git", QStringList() << "clone" << repoUrl << repoName);
+}
+
+void MainWindow::instrumentProcess(ProcessJob* job, const char* name, const QString& detail, const char* metric) {
+    // Child processes outlive the slot that started them, so their span is
+    // recorded when the process finishes rather than with TRACE_SCOPE.
+    // Only successful runs feed the latency histogram; failures are usually
+    // early aborts and would drag the percentiles down. The duration is the
+    // job's own, which stops with the child rather than after the finished
+    // handlers that were connected first.
+    uint64_t start = Tracer::now();
+    std::string detailText = detail.toStdString();
+    connect(job, &ProcessJob::finished, this,
+            [job, name, metric, start, detailText](int exitCode, QProcess::ExitStatus exitStatus) {
+                uint64_t duration = static_cast<uint64_t>(job->elapsedNs());
+                Tracer::instance().record(name, "process", start, duration, detailText);
+                if (metric && exitCode == 0 && exitStatus == QProcess::NormalExit) {
+                    MetricsRegistry::instance().record(metric, duration / 1000);
+                }
+            });
+}
+
+void MainWindow::exportTrace() {
+    QString path = QFileDialog::getSaveFileName(this, "Export Trace",
+                                                QDir::homePath() + "/cppm-trace.json",
+                                                "Chrome Trace (*.json)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    if (Tracer::instance().exportChromeTrace(path.toStdString())) {
+        QMessageBox::information(this, "Trace Exported",
+                                 QString("Wrote %1 trace events to %2\n\n"
+                                         "Open the file in chrome://tracing or https://ui.perfetto.dev")
+                                 .arg(Tracer::instance().eventCount()).arg(path));
+    } else {
+        QMessageBox::warning(this, "Export Failed", QString("Failed to write trace file: %1").arg(path));
     }
 }
 
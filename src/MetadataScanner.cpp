@@ -0,0 +1,396 @@
+#include "MetadataScanner.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define CPPM_HAVE_IO_URING 1
+#endif
+
+namespace {
+
+constexpr unsigned kRingEntries = 256;
+
+void readHeaderClassic(FileProbe& file) {
+    int fd = open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    ssize_t length = pread(fd, file.header, sizeof(file.header), 0);
+    file.headerLength = length > 0 ? static_cast<size_t>(length) : 0;
+    close(fd);
+}
+
+} // namespace
+
+#ifdef CPPM_HAVE_IO_URING
+
+// Minimal io_uring client on the raw system calls: one submission queue,
+// one completion queue, no SQ polling. Not thread-safe.
+class MetadataScanner::Ring {
+public:
+    ~Ring() {
+        if (sqes_) munmap(sqes_, sqesSize_);
+        if (cqRing_ && cqRing_ != sqRing_) munmap(cqRing_, cqRingSize_);
+        if (sqRing_) munmap(sqRing_, sqRingSize_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool init() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, kRingEntries, &params));
+        if (fd_ < 0) {
+            return false; // ENOSYS, or EPERM under seccomp and io_uring_disabled
+        }
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap) {
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        }
+        sqRing_ = mapRegion(sqRingSize_, IORING_OFF_SQ_RING);
+        cqRing_ = singleMap ? sqRing_ : mapRegion(cqRingSize_, IORING_OFF_CQ_RING);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mapRegion(sqesSize_, IORING_OFF_SQES));
+        if (!sqRing_ || !cqRing_ || !sqes_) {
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        entries_ = params.sq_entries;
+        localTail_ = *sqTail_;
+        return supportsOpcodes();
+    }
+
+    unsigned capacity() const { return entries_; }
+
+    io_uring_sqe* nextSqe() {
+        if (localTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= entries_) {
+            return nullptr;
+        }
+        io_uring_sqe* sqe = &sqes_[localTail_ & sqMask_];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++localTail_;
+        return sqe;
+    }
+
+    // Submits everything queued and waits until `completions` results arrived,
+    // handing each (user_data, res) to onResult
+    template <typename OnResult>
+    bool submitAndReap(unsigned completions, OnResult onResult) {
+        unsigned tail = *sqTail_;
+        unsigned toSubmit = localTail_ - tail;
+        for (; tail != localTail_; ++tail) {
+            sqArray_[tail & sqMask_] = tail & sqMask_;
+        }
+        __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+
+        unsigned reaped = 0;
+        while (reaped < completions) {
+            int submitted = static_cast<int>(syscall(__NR_io_uring_enter, fd_, toSubmit,
+                                                     completions - reaped, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (submitted < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            toSubmit -= std::min<unsigned>(toSubmit, static_cast<unsigned>(submitted));
+
+            unsigned head = *cqHead_;
+            unsigned cqTail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            for (; head != cqTail; ++head, ++reaped) {
+                const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                onResult(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        }
+        return true;
+    }
+
+private:
+    void* mapRegion(size_t size, off_t offset) {
+        void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return region == MAP_FAILED ? nullptr : region;
+    }
+
+    // STATX and OPENAT arrived in 5.6; older kernels keep the classic path
+    bool supportsOpcodes() {
+        const size_t size = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+        std::vector<unsigned char> buffer(size, 0);
+        io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+        if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, 256) < 0) {
+            return false;
+        }
+        for (int op : {IORING_OP_STATX, IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE}) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int fd_ = -1;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    size_t sqesSize_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned cqMask_ = 0;
+    unsigned entries_ = 0;
+    unsigned localTail_ = 0;
+};
+
+#else
+
+class MetadataScanner::Ring {
+public:
+    bool init() { return false; }
+};
+
+#endif // CPPM_HAVE_IO_URING
+
+MetadataScanner::MetadataScanner(Backend preferred) {
+    if (preferred == Backend::IoUring) {
+        ring_ = std::make_unique<Ring>();
+        if (!ring_->init()) {
+            ring_.reset();
+        }
+    }
+}
+
+MetadataScanner::~MetadataScanner() = default;
+
+MetadataScanner::Backend MetadataScanner::backend() const {
+    return ring_ ? Backend::IoUring : Backend::Classic;
+}
+
+void MetadataScanner::probe(std::vector<FileProbe>& files, const std::function<bool(const FileProbe&)>& wantHeader) {
+    TRACE_SCOPE("MetadataScanner::probe", "scan", ring_ ? "io_uring" : "classic");
+
+    // Where the classic path takes over: all of them without a ring, the
+    // rest of them once a submission to the ring fails
+    size_t classicFrom = 0;
+#ifdef CPPM_HAVE_IO_URING
+    if (ring_) {
+        // Three round trips per batch: every statx, then every openat, then a
+        // read hard-linked to its close so the descriptor is released even
+        // when the read fails
+        const size_t batch = ring_->capacity() / 2;
+        std::vector<struct statx> stats(batch);
+        std::vector<int> fds(batch);
+        std::vector<size_t> wanted;
+        classicFrom = files.size();
+        for (size_t begin = 0; begin < files.size(); begin += batch) {
+            size_t count = std::min(batch, files.size() - begin);
+
+            for (size_t i = 0; i < count; ++i) {
+                io_uring_sqe* sqe = ring_->nextSqe();
+                sqe->opcode = IORING_OP_STATX;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<uint64_t>(files[begin + i].path.c_str());
+                sqe->len = STATX_TYPE | STATX_MODE | STATX_SIZE;
+                sqe->off = reinterpret_cast<uint64_t>(&stats[i]);
+                sqe->user_data = i;
+            }
+            bool ok = ring_->submitAndReap(count, [&](uint64_t i, int res) {
+                FileProbe& file = files[begin + i];
+                file.exists = res == 0;
+                if (file.exists) {
+                    file.mode = stats[i].stx_mode;
+                    file.size = stats[i].stx_size;
+                }
+            });
+            if (!ok) {
+                classicFrom = begin;
+                break;
+            }
+
+            wanted.clear();
+            for (size_t i = 0; i < count; ++i) {
+                if (files[begin + i].exists && wantHeader(files[begin + i])) {
+                    wanted.push_back(i);
+                }
+            }
+            if (wanted.empty()) {
+                continue;
+            }
+            for (size_t i : wanted) {
+                io_uring_sqe* sqe = ring_->nextSqe();
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<uint64_t>(files[begin + i].path.c_str());
+                sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                sqe->user_data = i;
+            }
+            unsigned opened = 0;
+            std::fill(fds.begin(), fds.end(), -1);
+            ok = ring_->submitAndReap(static_cast<unsigned>(wanted.size()), [&](uint64_t i, int res) {
+                fds[i] = res;
+                opened += res >= 0;
+            });
+            if (!ok) {
+                // Nothing was read through these yet
+                for (size_t i : wanted) {
+                    if (fds[i] >= 0) {
+                        close(fds[i]);
+                    }
+                }
+                classicFrom = begin;
+                break;
+            }
+
+            for (size_t i : wanted) {
+                if (fds[i] < 0) {
+                    continue;
+                }
+                FileProbe& file = files[begin + i];
+                io_uring_sqe* read = ring_->nextSqe();
+                read->opcode = IORING_OP_READ;
+                read->fd = fds[i];
+                read->addr = reinterpret_cast<uint64_t>(file.header);
+                read->len = sizeof(file.header);
+                read->flags = IOSQE_IO_HARDLINK;
+                read->user_data = i;
+                io_uring_sqe* release = ring_->nextSqe();
+                release->opcode = IORING_OP_CLOSE;
+                release->fd = fds[i];
+                release->user_data = UINT64_MAX;
+            }
+            ok = ring_->submitAndReap(opened * 2, [&](uint64_t i, int res) {
+                if (i != UINT64_MAX && res > 0) {
+                    files[begin + i].headerLength = static_cast<size_t>(res);
+                }
+            });
+            if (!ok) {
+                // Closes may still be in flight, so the descriptors are left
+                // to them rather than risk closing one twice
+                classicFrom = begin;
+                break;
+            }
+        }
+        if (classicFrom == files.size()) {
+            return;
+        }
+        // A ring that failed once is not trusted with later probes either
+        ring_.reset();
+    }
+#endif
+
+    for (size_t i = classicFrom; i < files.size(); ++i) {
+        FileProbe& file = files[i];
+        struct stat st;
+        file.exists = stat(file.path.c_str(), &st) == 0;
+        if (!file.exists) {
+            continue;
+        }
+        file.mode = st.st_mode;
+        file.size = static_cast<uint64_t>(st.st_size);
+        if (wantHeader(file)) {
+            readHeaderClassic(file);
+        }
+    }
+}
+
+void MetadataScanner::benchmark(const std::string& root, std::ostream& out) {
+    std::vector<std::string> paths;
+    std::vector<std::string> pending = {root};
+    while (!pending.empty()) {
+        std::string directory = std::move(pending.back());
+        pending.pop_back();
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) {
+            continue;
+        }
+        while (dirent* entry = readdir(dir)) {
+            if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            std::string child = directory + "/" + entry->d_name;
+            if (entry->d_type == DT_DIR) {
+                pending.push_back(std::move(child));
+            } else if (entry->d_type == DT_REG) {
+                paths.push_back(std::move(child));
+            }
+        }
+        closedir(dir);
+    }
+
+    // Drops file data from the page cache; inodes and dentries stay cached,
+    // which only dropping caches system-wide as root would undo
+    auto evict = [&paths] {
+        for (const auto& path : paths) {
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                close(fd);
+            }
+        }
+    };
+    auto timeScan = [&paths](MetadataScanner& scanner) {
+        std::vector<FileProbe> files(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            files[i].path = paths[i];
+        }
+        auto start = std::chrono::steady_clock::now();
+        scanner.probe(files, [](const FileProbe& file) { return S_ISREG(file.mode); });
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    out << "Scanning " << paths.size() << " files below " << root << " (statx + 64-byte header read)\n";
+    out << std::left << std::setw(10) << "backend" << std::right << std::setw(12) << "cold ms"
+        << std::setw(12) << "warm ms" << "\n";
+
+    double classic[2] = {0, 0};
+    for (Backend backend : {Backend::Classic, Backend::IoUring}) {
+        MetadataScanner scanner(backend);
+        if (scanner.backend() != backend) {
+            out << "io_uring   unavailable on this kernel or sandbox\n";
+            break;
+        }
+        evict();
+        double cold = timeScan(scanner);
+        double warm = timeScan(scanner);
+        for (int run = 0; run < 2; ++run) {
+            warm = std::min(warm, timeScan(scanner));
+        }
+        out << std::left << std::setw(10) << (backend == Backend::Classic ? "classic" : "io_uring") << std::right
+            << std::fixed << std::setprecision(1) << std::setw(12) << cold << std::setw(12) << warm;
+        if (backend == Backend::Classic) {
+            classic[0] = cold;
+            classic[1] = warm;
+        } else {
+            out << "   speedup " << std::setprecision(2) << classic[0] / cold << "x cold, "
+                << classic[1] / warm << "x warm";
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,166 @@
+#include "Metrics.h"
+#include "Trace.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<int>(value);
+    }
+    int magnitude = 63 - __builtin_clzll(value);
+    if (magnitude > kMaxMagnitude) {
+        return kBucketCount - 1;
+    }
+    int shift = magnitude - kSubBucketBits;
+    int subBucket = static_cast<int>(value >> shift) - kSubBuckets;
+    return kSubBuckets + shift * kSubBuckets + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < kSubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = (index - kSubBuckets) / kSubBuckets;
+    uint64_t subBucket = static_cast<uint64_t>((index - kSubBuckets) % kSubBuckets + kSubBuckets);
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    ++buckets_[bucketIndex(micros)];
+    ++count_;
+    sum_ += micros;
+    min_ = std::min(min_, micros);
+    max_ = std::max(max_, micros);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < kBucketCount; ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::reset() {
+    *this = LatencyHistogram();
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(count_) + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, count_));
+
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            // Never report more than was actually observed
+            return std::min(bucketUpperBound(i), max_);
+        }
+    }
+    return max_;
+}
+
+std::string LatencyHistogram::serialize() const {
+    // count min max sum, followed by sparse index:count pairs
+    std::ostringstream out;
+    out << count_ << ' ' << min() << ' ' << max_ << ' ' << sum_;
+    for (int i = 0; i < kBucketCount; ++i) {
+        if (buckets_[i] != 0) {
+            out << ' ' << i << ':' << buckets_[i];
+        }
+    }
+    return out.str();
+}
+
+bool LatencyHistogram::deserialize(const std::string& text) {
+    LatencyHistogram parsed;
+    std::istringstream in(text);
+    if (!(in >> parsed.count_ >> parsed.min_ >> parsed.max_ >> parsed.sum_)) {
+        return false;
+    }
+
+    std::string pair;
+    uint64_t total = 0;
+    while (in >> pair) {
+        size_t colon = pair.find(':');
+        if (colon == std::string::npos) {
+            return false;
+        }
+        int index = std::stoi(pair.substr(0, colon));
+        if (index < 0 || index >= kBucketCount) {
+            return false;
+        }
+        parsed.buckets_[index] = std::stoull(pair.substr(colon + 1));
+        total += parsed.buckets_[index];
+    }
+
+    if (total != parsed.count_) {
+        return false;
+    }
+    if (parsed.count_ == 0) {
+        parsed.min_ = UINT64_MAX;
+    }
+    *this = parsed;
+    return true;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void MetricsRegistry::record(const std::string& name, uint64_t micros) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    histograms_[name].record(micros);
+}
+
+std::map<std::string, LatencyHistogram> MetricsRegistry::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return histograms_;
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    histograms_.clear();
+}
+
+void MetricsRegistry::loadFromFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    std::string line;
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (std::getline(file, line)) {
+        size_t space = line.find(' ');
+        if (space == std::string::npos) {
+            continue;
+        }
+        LatencyHistogram histogram;
+        try {
+            if (histogram.deserialize(line.substr(space + 1))) {
+                histograms_[line.substr(0, space)].merge(histogram);
+            }
+        } catch (const std::exception&) {
+            // Skip corrupted lines
+        }
+    }
+}
+
+void MetricsRegistry::saveToFile(const std::string& filePath) const {
+    std::ofstream file(filePath);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& pair : histograms_) {
+        file << pair.first << ' ' << pair.second.serialize() << std::endl;
+    }
+}
+
+ScopedLatency::ScopedLatency(const char* name) : name_(name), start_(Tracer::now()) {
+}
+
+ScopedLatency::~ScopedLatency() {
+    MetricsRegistry::instance().record(name_, (Tracer::now() - start_) / 1000);
+}
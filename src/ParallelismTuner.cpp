@@ -0,0 +1,218 @@
+#include "ParallelismTuner.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+
+std::string hostName() {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0') {
+        return "localhost";
+    }
+    return name;
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+} // namespace
+
+ParallelismTuner::ParallelismTuner(const std::string& stateFile)
+    : stateFile_(stateFile), host_(hostName()) {
+}
+
+bool ParallelismTuner::load() {
+    otherHosts_.clear();
+    candidates_.clear();
+    samples_.clear();
+    tunedJobs_ = 0;
+    std::ifstream in(stateFile_);
+    if (!in.is_open()) {
+        return false;
+    }
+    // "<host> tuning <jobs>...", "<host> sample <jobs> <wall> <cpu>", "<host> tuned <jobs>"
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string host;
+        std::string kind;
+        if (!(fields >> host >> kind)) {
+            continue;
+        }
+        if (host != host_) {
+            otherHosts_.push_back(line);
+        } else if (kind == "tuning") {
+            int jobs;
+            while (fields >> jobs) {
+                candidates_.push_back(jobs);
+            }
+        } else if (kind == "sample") {
+            ParallelismSample sample;
+            if (fields >> sample.jobs >> sample.wallSeconds >> sample.cpuSeconds) {
+                samples_.push_back(sample);
+            }
+        } else if (kind == "tuned") {
+            fields >> tunedJobs_;
+        }
+    }
+    return true;
+}
+
+bool ParallelismTuner::save() const {
+    std::string tmp = stateFile_ + ".tmp";
+    std::ofstream out(tmp);
+    if (!out.is_open()) {
+        return false;
+    }
+    for (const auto& line : otherHosts_) {
+        out << line << "\n";
+    }
+    if (!candidates_.empty()) {
+        out << host_ << " tuning";
+        for (int jobs : candidates_) {
+            out << " " << jobs;
+        }
+        out << "\n";
+    }
+    for (const auto& sample : samples_) {
+        out << host_ << " sample " << sample.jobs << " " << sample.wallSeconds << " " << sample.cpuSeconds << "\n";
+    }
+    if (tunedJobs_ > 0) {
+        out << host_ << " tuned " << tunedJobs_ << "\n";
+    }
+    out.close();
+    return out.good() && std::rename(tmp.c_str(), stateFile_.c_str()) == 0;
+}
+
+void ParallelismTuner::startTuning(int cores, int memoryJobs) {
+    cores = std::max(1, cores);
+    int ceiling = std::max(1, memoryJobs);
+    // Below the core count leaves room for linking and the desktop; above it
+    // hides I/O waits
+    candidates_.clear();
+    for (int jobs : {cores / 2, cores * 3 / 4, cores, cores * 3 / 2, cores * 2}) {
+        candidates_.push_back(std::min(std::max(1, jobs), ceiling));
+    }
+    std::sort(candidates_.begin(), candidates_.end());
+    candidates_.erase(std::unique(candidates_.begin(), candidates_.end()), candidates_.end());
+    samples_.clear();
+}
+
+void ParallelismTuner::stopTuning() {
+    candidates_.clear();
+}
+
+void ParallelismTuner::forget() {
+    candidates_.clear();
+    samples_.clear();
+    tunedJobs_ = 0;
+}
+
+int ParallelismTuner::nextJobs(int memoryJobs) const {
+    int ceiling = std::max(1, memoryJobs);
+    if (isTuning()) {
+        // The candidate with the fewest builds so far, smallest first; one
+        // capped by memory would not be a trial, so only those that fit count
+        int next = 0;
+        int fewest = -1;
+        for (const auto& candidate : candidates()) {
+            if (isTrial(candidate.jobs) && candidate.jobs <= ceiling && (fewest < 0 || candidate.builds < fewest)) {
+                fewest = candidate.builds;
+                next = candidate.jobs;
+            }
+        }
+        return next > 0 ? next : ceiling;
+    }
+    return tunedJobs_ > 0 ? std::min(tunedJobs_, ceiling) : ceiling;
+}
+
+bool ParallelismTuner::isTrial(int jobs) const {
+    return std::find(candidates_.begin(), candidates_.end(), jobs) != candidates_.end();
+}
+
+bool ParallelismTuner::skipCandidatesAbove(int memoryJobs) {
+    int ceiling = std::max(1, memoryJobs);
+    auto above = std::remove_if(candidates_.begin(), candidates_.end(), [ceiling](int jobs) { return jobs > ceiling; });
+    if (above == candidates_.end()) {
+        return false;
+    }
+    candidates_.erase(above, candidates_.end());
+    if (candidates_.empty()) {
+        candidates_.push_back(ceiling);
+    }
+    completeIfSampled();
+    return true;
+}
+
+bool ParallelismTuner::record(const ParallelismSample& sample) {
+    if (!isTrial(sample.jobs) || sample.wallSeconds < kMinWallSeconds || sample.cpuSeconds <= 0.0) {
+        return false;
+    }
+    samples_.push_back(sample);
+    return completeIfSampled();
+}
+
+bool ParallelismTuner::completeIfSampled() {
+    for (const auto& candidate : candidates()) {
+        if (isTrial(candidate.jobs) && candidate.builds < kBuildsPerCandidate) {
+            return false;
+        }
+    }
+    tunedJobs_ = settle();
+    candidates_.clear();
+    return true;
+}
+
+std::vector<ParallelismCandidate> ParallelismTuner::candidates() const {
+    // While tuning the candidates are fixed; afterwards they are whatever was sampled
+    std::vector<int> jobsList = candidates_;
+    for (const auto& sample : samples_) {
+        if (std::find(jobsList.begin(), jobsList.end(), sample.jobs) == jobsList.end()) {
+            jobsList.push_back(sample.jobs);
+        }
+    }
+    std::sort(jobsList.begin(), jobsList.end());
+
+    std::vector<ParallelismCandidate> result;
+    for (int jobs : jobsList) {
+        ParallelismCandidate candidate;
+        candidate.jobs = jobs;
+        std::vector<double> speedups;
+        std::vector<double> efficiencies;
+        for (const auto& sample : samples_) {
+            if (sample.jobs == jobs) {
+                speedups.push_back(sample.speedup());
+                efficiencies.push_back(sample.efficiency());
+            }
+        }
+        candidate.builds = static_cast<int>(speedups.size());
+        candidate.medianSpeedup = median(speedups);
+        candidate.medianEfficiency = median(efficiencies);
+        result.push_back(candidate);
+    }
+    return result;
+}
+
+int ParallelismTuner::settle() const {
+    auto all = candidates();
+    double best = 0.0;
+    for (const auto& candidate : all) {
+        best = std::max(best, candidate.medianSpeedup);
+    }
+    // Extra jobs that gain less than 5% only cost memory and responsiveness
+    for (const auto& candidate : all) {
+        if (candidate.builds > 0 && candidate.medianSpeedup >= best * 0.95) {
+            return candidate.jobs;
+        }
+    }
+    return all.empty() ? 0 : all.back().jobs;
+}
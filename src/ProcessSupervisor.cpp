@@ -0,0 +1,644 @@
+#include "ProcessSupervisor.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unordered_set>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+namespace {
+
+const int kMaxLogCharacters = 1 << 20;
+const int kFinishedJobsKept = 30;
+const int kKillDelayMs = 3000;
+// How often the helper looks for new processes in the child's group
+const long kSampleIntervalNs = 25 * 1000 * 1000;
+
+// Actions whose jobs honour the resource limits
+bool isConfinedAction(const QString& action) {
+    return action == "build" || action == "script";
+}
+
+volatile sig_atomic_t forwardedSignal = 0;
+
+void rememberSignal(int signal) {
+    // The child is in the same process group and got the signal too; the
+    // helper only has to outlive it to report its usage
+    forwardedSignal = signal;
+}
+
+double seconds(const timeval& time) {
+    return static_cast<double>(time.tv_sec) + time.tv_usec / 1e6;
+}
+
+#ifdef __linux__
+// Process group and resident pages from /proc/<pid>/stat
+bool readProcessStat(pid_t pid, pid_t& group, long& residentPages) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%d/stat", static_cast<int>(pid));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char buffer[1024];
+    ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (length <= 0) {
+        return false;
+    }
+    buffer[length] = '\0';
+    // The command name may contain spaces and parentheses; the fields after
+    // it are "state ppid pgrp ...", with rss the 22nd
+    const char* field = std::strrchr(buffer, ')');
+    if (!field) {
+        return false;
+    }
+    long values[22] = {};
+    int count = 0;
+    for (++field; count < 22 && *field; ++count) {
+        while (*field == ' ') ++field;
+        values[count] = std::strtol(field, nullptr, 10);
+        while (*field && *field != ' ') ++field;
+    }
+    if (count < 22) {
+        return false;
+    }
+    group = static_cast<pid_t>(values[2]);
+    residentPages = values[21];
+    return true;
+}
+
+// Everything in the helper's process group: the child and whatever it
+// started, unless that moved to a group of its own
+class TreeSampler {
+public:
+    explicit TreeSampler(pid_t group) : group_(group), pageKb_(sysconf(_SC_PAGESIZE) / 1024) {}
+
+    void sample() {
+        DIR* proc = opendir("/proc");
+        if (!proc) {
+            return;
+        }
+        std::unordered_set<pid_t> alive;
+        std::unordered_set<pid_t> seen;
+        long residentKb = 0;
+        while (dirent* entry = readdir(proc)) {
+            if (!std::isdigit(static_cast<unsigned char>(entry->d_name[0]))) {
+                continue;
+            }
+            pid_t pid = static_cast<pid_t>(std::atol(entry->d_name));
+            // Processes of other groups are read once, members every time;
+            // a pid that went away is forgotten, so its reuse is read again
+            if (pid == group_) {
+                continue;
+            }
+            seen.insert(pid);
+            bool member = members_.count(pid) > 0;
+            if (!member && examined_.count(pid) > 0) {
+                continue;
+            }
+            pid_t group;
+            long pages;
+            if (!readProcessStat(pid, group, pages) || group != group_) {
+                continue;
+            }
+            if (!member) {
+                ++processes_;
+            }
+            alive.insert(pid);
+            residentKb += pages * pageKb_;
+        }
+        closedir(proc);
+        members_.swap(alive);
+        examined_.swap(seen);
+        peakResidentKb_ = std::max(peakResidentKb_, residentKb);
+    }
+
+    long processes() const { return processes_; }
+    long peakResidentKb() const { return peakResidentKb_; }
+
+private:
+    pid_t group_;
+    long pageKb_;
+    std::unordered_set<pid_t> examined_; // Every pid in the last scan
+    std::unordered_set<pid_t> members_; // As of the last sample
+    long processes_ = 0;
+    long peakResidentKb_ = 0;
+};
+
+struct IoCounters {
+    unsigned long long readChars = 0;
+    unsigned long long writtenChars = 0;
+    unsigned long long readBytes = 0;
+    unsigned long long writeBytes = 0;
+};
+
+bool readIoCounters(const char* path, IoCounters& io) {
+    FILE* file = std::fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    char key[64];
+    unsigned long long value;
+    int found = 0;
+    while (std::fscanf(file, "%63[^:]: %llu ", key, &value) == 2) {
+        if (std::strcmp(key, "rchar") == 0) io.readChars = value, ++found;
+        else if (std::strcmp(key, "wchar") == 0) io.writtenChars = value, ++found;
+        else if (std::strcmp(key, "read_bytes") == 0) io.readBytes = value, ++found;
+        else if (std::strcmp(key, "write_bytes") == 0) io.writeBytes = value, ++found;
+    }
+    std::fclose(file);
+    return found == 4;
+}
+
+// A process's io file counts its own I/O plus that of every child it
+// reaped; its main thread's counts only its own. The difference is what
+// the reaped tree did, without the helper reading /proc.
+bool readReapedIo(IoCounters& io) {
+    IoCounters process;
+    IoCounters thread;
+    char threadPath[64];
+    std::snprintf(threadPath, sizeof(threadPath), "/proc/self/task/%d/io", static_cast<int>(getpid()));
+    if (!readIoCounters("/proc/self/io", process) || !readIoCounters(threadPath, thread)) {
+        return false;
+    }
+    io.readChars = process.readChars - thread.readChars;
+    io.writtenChars = process.writtenChars - thread.writtenChars;
+    io.readBytes = process.readBytes - thread.readBytes;
+    io.writeBytes = process.writeBytes - thread.writeBytes;
+    return true;
+}
+#endif
+
+ProcessUsage readUsageFile(const QString& path) {
+    ProcessUsage usage;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return usage;
+    }
+    while (!file.atEnd()) {
+        QList<QByteArray> fields = file.readLine().trimmed().split(' ');
+        if (fields.size() != 2) {
+            continue;
+        }
+        const QByteArray& key = fields[0];
+        const QByteArray& value = fields[1];
+        if (key == "user") usage.userSeconds = value.toDouble();
+        else if (key == "system") usage.systemSeconds = value.toDouble();
+        else if (key == "maxrss") usage.maxRssKb = value.toLong();
+        else if (key == "majflt") usage.majorFaults = value.toLong();
+        else if (key == "inblock") usage.blockInputs = value.toLong();
+        else if (key == "oublock") usage.blockOutputs = value.toLong();
+        else if (key == "nvcsw") usage.voluntarySwitches = value.toLong();
+        else if (key == "nivcsw") usage.involuntarySwitches = value.toLong();
+        else if (key == "processes") usage.processes = value.toLong();
+        else if (key == "treerss") usage.peakTreeRssKb = value.toLong();
+        else if (key == "rchar") usage.readChars = value.toULongLong();
+        else if (key == "wchar") usage.writtenChars = value.toULongLong();
+        else if (key == "readbytes") usage.storageReadBytes = value.toULongLong();
+        else if (key == "writebytes") usage.storageWriteBytes = value.toULongLong();
+        else if (key.startsWith("cgroup.")) {
+            usage.cgroup.valid = true;
+            if (key == "cgroup.cpu") usage.cgroup.cpuUsec = value.toULongLong();
+            else if (key == "cgroup.peak") usage.cgroup.memoryPeak = value.toULongLong();
+            else if (key == "cgroup.read") usage.cgroup.ioReadBytes = value.toULongLong();
+            else if (key == "cgroup.write") usage.cgroup.ioWriteBytes = value.toULongLong();
+            continue;
+        }
+        else continue;
+        usage.valid = true;
+    }
+    return usage;
+}
+
+// Private to this process (mode 0700), so no other user can plant or read
+// the helpers' usage files; removed on exit
+QString usageDirectory() {
+    static QTemporaryDir directory([] {
+        const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+        QString base = runtime && *runtime && QDir(QString::fromLocal8Bit(runtime)).exists()
+                           ? QString::fromLocal8Bit(runtime)
+                           : QDir::tempPath();
+        return base + "/cppm-XXXXXX";
+    }());
+    // The helper still refuses to follow or reuse an existing file there
+    return directory.isValid() ? directory.path() : QDir::tempPath();
+}
+
+} // namespace
+
+ProcessJob::ProcessJob(quint64 id, const QString& workspace, const QString& action, const QString& description,
+                       QObject* parent)
+    : QObject(parent), id_(id), workspace_(workspace), action_(action), description_(description),
+      process_(new QProcess(this)) {
+    connect(process_, &QProcess::readyReadStandardOutput, this, [this]() { readOutput(false); });
+    connect(process_, &QProcess::readyReadStandardError, this, [this]() { readOutput(true); });
+    connect(process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &ProcessJob::onProcessFinished);
+    connect(process_, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        // finished is not emitted for a child that never ran
+        if (error == QProcess::FailedToStart) {
+            finishedNs_ = timer_.isValid() ? timer_.nsecsElapsed() : 0;
+            state_ = State::Failed;
+            QFile::remove(usageFile_);
+            releaseCgroup();
+            emit stateChanged();
+        }
+    });
+}
+
+qint64 ProcessJob::elapsedNs() const {
+    if (finishedNs_ >= 0) {
+        return finishedNs_;
+    }
+    return timer_.isValid() ? timer_.nsecsElapsed() : 0;
+}
+
+void ProcessJob::start(const QString& program, const QStringList& arguments) {
+    QString name = QString("cppm-%1-%2").arg(QCoreApplication::applicationPid()).arg(id_);
+    usageFile_ = usageDirectory() + "/" + name + ".usage";
+    QString helper = QCoreApplication::applicationFilePath();
+    QStringList helperArguments;
+    helperArguments << "--exec-supervised" << usageFile_;
+
+    QString launcher = helper;
+    QStringList launcherArguments;
+    if (limits_.enabled) {
+        // Only now: without limits cppm leaves its own cgroup alone
+        switch (Cgroup::prepare()) {
+        case Cgroup::Method::SystemdScope:
+            // systemd-run creates the scope and then execs the helper in
+            // place, so the pid QProcess knows stays the one to signal
+            launcher = "systemd-run";
+            launcherArguments << "--user" << "--scope" << "--quiet" << "--collect" << "--unit=" + name
+                              << "-p" << QString("CPUWeight=%1").arg(limits_.cpuWeight)
+                              << "-p" << QString("IOWeight=%1").arg(limits_.ioWeight);
+            if (limits_.memoryMaxMb > 0) {
+                launcherArguments << "-p" << QString("MemoryMax=%1M").arg(limits_.memoryMaxMb);
+            }
+            launcherArguments << "--" << helper;
+            helperArguments << "--scope";
+            scopeName_ = name.toStdString() + ".scope";
+            confined_ = true;
+            break;
+        case Cgroup::Method::Delegated:
+            cgroupPath_ = Cgroup::createJobGroup(name.toStdString(), limits_);
+            if (!cgroupPath_.empty()) {
+                helperArguments << "--cgroup" << QString::fromStdString(cgroupPath_);
+                confined_ = true;
+            }
+            break;
+        case Cgroup::Method::None:
+            break;
+        }
+    }
+    helperArguments << program << arguments;
+    launcherArguments << helperArguments;
+
+    state_ = State::Running;
+    timer_.start();
+    process_->start(launcher, launcherArguments);
+    emit stateChanged();
+}
+
+CgroupUsage ProcessJob::cgroupUsage() {
+    CgroupUsage usage;
+    if (!confined_) {
+        return usage;
+    }
+    if (cgroupPath_.empty() && state_ == State::Running && process_->processId() > 0) {
+        // Until systemd-run has moved itself, the child is still in ours
+        std::string path = Cgroup::pathOf(static_cast<pid_t>(process_->processId()));
+        std::string suffix = "/" + scopeName_;
+        if (path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            cgroupPath_ = path;
+        }
+    }
+    Cgroup::readUsage(cgroupPath_, usage);
+    return usage;
+}
+
+void ProcessJob::releaseCgroup() {
+    // systemd collects its scopes; delegated groups are ours to remove
+    if (confined_ && scopeName_.empty() && !cgroupPath_.empty()) {
+        Cgroup::removeJobGroup(cgroupPath_);
+    }
+}
+
+void ProcessJob::signalGroup(int signal) {
+    qint64 pid = process_->processId();
+    if (pid > 0) {
+        // The helper leads its own process group
+        ::kill(-static_cast<pid_t>(pid), signal);
+    }
+}
+
+void ProcessJob::cancel() {
+    if (!isActive() || cancelRequested_) {
+        return;
+    }
+    cancelRequested_ = true;
+    signalGroup(SIGTERM);
+    QTimer::singleShot(kKillDelayMs, this, [this]() {
+        if (isActive()) {
+            signalGroup(SIGKILL);
+        }
+    });
+}
+
+void ProcessJob::readOutput(bool isError) {
+    QByteArray data = isError ? process_->readAllStandardError() : process_->readAllStandardOutput();
+    if (data.isEmpty()) {
+        return;
+    }
+    if (!isError) {
+        standardOutput_ += data;
+    }
+    QString text = QString::fromLocal8Bit(data);
+    log_ += text;
+    if (log_.size() > kMaxLogCharacters) {
+        log_.remove(0, log_.size() - kMaxLogCharacters);
+    }
+    emit output(text, isError);
+}
+
+void ProcessJob::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus) {
+    readOutput(false);
+    readOutput(true);
+    finishedNs_ = timer_.nsecsElapsed();
+    exitCode_ = exitCode;
+    usage_ = readUsageFile(usageFile_);
+    QFile::remove(usageFile_);
+    releaseCgroup();
+
+    if (cancelRequested_) {
+        state_ = State::Cancelled;
+    } else if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+        state_ = State::Finished;
+    } else {
+        state_ = State::Failed;
+    }
+    emit stateChanged();
+    emit finished(exitCode, exitStatus);
+}
+
+ProcessSupervisor::ProcessSupervisor(QObject* parent) : QObject(parent) {
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+    // Handlers belong to a window that is already being torn down
+    for (ProcessJob* job : jobs_) {
+        job->disconnect();
+        job->process()->disconnect();
+        if (job->isActive()) {
+            job->signalGroup(SIGKILL);
+            job->process()->waitForFinished(1000);
+            QFile::remove(job->usageFile_);
+            job->releaseCgroup();
+        }
+    }
+}
+
+ProcessJob* ProcessSupervisor::create(const QString& workspace, const QString& action, const QString& description) {
+    ProcessJob* job = new ProcessJob(nextId_++, workspace, action, description, this);
+    if (isConfinedAction(action)) {
+        job->limits_ = limits_;
+    }
+    connect(job, &ProcessJob::stateChanged, this, [this]() {
+        pruneFinished();
+        emit jobsChanged();
+    });
+    jobs_.append(job);
+    emit jobsChanged();
+    return job;
+}
+
+bool ProcessSupervisor::isRunning(const QString& workspace, const QString& action) const {
+    for (const ProcessJob* job : jobs_) {
+        if (job->isActive() && job->workspace() == workspace && job->action() == action) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ProcessSupervisor::isRunning(const QString& workspace, const QString& action, const QString& scope) const {
+    for (const ProcessJob* job : jobs_) {
+        if (job->isActive() && job->workspace() == workspace && job->action() == action &&
+            (job->scope().isEmpty() || job->scope() == scope)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ProcessSupervisor::cancelAll() {
+    for (ProcessJob* job : jobs_) {
+        job->cancel();
+    }
+}
+
+bool ProcessSupervisor::waitForAll(int msecs) {
+    QElapsedTimer timer;
+    timer.start();
+    // Finished handlers may start or prune jobs, so iterate over a copy
+    const QList<ProcessJob*> jobs = jobs_;
+    for (ProcessJob* job : jobs) {
+        if (!jobs_.contains(job) || !job->isActive()) {
+            continue;
+        }
+        int remaining = static_cast<int>(qMax<qint64>(0, msecs - timer.elapsed()));
+        job->process()->waitForFinished(remaining);
+    }
+    for (const ProcessJob* job : jobs_) {
+        if (job->isActive()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ProcessSupervisor::pruneFinished() {
+    int finished = 0;
+    for (const ProcessJob* job : jobs_) {
+        if (!job->isActive()) {
+            ++finished;
+        }
+    }
+    // Oldest first; deleteLater lets a finished handler still on the stack
+    // keep using its job
+    for (int i = 0; i < jobs_.size() && finished > kFinishedJobsKept;) {
+        ProcessJob* job = jobs_[i];
+        if (job->isActive()) {
+            ++i;
+            continue;
+        }
+        jobs_.removeAt(i);
+        job->deleteLater();
+        --finished;
+    }
+}
+
+int ProcessSupervisor::execSupervised(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: cppm --exec-supervised <usage file> [--cgroup <dir> | --scope] <program> [arguments...]\n");
+        return 2;
+    }
+    const char* usagePath = argv[0];
+    char** command = argv + 1;
+    std::string cgroupPath;
+    if (argc >= 4 && std::strcmp(argv[1], "--cgroup") == 0) {
+        // Moving first means everything forked below is accounted there
+        if (Cgroup::enter(argv[2])) {
+            cgroupPath = argv[2];
+        } else {
+            std::fprintf(stderr, "cppm: cannot enter cgroup %s, running without resource limits\n", argv[2]);
+        }
+        command = argv + 3;
+    } else if (argc >= 3 && std::strcmp(argv[1], "--scope") == 0) {
+        cgroupPath = Cgroup::pathOf(getpid());
+        command = argv + 2;
+    }
+
+    // A group of our own, so the supervisor can signal the whole tree
+    setpgid(0, 0);
+#ifdef __linux__
+    // Descendants orphaned while the child runs are reparented to us rather
+    // than to init, so their usage is reaped into ours
+    prctl(PR_SET_CHILD_SUBREAPER, 1);
+#endif
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = rememberSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGHUP, &action, nullptr);
+
+    // Blocked, a child's exit waits for sigtimedwait below instead of
+    // being lost between a reap and the next sleep
+    sigset_t childExits;
+    sigset_t previousMask;
+    sigemptyset(&childExits);
+    sigaddset(&childExits, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &childExits, &previousMask);
+
+    pid_t child = fork();
+    if (child < 0) {
+        std::perror("cppm: fork");
+        return 127;
+    }
+    if (child == 0) {
+        // Caught signals revert to their defaults across exec; the mask does not
+        sigprocmask(SIG_SETMASK, &previousMask, nullptr);
+        execvp(command[0], command);
+        std::fprintf(stderr, "cppm: cannot run %s: %s\n", command[0], std::strerror(errno));
+        _exit(127);
+    }
+
+    int status = 0;
+#ifdef __linux__
+    // Reap the child and the orphans that ended, and sample the group in
+    // between. Orphans still running when the child exits are left alone:
+    // a daemon it started must not hold up the job.
+    TreeSampler tree(getpid());
+    for (bool exited = false; !exited;) {
+        pid_t pid;
+        int reaped;
+        while ((pid = waitpid(-1, &reaped, WNOHANG)) > 0) {
+            if (pid == child) {
+                status = reaped;
+                exited = true;
+            }
+        }
+        if (exited) {
+            break;
+        }
+        if (pid < 0 && errno != EINTR) {
+            std::perror("cppm: waitpid");
+            return 127;
+        }
+        tree.sample();
+        struct timespec interval = {0, kSampleIntervalNs};
+        sigtimedwait(&childExits, nullptr, &interval);
+    }
+#else
+    // Without /proc or a subreaper there is only the child to wait for
+    while (waitpid(child, &status, 0) < 0) {
+        if (errno != EINTR) {
+            std::perror("cppm: waitpid");
+            return 127;
+        }
+    }
+#endif
+
+    // Everything reaped above, each with the descendants it reaped itself
+    struct rusage usage;
+    std::memset(&usage, 0, sizeof(usage));
+    getrusage(RUSAGE_CHILDREN, &usage);
+#ifdef __APPLE__
+    // Bytes there, kilobytes on Linux
+    usage.ru_maxrss /= 1024;
+#endif
+
+    // Exclusive and without following links: the file is created here, never reused
+    int usageFd = open(usagePath, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (FILE* out = usageFd >= 0 ? fdopen(usageFd, "w") : nullptr) {
+        std::fprintf(out, "user %.6f\nsystem %.6f\nmaxrss %ld\nmajflt %ld\ninblock %ld\noublock %ld\nnvcsw %ld\nnivcsw %ld\n",
+                     seconds(usage.ru_utime), seconds(usage.ru_stime), usage.ru_maxrss, usage.ru_majflt,
+                     usage.ru_inblock, usage.ru_oublock, usage.ru_nvcsw, usage.ru_nivcsw);
+#ifdef __linux__
+        std::fprintf(out, "processes %ld\ntreerss %ld\n", tree.processes(), tree.peakResidentKb());
+        IoCounters io;
+        if (readReapedIo(io)) {
+            std::fprintf(out, "rchar %llu\nwchar %llu\nreadbytes %llu\nwritebytes %llu\n",
+                         io.readChars, io.writtenChars, io.readBytes, io.writeBytes);
+        }
+#else
+        // Only what rusage has: the largest process for the tree, and
+        // blocks for the disk
+        std::fprintf(out, "treerss %ld\nreadbytes %llu\nwritebytes %llu\n", usage.ru_maxrss,
+                     static_cast<unsigned long long>(usage.ru_inblock) * 512,
+                     static_cast<unsigned long long>(usage.ru_oublock) * 512);
+#endif
+        // The helper is still in the group, so it has not been removed yet
+        CgroupUsage group;
+        if (!cgroupPath.empty() && Cgroup::readUsage(cgroupPath, group)) {
+            std::fprintf(out, "cgroup.cpu %llu\ncgroup.peak %llu\ncgroup.read %llu\ncgroup.write %llu\n",
+                         static_cast<unsigned long long>(group.cpuUsec),
+                         static_cast<unsigned long long>(group.memoryPeak),
+                         static_cast<unsigned long long>(group.ioReadBytes),
+                         static_cast<unsigned long long>(group.ioWriteBytes));
+        }
+        std::fclose(out);
+    }
+
+    if (WIFSIGNALED(status)) {
+        // Die the same way, so QProcess reports a crash exit
+        int signal = WTERMSIG(status);
+        struct rlimit noCore = {0, 0};
+        setrlimit(RLIMIT_CORE, &noCore);
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+        return 128 + signal;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 127;
+}
+
+#include "moc_ProcessSupervisor.cpp"
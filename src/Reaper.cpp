@@ -0,0 +1,197 @@
+#include "Reaper.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+void lowerCurrentThreadPriority() {
+#ifdef __linux__
+    // Both calls act on the calling thread only when given its tid
+    constexpr int ioprioWhoProcess = 1;
+    constexpr int ioprioClassIdle = 3;
+    constexpr int ioprioClassShift = 13;
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    syscall(SYS_ioprio_set, ioprioWhoProcess, tid, ioprioClassIdle << ioprioClassShift);
+    setpriority(PRIO_PROCESS, static_cast<id_t>(tid), 10);
+#endif
+}
+
+} // namespace
+
+Reaper& Reaper::instance() {
+    static Reaper reaper;
+    return reaper;
+}
+
+Reaper::~Reaper() {
+    shutdown();
+}
+
+void Reaper::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+void Reaper::startWorkers() {
+    unsigned count = std::max(2u, std::min(4u, std::thread::hardware_concurrency()));
+    for (unsigned i = 0; i < count; ++i) {
+        workers_.emplace_back(&Reaper::workerLoop, this);
+    }
+}
+
+void Reaper::reap(const std::string& path, Callback onDone) {
+    auto job = std::make_shared<Job>();
+    job->result.path = path;
+    job->onDone = std::move(onDone);
+    job->startNs = Tracer::now();
+
+    auto root = std::make_shared<DirNode>();
+    root->path = path;
+    root->job = job;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Trash left over from an interrupted reap may be handed in again
+        // while the first pass over it is still running
+        if (stopping_ || !activePaths_.insert(path).second) {
+            return;
+        }
+        if (workers_.empty()) {
+            startWorkers();
+        }
+    }
+    enqueue(root);
+}
+
+void Reaper::enqueue(std::shared_ptr<DirNode> node) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(node));
+    }
+    wake_.notify_one();
+}
+
+void Reaper::workerLoop() {
+    lowerCurrentThreadPriority();
+    Tracer::instance().setThreadName("Reaper");
+
+    while (true) {
+        std::shared_ptr<DirNode> node;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            node = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        scanDirectory(node);
+    }
+}
+
+void Reaper::scanDirectory(const std::shared_ptr<DirNode>& node) {
+    Job& job = *node->job;
+    int dirFd = open(node->path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    DIR* dir = dirFd >= 0 ? fdopendir(dirFd) : nullptr;
+    if (!dir) {
+        if (dirFd >= 0) {
+            close(dirFd);
+        }
+        // A plain file or symlink handed to reap() is removed directly
+        if (unlink(node->path.c_str()) == 0) {
+            ++job.files;
+        } else if (errno != ENOTDIR) {
+            ++job.errors;
+        }
+        finishNode(node);
+        return;
+    }
+
+    while (dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        struct stat st;
+        if (fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            ++job.errors;
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            // Subdirectories become independent work items; this node is
+            // only removed once all of them have been emptied.
+            auto child = std::make_shared<DirNode>();
+            child->path = node->path + "/" + name;
+            child->parent = node;
+            child->job = node->job;
+            ++node->pending;
+            enqueue(std::move(child));
+            continue;
+        }
+
+        if (unlinkat(dirFd, name, 0) == 0) {
+            ++job.files;
+            // Hard-linked files (e.g. ccache) do not free their blocks
+            if (st.st_nlink <= 1) {
+                job.bytes += static_cast<uint64_t>(st.st_blocks) * 512;
+            }
+        } else {
+            ++job.errors;
+        }
+    }
+    closedir(dir);
+    finishNode(node);
+}
+
+void Reaper::finishNode(std::shared_ptr<DirNode> node) {
+    // Walk up while this was the last outstanding piece of work in a directory
+    while (node && --node->pending == 0) {
+        Job& job = *node->job;
+        if (rmdir(node->path.c_str()) != 0 && errno != ENOENT && errno != ENOTDIR) {
+            ++job.errors;
+        }
+
+        if (!node->parent) {
+            uint64_t duration = Tracer::now() - job.startNs;
+            Tracer::instance().record("Reaper::reap", "io", job.startNs, duration, job.result.path);
+
+            job.result.bytesReclaimed = job.bytes;
+            job.result.filesRemoved = job.files;
+            job.result.errors = job.errors;
+            job.result.seconds = duration / 1e9;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                activePaths_.erase(job.result.path);
+            }
+            if (job.onDone) {
+                job.onDone(job.result);
+            }
+            return;
+        }
+
+        std::shared_ptr<DirNode> parent = std::move(node->parent);
+        node = std::move(parent);
+    }
+}
@@ -0,0 +1,173 @@
+#include "RunChart.h"
+#include <QColor>
+#include <QDateTime>
+#include <QFontMetrics>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QPen>
+#include <QPointF>
+#include <QRect>
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace {
+
+// The main window's dark theme
+const char* kBackground = "#2b2b2b";
+const char* kGrid = "#5a5a5a";
+const char* kText = "#999999";
+const char* kBuildColor = "#4a90e2";
+const char* kRunColor = "#27ae60";
+const char* kFailedColor = "#e74c3c";
+const int kGridLines = 4;
+
+QString formatBytes(double bytes) {
+    static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit = 0;
+    while (bytes >= 1024.0 && unit < 4) {
+        bytes /= 1024.0;
+        ++unit;
+    }
+    return QString("%1 %2").arg(bytes, 0, 'f', unit == 0 ? 0 : 1).arg(units[unit]);
+}
+
+} // namespace
+
+RunChart::RunChart(QWidget* parent) : QWidget(parent) {
+    setMinimumHeight(160);
+}
+
+void RunChart::setRecords(const std::vector<RunRecord>& records) {
+    records_ = records;
+    update();
+}
+
+void RunChart::setMetric(Metric metric) {
+    metric_ = metric;
+    update();
+}
+
+QString RunChart::metricName(Metric metric) {
+    switch (metric) {
+    case Metric::WallTime: return "Wall Time";
+    case Metric::CpuTime: return "CPU Time";
+    case Metric::PeakMemory: return "Peak Memory";
+    case Metric::Processes: return "Processes";
+    case Metric::BytesRead: return "Bytes Read";
+    case Metric::BytesWritten: return "Bytes Written";
+    }
+    return QString();
+}
+
+double RunChart::value(const RunRecord& record, Metric metric) {
+    switch (metric) {
+    case Metric::WallTime: return record.wallSeconds;
+    case Metric::CpuTime: return record.cpuSeconds();
+    // Older helpers only knew the largest process
+    case Metric::PeakMemory: return 1024.0 * (record.peakKb > 0 ? record.peakKb : record.maxRssKb);
+    case Metric::Processes: return static_cast<double>(record.processes);
+    case Metric::BytesRead: return static_cast<double>(record.readBytes);
+    case Metric::BytesWritten: return static_cast<double>(record.writtenBytes);
+    }
+    return 0.0;
+}
+
+QString RunChart::formatValue(double value, Metric metric) {
+    switch (metric) {
+    case Metric::WallTime:
+    case Metric::CpuTime:
+        return QString("%1 s").arg(value, 0, 'f', value < 10.0 ? 2 : 1);
+    case Metric::Processes:
+        return QString::number(static_cast<long>(value + 0.5));
+    case Metric::PeakMemory:
+    case Metric::BytesRead:
+    case Metric::BytesWritten:
+        return formatBytes(value);
+    }
+    return QString();
+}
+
+void RunChart::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), QColor(kBackground));
+    QFontMetrics metrics = painter.fontMetrics();
+
+    if (records_.empty()) {
+        painter.setPen(QColor(kText));
+        painter.drawText(rect(), Qt::AlignCenter, "No builds or runs recorded for this workspace yet");
+        return;
+    }
+
+    double maximum = 0.0;
+    for (const auto& record : records_) {
+        maximum = std::max(maximum, value(record, metric_));
+    }
+    // Headroom above the highest point, and a scale for an all-zero series
+    maximum = maximum > 0.0 ? maximum * 1.1 : 1.0;
+
+    int labelWidth = metrics.horizontalAdvance(formatValue(maximum, metric_)) + 8;
+    int line = metrics.height();
+    QRect plot = rect().adjusted(labelWidth, 2 * line, -12, -2 * line);
+    if (plot.width() < 20 || plot.height() < 20) {
+        return;
+    }
+
+    for (int i = 0; i <= kGridLines; ++i) {
+        int y = plot.bottom() - plot.height() * i / kGridLines;
+        painter.setPen(QPen(QColor(kGrid), 1, i == 0 ? Qt::SolidLine : Qt::DashLine));
+        painter.drawLine(plot.left(), y, plot.right(), y);
+        painter.setPen(QColor(kText));
+        painter.drawText(QRect(0, y - line / 2, labelWidth - 6, line), Qt::AlignRight | Qt::AlignVCenter,
+                         formatValue(maximum * i / kGridLines, metric_));
+    }
+
+    // Runs are spaced evenly; builds a day apart are as comparable as builds a minute apart
+    size_t count = records_.size();
+    auto pointOf = [&](size_t index) {
+        double x = count == 1 ? plot.left() + plot.width() / 2.0
+                              : plot.left() + plot.width() * static_cast<double>(index) / (count - 1);
+        double y = plot.bottom() - plot.height() * value(records_[index], metric_) / maximum;
+        return QPointF(x, y);
+    };
+    for (const char* action : {"build", "run"}) {
+        const char* color = std::string(action) == "build" ? kBuildColor : kRunColor;
+        std::vector<QPointF> points;
+        std::vector<size_t> indices;
+        for (size_t i = 0; i < count; ++i) {
+            if (records_[i].action == action) {
+                points.push_back(pointOf(i));
+                indices.push_back(i);
+            }
+        }
+        if (points.empty()) {
+            continue;
+        }
+        painter.setPen(QPen(QColor(color), 1.5));
+        painter.drawPolyline(points.data(), static_cast<int>(points.size()));
+        for (size_t i = 0; i < points.size(); ++i) {
+            const char* dot = records_[indices[i]].exitCode == 0 ? color : kFailedColor;
+            painter.setPen(QColor(dot));
+            painter.setBrush(QColor(dot));
+            painter.drawEllipse(points[i], 2.5, 2.5);
+        }
+    }
+
+    // Legend above, time span below
+    int x = plot.left();
+    for (const auto& entry : {std::make_pair("build", kBuildColor), std::make_pair("run", kRunColor),
+                              std::make_pair("failed", kFailedColor)}) {
+        painter.fillRect(x, line / 2, 8, 8, QColor(entry.second));
+        painter.setPen(QColor(kText));
+        painter.drawText(x + 12, line / 2 + 8, entry.first);
+        x += 12 + metrics.horizontalAdvance(entry.first) + 16;
+    }
+    painter.drawText(QRect(x, 0, plot.right() - x, 2 * line), Qt::AlignRight | Qt::AlignVCenter,
+                     metricName(metric_));
+    QRect below(plot.left(), plot.bottom() + 4, plot.width(), line);
+    painter.drawText(below, Qt::AlignLeft,
+                     QDateTime::fromSecsSinceEpoch(records_.front().time).toString("yyyy-MM-dd HH:mm"));
+    painter.drawText(below, Qt::AlignRight,
+                     QDateTime::fromSecsSinceEpoch(records_.back().time).toString("yyyy-MM-dd HH:mm"));
+}
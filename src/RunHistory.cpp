@@ -0,0 +1,91 @@
+#include "RunHistory.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+// "<time> <action> <exit> <wall> <user> <system> <maxrss> <peak> <processes>
+//  <read> <written> <storage read> <storage written> <description>"
+std::string formatRecord(const RunRecord& record) {
+    std::ostringstream line;
+    line << record.time << " " << record.action << " " << record.exitCode << " "
+         << record.wallSeconds << " " << record.userSeconds << " " << record.systemSeconds << " "
+         << record.maxRssKb << " " << record.peakKb << " " << record.processes << " "
+         << record.readBytes << " " << record.writtenBytes << " "
+         << record.storageReadBytes << " " << record.storageWriteBytes << " " << record.description;
+    std::string text = line.str();
+    // One record per line, whatever the description holds
+    for (char& c : text) {
+        if (c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+    return text + "\n";
+}
+
+bool parseRecord(const std::string& line, RunRecord& record) {
+    std::istringstream fields(line);
+    if (!(fields >> record.time >> record.action >> record.exitCode >> record.wallSeconds >> record.userSeconds >>
+          record.systemSeconds >> record.maxRssKb >> record.peakKb >> record.processes >> record.readBytes >>
+          record.writtenBytes >> record.storageReadBytes >> record.storageWriteBytes)) {
+        return false;
+    }
+    fields >> std::ws;
+    std::getline(fields, record.description);
+    return true;
+}
+
+} // namespace
+
+RunHistory::RunHistory(const std::string& file) : file_(file) {
+}
+
+bool RunHistory::load() {
+    records_.clear();
+    lines_ = 0;
+    std::ifstream in(file_);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::vector<RunRecord> all;
+    std::string line;
+    while (std::getline(in, line)) {
+        ++lines_;
+        RunRecord record;
+        if (parseRecord(line, record)) {
+            all.push_back(std::move(record));
+        }
+    }
+    size_t first = all.size() > kMaxRecords ? all.size() - kMaxRecords : 0;
+    records_.assign(std::make_move_iterator(all.begin() + first), std::make_move_iterator(all.end()));
+    return true;
+}
+
+bool RunHistory::append(const RunRecord& record) {
+    records_.push_back(record);
+    if (records_.size() > kMaxRecords) {
+        records_.erase(records_.begin());
+    }
+    if (++lines_ > 2 * kMaxRecords) {
+        lines_ = records_.size();
+        return rewrite();
+    }
+    std::ofstream out(file_, std::ios::app);
+    out << formatRecord(record);
+    return out.good();
+}
+
+bool RunHistory::rewrite() const {
+    std::string tmp = file_ + ".tmp";
+    std::ofstream out(tmp);
+    if (!out.is_open()) {
+        return false;
+    }
+    for (const auto& record : records_) {
+        out << formatRecord(record);
+    }
+    out.close();
+    return out.good() && std::rename(tmp.c_str(), file_.c_str()) == 0;
+}
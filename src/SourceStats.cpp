@@ -0,0 +1,359 @@
+#include "SourceStats.h"
+#include "Trace.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr std::string_view kLanguages[] = {
+    "C++", "C", "C/C++ Header", "CMake", "Make", "Python", "Shell", "JavaScript",
+    "TypeScript", "Rust", "Go", "Java", "Objective-C", "Qt UI", "Markdown",
+};
+constexpr int kLanguageCount = static_cast<int>(sizeof(kLanguages) / sizeof(kLanguages[0]));
+
+struct LanguageMarker {
+    std::string_view suffix; // File extension, or a whole file name
+    int language;            // Index into kLanguages
+};
+
+constexpr LanguageMarker kLanguageMarkers[] = {
+    {".cpp", 0}, {".cc", 0}, {".cxx", 0}, {".c++", 0}, {".ipp", 0}, {".tpp", 0},
+    {".c", 1},
+    {".h", 2}, {".hpp", 2}, {".hh", 2}, {".hxx", 2}, {".inl", 2},
+    {".cmake", 3}, {"CMakeLists.txt", 3},
+    {".mk", 4}, {"Makefile", 4}, {"makefile", 4},
+    {".py", 5},
+    {".sh", 6}, {".bash", 6},
+    {".js", 7}, {".mjs", 7},
+    {".ts", 8},
+    {".rs", 9},
+    {".go", 10},
+    {".java", 11},
+    {".m", 12}, {".mm", 12},
+    {".ui", 13}, {".qml", 13},
+    {".md", 14},
+};
+
+// Files are read in pieces of this size rather than mapped: a file
+// truncated while it is counted would raise SIGBUS in a mapping
+constexpr size_t kReadChunk = 64 * 1024;
+
+int languageOf(std::string_view name) {
+    for (const auto& marker : kLanguageMarkers) {
+        if (marker.suffix[0] == '.') {
+            if (name.size() > marker.suffix.size() &&
+                name.compare(name.size() - marker.suffix.size(), marker.suffix.size(), marker.suffix) == 0) {
+                return marker.language;
+            }
+        } else if (name == marker.suffix) {
+            return marker.language;
+        }
+    }
+    return -1;
+}
+
+int64_t modificationTime(const struct stat& st) {
+#ifdef __APPLE__
+    return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+// Lines in the file: newlines, plus an unterminated last line
+bool countFileLines(int dirFd, const char* name, size_t size, uint64_t& lines) {
+    lines = 0;
+    if (size == 0) {
+        return true;
+    }
+
+    int fd = openat(dirFd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    char last = '\n';
+    thread_local std::vector<char> buffer(kReadChunk);
+    for (off_t offset = 0;;) {
+        ssize_t length = pread(fd, buffer.data(), buffer.size(), offset);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length <= 0) {
+            break;
+        }
+        lines += SourceStats::countNewlines(buffer.data(), static_cast<size_t>(length));
+        last = buffer[length - 1];
+        offset += length;
+    }
+    close(fd);
+
+    if (last != '\n') {
+        ++lines;
+    }
+    return true;
+}
+
+} // namespace
+
+SourceStats::SourceStats(const std::string& root, const std::string& cacheFile)
+    : root_(root), cacheFile_(cacheFile) {
+}
+
+bool SourceStats::isSourceFile(const std::string& fileName) {
+    return languageOf(fileName) >= 0;
+}
+
+bool SourceStats::isSkippedDirectory(const std::string& name) {
+    return name.empty() || name[0] == '.' || name == "node_modules" || name == "build" || name == "_build" ||
+           name.compare(0, 6, "build-") == 0 || name.compare(0, 11, "cmake-build") == 0;
+}
+
+bool SourceStats::isScratchFile(const std::string& name) {
+    auto endsWith = [&name](const char* suffix) {
+        size_t length = std::strlen(suffix);
+        return name.size() >= length && name.compare(name.size() - length, length, suffix) == 0;
+    };
+    // vim also probes whether a directory is writable with a file named 4913
+    return name.empty() || name.back() == '~' || name.compare(0, 2, ".#") == 0 ||
+           (name[0] == '#' && name.back() == '#') || endsWith(".swp") || endsWith(".swo") || endsWith(".swx") ||
+           name == "4913";
+}
+
+uint64_t SourceStats::countNewlines(const char* data, size_t size) {
+    uint64_t count = 0;
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+    while (size - i >= 16) {
+        // Each compare yields 0xFF per match, so subtracting it counts matches
+        // per byte lane; fold the lanes with a SAD before any can overflow.
+        size_t chunks = std::min<size_t>((size - i) / 16, 255);
+        __m128i counts = zero;
+        for (size_t c = 0; c < chunks; ++c, i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(chunk, newline));
+        }
+        __m128i sums = _mm_sad_epu8(counts, zero);
+        count += static_cast<uint64_t>(_mm_cvtsi128_si32(sums)) + static_cast<uint64_t>(_mm_extract_epi16(sums, 4));
+    }
+#endif
+    for (; i < size; ++i) {
+        count += data[i] == '\n';
+    }
+    return count;
+}
+
+void SourceStats::loadCache() {
+    cache_.clear();
+    // Format: "inode mtime size lines relative/path" per line
+    std::ifstream file(cacheFile_);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        CacheEntry entry;
+        if (!(in >> entry.inode >> entry.mtimeNs >> entry.size >> entry.lines)) {
+            continue;
+        }
+        std::string path;
+        in.get();
+        std::getline(in, path);
+        if (!path.empty()) {
+            cache_[path] = entry;
+        }
+    }
+}
+
+void SourceStats::saveCache() const {
+    std::ofstream file(cacheFile_);
+    for (const auto& pair : cache_) {
+        const CacheEntry& entry = pair.second;
+        file << entry.inode << ' ' << entry.mtimeNs << ' ' << entry.size << ' ' << entry.lines << ' '
+             << pair.first << '\n';
+    }
+}
+
+SourceStatsResult SourceStats::compute() {
+    TRACE_SCOPE("SourceStats::compute", "scan", root_);
+    uint64_t startNs = Tracer::now();
+    loadCache();
+
+    struct Partial {
+        std::array<LanguageStats, kLanguageCount> languages;
+        std::vector<std::pair<std::string, CacheEntry>> seen;
+        uint64_t filesCounted = 0;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::string> directories = {""}; // Relative to root_
+    int pending = 1;                            // Directories queued or being scanned
+
+    unsigned threadCount = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+    std::vector<Partial> partials(threadCount);
+    std::vector<std::thread> threads;
+
+    auto worker = [&](Partial& partial) {
+        while (true) {
+            std::string relative;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return !directories.empty() || pending == 0; });
+                if (directories.empty()) {
+                    return;
+                }
+                relative = std::move(directories.front());
+                directories.pop_front();
+            }
+
+            std::string absolute = relative.empty() ? root_ : root_ + "/" + relative;
+            int dirFd = open(absolute.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            DIR* dir = dirFd >= 0 ? fdopendir(dirFd) : nullptr;
+            if (!dir && dirFd >= 0) {
+                close(dirFd);
+            }
+
+            while (dir) {
+                dirent* entry = readdir(dir);
+                if (!entry) {
+                    break;
+                }
+                std::string_view name(entry->d_name);
+                if (name == "." || name == "..") {
+                    continue;
+                }
+
+                unsigned char type = entry->d_type;
+                struct stat st;
+                bool haveStat = false;
+                if (type == DT_UNKNOWN) {
+                    if (fstatat(dirFd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                        continue;
+                    }
+                    haveStat = true;
+                    type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+                }
+
+                std::string childPath = relative.empty() ? std::string(name) : relative + "/" + std::string(name);
+                if (type == DT_DIR) {
+                    if (isSkippedDirectory(std::string(name))) {
+                        continue;
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        directories.push_back(std::move(childPath));
+                        ++pending;
+                    }
+                    wake.notify_one();
+                    continue;
+                }
+
+                // Symlinks are not followed, so nothing is counted twice
+                int language = type == DT_REG ? languageOf(name) : -1;
+                if (language < 0) {
+                    continue;
+                }
+                if (!haveStat && fstatat(dirFd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                    continue;
+                }
+
+                CacheEntry current;
+                current.inode = static_cast<uint64_t>(st.st_ino);
+                current.mtimeNs = modificationTime(st);
+                current.size = static_cast<uint64_t>(st.st_size);
+
+                // Only read during the walk, so no lock is needed
+                auto cached = cache_.find(childPath);
+                if (cached != cache_.end() && cached->second.inode == current.inode &&
+                    cached->second.mtimeNs == current.mtimeNs && cached->second.size == current.size) {
+                    current.lines = cached->second.lines;
+                } else if (countFileLines(dirFd, entry->d_name, current.size, current.lines)) {
+                    ++partial.filesCounted;
+                } else {
+                    continue;
+                }
+
+                LanguageStats& stats = partial.languages[language];
+                ++stats.files;
+                stats.lines += current.lines;
+                stats.bytes += current.size;
+                partial.seen.emplace_back(std::move(childPath), current);
+            }
+            if (dir) {
+                closedir(dir);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                wake.notify_all();
+            }
+        }
+    };
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&, i] {
+            Tracer::instance().setThreadName("SourceStats");
+            worker(partials[i]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    SourceStatsResult result;
+    std::array<LanguageStats, kLanguageCount> totals;
+    size_t seenCount = 0;
+    for (const Partial& partial : partials) {
+        for (int i = 0; i < kLanguageCount; ++i) {
+            totals[i].files += partial.languages[i].files;
+            totals[i].lines += partial.languages[i].lines;
+            totals[i].bytes += partial.languages[i].bytes;
+        }
+        result.filesCounted += partial.filesCounted;
+        seenCount += partial.seen.size();
+    }
+
+    for (int i = 0; i < kLanguageCount; ++i) {
+        if (totals[i].files == 0) {
+            continue;
+        }
+        totals[i].language = std::string(kLanguages[i]);
+        result.files += totals[i].files;
+        result.lines += totals[i].lines;
+        result.bytes += totals[i].bytes;
+        result.languages.push_back(totals[i]);
+    }
+    std::sort(result.languages.begin(), result.languages.end(),
+              [](const LanguageStats& a, const LanguageStats& b) { return a.lines > b.lines; });
+
+    // Rewrite the cache only when a file was read, added or deleted
+    if (result.filesCounted > 0 || seenCount != cache_.size()) {
+        cache_.clear();
+        for (Partial& partial : partials) {
+            for (auto& pair : partial.seen) {
+                cache_.emplace(std::move(pair.first), pair.second);
+            }
+        }
+        saveCache();
+    }
+
+    result.seconds = (Tracer::now() - startNs) / 1e9;
+    return result;
+}
@@ -0,0 +1,221 @@
+#include "SourceWatcher.h"
+#include "IgnoreRules.h"
+#include "SourceStats.h"
+#include "Trace.h"
+#include <QSocketNotifier>
+#include <QTimer>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#ifdef __linux__
+namespace {
+
+// Close-after-write rather than every write, so a save is one event; moves
+// cover editors that save through a temporary file and rename it over
+constexpr uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE |
+                                IN_DONT_FOLLOW | IN_EXCL_UNLINK | IN_ONLYDIR;
+
+} // namespace
+#endif
+
+SourceWatcher::SourceWatcher(const std::string& root, std::vector<std::string> excludedDirectories, QObject* parent)
+    : QObject(parent), root_(root), excludedDirectories_(std::move(excludedDirectories)) {
+    debounce_ = new QTimer(this);
+    debounce_->setSingleShot(true);
+    debounce_->setInterval(300);
+    connect(debounce_, &QTimer::timeout, this, &SourceWatcher::flush);
+}
+
+SourceWatcher::~SourceWatcher() {
+    stop();
+}
+
+void SourceWatcher::setDebounce(int ms) {
+    debounce_->setInterval(ms);
+}
+
+bool SourceWatcher::isSupported() {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SourceWatcher::start() {
+    TRACE_SCOPE("SourceWatcher::start", "scan", root_);
+    stop();
+#ifndef __linux__
+    error_ = "Watch mode is unsupported on this platform: it needs Linux inotify.";
+    return false;
+#else
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        error_ = QString("inotify is unavailable: %1").arg(strerror(errno));
+        return false;
+    }
+    if (!watchTree(std::string(), nullptr)) {
+        stop();
+        return false;
+    }
+    notifier_ = new QSocketNotifier(fd_, QSocketNotifier::Read, this);
+    connect(notifier_, &QSocketNotifier::activated, this, &SourceWatcher::readEvents);
+    return true;
+#endif
+}
+
+void SourceWatcher::stop() {
+    debounce_->stop();
+    delete notifier_;
+    notifier_ = nullptr;
+    if (fd_ >= 0) {
+        // Closing the descriptor drops all of its watches
+        close(fd_);
+        fd_ = -1;
+    }
+    directories_.clear();
+    rules_.clear();
+    pending_.clear();
+    overflowed_ = false;
+}
+
+bool SourceWatcher::isIgnored(const std::string& directory, const std::string& path, bool isDirectory) const {
+    auto rules = rules_.find(directory);
+    return rules != rules_.end() && rules->second && rules->second->isIgnored(path, isDirectory);
+}
+
+bool SourceWatcher::watchTree(const std::string& relative, std::shared_ptr<const IgnoreRules> rules) {
+#ifndef __linux__
+    return false;
+#else
+    std::string absolute = relative.empty() ? root_ : root_ + "/" + relative;
+    int wd = inotify_add_watch(fd_, absolute.c_str(), kWatchMask);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            error_ = QString("%1 has more directories than inotify may watch; "
+                             "raise fs.inotify.max_user_watches").arg(QString::fromStdString(root_));
+            return false;
+        }
+        // Gone again, or not a directory after all
+        return true;
+    }
+    directories_[wd] = relative;
+    rules = IgnoreRules::load(absolute + "/.gitignore", relative, rules);
+    rules_[relative] = rules;
+
+    DIR* dir = opendir(absolute.c_str());
+    if (!dir) {
+        return true;
+    }
+    bool ok = true;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN) {
+            struct stat st;
+            if (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+            type = S_ISDIR(st.st_mode) ? DT_DIR : DT_REG;
+        }
+        std::string child = relative.empty() ? name : relative + "/" + name;
+        // Same tree the no-op build check hashes
+        if (type != DT_DIR || SourceStats::isSkippedDirectory(name) ||
+            std::find(excludedDirectories_.begin(), excludedDirectories_.end(), child) != excludedDirectories_.end() ||
+            (rules && rules->isIgnored(child, true))) {
+            continue;
+        }
+        if (!watchTree(child, rules)) {
+            ok = false;
+            break;
+        }
+    }
+    closedir(dir);
+    return ok;
+#endif
+}
+
+void SourceWatcher::readEvents() {
+    TRACE_SCOPE("SourceWatcher::readEvents", "scan", root_);
+#ifdef __linux__
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    bool relevant = false;
+    for (;;) {
+        ssize_t length = read(fd_, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break; // EAGAIN once drained
+        }
+        for (char* p = buffer; p < buffer + length;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflowed_ = true;
+                relevant = true;
+                continue;
+            }
+            auto directory = directories_.find(event->wd);
+            if (directory == directories_.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                directories_.erase(directory);
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+            std::string name = event->name;
+            std::string path = directory->second.empty() ? name : directory->second + "/" + name;
+
+            if (event->mask & IN_ISDIR) {
+                if (SourceStats::isSkippedDirectory(name) ||
+                    std::find(excludedDirectories_.begin(), excludedDirectories_.end(), path) !=
+                        excludedDirectories_.end() ||
+                    isIgnored(directory->second, path, true)) {
+                    continue;
+                }
+                // Files may have landed in a new directory before its watch did
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    watchTree(path, rules_[directory->second]);
+                }
+                pending_.insert(QString::fromStdString(path));
+                relevant = true;
+                continue;
+            }
+            // Creation alone is no content yet; the close after writing follows
+            if (!SourceStats::isScratchFile(name) && !isIgnored(directory->second, path, false) &&
+                !(event->mask & IN_CREATE)) {
+                pending_.insert(QString::fromStdString(path));
+                relevant = true;
+            }
+        }
+    }
+    if (relevant) {
+        debounce_->start();
+    }
+#endif
+}
+
+void SourceWatcher::flush() {
+    if (pending_.isEmpty() && !overflowed_) {
+        return;
+    }
+    QStringList paths = pending_.values();
+    paths.sort();
+    bool overflowed = overflowed_;
+    pending_.clear();
+    overflowed_ = false;
+    emit changed(paths, overflowed);
+}
@@ -0,0 +1,259 @@
+#include "TagIndex.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <dirent.h>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace {
+
+bool isNumeric(const std::string& identifier) {
+    return !identifier.empty() &&
+           std::all_of(identifier.begin(), identifier.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+// Digits without a leading zero, small enough for uint64_t
+bool parseNumber(const std::string& text, uint64_t& value) {
+    if (!isNumeric(text) || (text.size() > 1 && text[0] == '0') || text.size() > 18) {
+        return false;
+    }
+    value = std::stoull(text);
+    return true;
+}
+
+// Non-empty [0-9A-Za-z-] identifiers separated by dots
+bool splitIdentifiers(const std::string& text, std::vector<std::string>& identifiers) {
+    size_t begin = 0;
+    while (true) {
+        size_t end = text.find('.', begin);
+        std::string identifier = text.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+        if (identifier.empty() ||
+            !std::all_of(identifier.begin(), identifier.end(),
+                         [](unsigned char c) { return std::isalnum(c) || c == '-'; })) {
+            return false;
+        }
+        identifiers.push_back(identifier);
+        if (end == std::string::npos) {
+            return true;
+        }
+        begin = end + 1;
+    }
+}
+
+int comparePreRelease(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+    // A release ranks above any of its pre-releases
+    if (a.empty() || b.empty()) {
+        return a.empty() == b.empty() ? 0 : a.empty() ? 1 : -1;
+    }
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        bool aNumeric = isNumeric(a[i]);
+        bool bNumeric = isNumeric(b[i]);
+        if (aNumeric && bNumeric) {
+            // No leading zeros, so the longer number is the larger one
+            if (a[i].size() != b[i].size()) {
+                return a[i].size() < b[i].size() ? -1 : 1;
+            }
+        } else if (aNumeric != bNumeric) {
+            return aNumeric ? -1 : 1;
+        }
+        int order = a[i].compare(b[i]);
+        if (order != 0) {
+            return order < 0 ? -1 : 1;
+        }
+    }
+    return a.size() == b.size() ? 0 : a.size() < b.size() ? -1 : 1;
+}
+
+int64_t modificationTime(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return 0;
+    }
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+} // namespace
+
+bool SemVer::parse(const std::string& text, SemVer& version) {
+    version = SemVer();
+    version.tag = text;
+    std::string rest = text;
+    if (!rest.empty() && (rest[0] == 'v' || rest[0] == 'V')) {
+        rest.erase(0, 1);
+    }
+
+    size_t plus = rest.find('+');
+    if (plus != std::string::npos) {
+        std::vector<std::string> identifiers;
+        if (!splitIdentifiers(rest.substr(plus + 1), identifiers)) {
+            return false;
+        }
+        version.build = rest.substr(plus + 1);
+        rest.erase(plus);
+    }
+    size_t dash = rest.find('-');
+    if (dash != std::string::npos) {
+        if (!splitIdentifiers(rest.substr(dash + 1), version.preRelease)) {
+            return false;
+        }
+        for (const auto& identifier : version.preRelease) {
+            if (isNumeric(identifier) && identifier.size() > 1 && identifier[0] == '0') {
+                return false;
+            }
+        }
+        rest.erase(dash);
+    }
+
+    size_t firstDot = rest.find('.');
+    size_t secondDot = firstDot == std::string::npos ? std::string::npos : rest.find('.', firstDot + 1);
+    if (secondDot == std::string::npos) {
+        return false;
+    }
+    return parseNumber(rest.substr(0, firstDot), version.major) &&
+           parseNumber(rest.substr(firstDot + 1, secondDot - firstDot - 1), version.minor) &&
+           parseNumber(rest.substr(secondDot + 1), version.patch);
+}
+
+std::string SemVer::toString() const {
+    std::string text = std::to_string(major) + "." + std::to_string(minor) + "." + std::to_string(patch);
+    for (size_t i = 0; i < preRelease.size(); ++i) {
+        text += (i == 0 ? "-" : ".") + preRelease[i];
+    }
+    if (!build.empty()) {
+        text += "+" + build;
+    }
+    return text;
+}
+
+SemVer SemVer::bumped(int type) const {
+    SemVer next;
+    next.major = major;
+    next.minor = minor;
+    next.patch = patch;
+    switch (type) {
+    case 2: // Major
+        if (!isPreRelease() || minor != 0 || patch != 0) {
+            ++next.major;
+        }
+        next.minor = 0;
+        next.patch = 0;
+        break;
+    case 1: // Minor
+        if (!isPreRelease() || patch != 0) {
+            ++next.minor;
+        }
+        next.patch = 0;
+        break;
+    case 0: // Patch
+    default:
+        if (!isPreRelease()) {
+            ++next.patch;
+        }
+        break;
+    }
+    return next;
+}
+
+bool operator<(const SemVer& a, const SemVer& b) {
+    if (a.major != b.major) return a.major < b.major;
+    if (a.minor != b.minor) return a.minor < b.minor;
+    if (a.patch != b.patch) return a.patch < b.patch;
+    int preRelease = comparePreRelease(a.preRelease, b.preRelease);
+    if (preRelease != 0) return preRelease < 0;
+    return a.tag < b.tag;
+}
+
+TagIndex::TagIndex(const std::string& gitDirectory) : gitDirectory_(gitDirectory) {
+}
+
+TagIndex::Stamp TagIndex::stamp() const {
+    // A new, moved or deleted tag changes the directory; git pack-refs
+    // rewrites packed-refs
+    return {modificationTime(gitDirectory_ + "/packed-refs"), modificationTime(gitDirectory_ + "/refs/tags")};
+}
+
+bool TagIndex::refresh() {
+    if (gitDirectory_.empty()) {
+        return false;
+    }
+    Stamp current = stamp();
+    if (loaded_ && current == stamp_) {
+        return false;
+    }
+    load();
+    stamp_ = current;
+    loaded_ = true;
+    return true;
+}
+
+void TagIndex::load() {
+    TRACE_SCOPE("TagIndex::load", "git", gitDirectory_);
+    std::vector<std::string> names;
+
+    // "<sha> refs/tags/<name>", with "^<sha>" lines for the commits
+    // annotated tags point to
+    std::ifstream packed(gitDirectory_ + "/packed-refs");
+    std::string line;
+    const std::string prefix = "refs/tags/";
+    while (std::getline(packed, line)) {
+        size_t space = line.find(' ');
+        if (line.empty() || line[0] == '#' || line[0] == '^' || space == std::string::npos) {
+            continue;
+        }
+        if (line.compare(space + 1, prefix.size(), prefix) == 0) {
+            names.push_back(line.substr(space + 1 + prefix.size()));
+        }
+    }
+
+    // Loose tags override packed ones of the same name; both give the same
+    // version, so the duplicate is dropped below. Names with a slash are
+    // never versions, so subdirectories are not read.
+    if (DIR* dir = opendir((gitDirectory_ + "/refs/tags").c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.' && entry->d_type != DT_DIR) {
+                names.push_back(entry->d_name);
+            }
+        }
+        closedir(dir);
+    }
+
+    versions_.clear();
+    for (const auto& name : names) {
+        SemVer version;
+        if (SemVer::parse(name, version)) {
+            versions_.push_back(std::move(version));
+        }
+    }
+    std::sort(versions_.begin(), versions_.end());
+    versions_.erase(std::unique(versions_.begin(), versions_.end(),
+                                [](const SemVer& a, const SemVer& b) { return a.tag == b.tag; }),
+                    versions_.end());
+    updateLatestRelease();
+}
+
+void TagIndex::add(const std::string& tag) {
+    SemVer version;
+    if (!SemVer::parse(tag, version)) {
+        return;
+    }
+    auto position = std::lower_bound(versions_.begin(), versions_.end(), version);
+    if (position == versions_.end() || position->tag != tag) {
+        versions_.insert(position, std::move(version));
+        updateLatestRelease();
+    }
+    // The new ref file is accounted for; the next refresh need not reread
+    if (loaded_) {
+        stamp_ = stamp();
+    }
+}
+
+void TagIndex::updateLatestRelease() {
+    latestRelease_ = -1;
+    for (long i = static_cast<long>(versions_.size()) - 1; i >= 0; --i) {
+        if (!versions_[i].isPreRelease()) {
+            latestRelease_ = i;
+            break;
+        }
+    }
+}
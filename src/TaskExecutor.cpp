@@ -0,0 +1,150 @@
+#include "TaskExecutor.h"
+#include "Trace.h"
+#include <algorithm>
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void lowerCurrentThreadPriority() {
+#ifdef __linux__
+    // Acts on the calling thread only when given its tid
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    setpriority(PRIO_PROCESS, static_cast<id_t>(tid), 10);
+#endif
+}
+
+} // namespace
+
+TaskExecutor& TaskExecutor::instance() {
+    static TaskExecutor executor;
+    return executor;
+}
+
+TaskExecutor::TaskExecutor(unsigned interactiveThreads, unsigned backgroundThreads) {
+    if (backgroundThreads == 0) {
+        backgroundThreads = std::max(2u, std::thread::hardware_concurrency());
+    }
+    interactiveThreads = std::max(1u, interactiveThreads);
+    // Sized before any worker starts, so the workers never see them grow
+    interactive_.running.resize(interactiveThreads, nullptr);
+    background_.running.resize(backgroundThreads, nullptr);
+    for (unsigned i = 0; i < interactiveThreads; ++i) {
+        interactive_.workers.emplace_back(&TaskExecutor::workerLoop, this, TaskLane::Interactive, i);
+    }
+    for (unsigned i = 0; i < backgroundThreads; ++i) {
+        background_.workers.emplace_back(&TaskExecutor::workerLoop, this, TaskLane::Background, i);
+    }
+}
+
+TaskExecutor::~TaskExecutor() {
+    shutdown();
+}
+
+void TaskExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        // Whoever holds a token learns the task will not finish its work
+        for (Lane* each : {&interactive_, &background_}) {
+            for (const Entry& entry : each->heap) {
+                entry.token.cancel();
+            }
+            for (const CancellationToken* token : each->running) {
+                if (token) {
+                    token->cancel();
+                }
+            }
+            each->heap.clear();
+        }
+    }
+    for (Lane* each : {&interactive_, &background_}) {
+        each->wake.notify_all();
+    }
+    for (Lane* each : {&interactive_, &background_}) {
+        for (auto& worker : each->workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+        each->workers.clear();
+    }
+}
+
+bool TaskExecutor::runsLater(const Entry& a, const Entry& b) {
+    // std::push_heap keeps the greatest element first
+    if (a.priority != b.priority) {
+        return a.priority < b.priority;
+    }
+    return a.sequence > b.sequence;
+}
+
+CancellationToken TaskExecutor::submit(TaskLane which, Task task, int priority) {
+    CancellationToken token;
+    submit(which, token, std::move(task), priority);
+    return token;
+}
+
+void TaskExecutor::submit(TaskLane which, const CancellationToken& token, Task task, int priority) {
+    Lane& target = lane(which);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        target.heap.push_back(Entry{priority, nextSequence_++, token, std::move(task)});
+        std::push_heap(target.heap.begin(), target.heap.end(), runsLater);
+    }
+    target.wake.notify_one();
+}
+
+void TaskExecutor::workerLoop(TaskLane which, unsigned index) {
+    bool isInteractive = which == TaskLane::Interactive;
+    if (!isInteractive) {
+        lowerCurrentThreadPriority();
+    }
+    Tracer::instance().setThreadName((isInteractive ? "Interactive " : "Background ") + std::to_string(index));
+
+    Lane& own = lane(which);
+    while (true) {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            own.wake.wait(lock, [&] {
+                if (stopping_) {
+                    return true;
+                }
+                // Background work waits until no interactive task is queued or running
+                return !own.heap.empty() &&
+                       (isInteractive || (interactive_.heap.empty() && interactiveRunning_ == 0));
+            });
+            if (stopping_) {
+                return;
+            }
+            std::pop_heap(own.heap.begin(), own.heap.end(), runsLater);
+            entry = std::move(own.heap.back());
+            own.heap.pop_back();
+            own.running[index] = &entry.token;
+            if (isInteractive) {
+                ++interactiveRunning_;
+            }
+        }
+
+        entry.task(entry.token);
+
+        bool idle = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            own.running[index] = nullptr;
+            if (isInteractive) {
+                idle = --interactiveRunning_ == 0 && interactive_.heap.empty();
+            }
+        }
+        if (idle) {
+            background_.wake.notify_all();
+        }
+    }
+}
@@ -0,0 +1,378 @@
+#include "TextSearch.h"
+#include "IgnoreRules.h"
+#include "SourceStats.h"
+#include "Trace.h"
+#include "TaskExecutor.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kFilesPerTask = 64;
+// Per-thread read buffer; it grows to fit a file and is given back once it
+// is past kReadBufferKeep
+constexpr size_t kReadBuffer = 64 * 1024;
+constexpr size_t kReadBufferKeep = 4 * 1024 * 1024;
+constexpr size_t kMaxFileSize = 64 * 1024 * 1024;
+constexpr size_t kBinaryProbe = 8192;
+constexpr size_t kMaxLineText = 300;
+
+// Where 'needle' starts in [from, end) ignoring ASCII case, or nullptr.
+// Folded text has no memmem, so memchr finds each case of the first byte.
+const char* findFolded(const char* from, const char* end, const std::string& folded) {
+    const size_t length = folded.size();
+    const char lower = folded[0];
+    const char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(lower)));
+    const char* p = from;
+    while (end - p >= static_cast<ptrdiff_t>(length)) {
+        const char* a = static_cast<const char*>(std::memchr(p, lower, end - p));
+        const char* b = upper == lower ? nullptr : static_cast<const char*>(std::memchr(p, upper, end - p));
+        const char* hit = !a ? b : !b ? a : std::min(a, b);
+        if (!hit || end - hit < static_cast<ptrdiff_t>(length)) {
+            return nullptr;
+        }
+        size_t i = 1;
+        while (i < length && std::tolower(static_cast<unsigned char>(hit[i])) == folded[i]) {
+            ++i;
+        }
+        if (i == length) {
+            return hit;
+        }
+        p = hit + 1;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+std::shared_ptr<TextSearch> TextSearch::create(const SearchQuery& query, std::vector<SearchRoot> roots,
+                                               MatchCallback onMatches, FinishedCallback onFinished) {
+    return std::shared_ptr<TextSearch>(
+        new TextSearch(query, std::move(roots), std::move(onMatches), std::move(onFinished)));
+}
+
+TextSearch::TextSearch(const SearchQuery& query, std::vector<SearchRoot> roots, MatchCallback onMatches,
+                       FinishedCallback onFinished)
+    : query_(query), roots_(std::move(roots)), onMatches_(std::move(onMatches)), onFinished_(std::move(onFinished)) {
+}
+
+std::string TextSearch::requiredLiteral(const std::string& regex) {
+    std::string best;
+    std::string current;
+    auto flush = [&] {
+        if (current.size() > best.size()) {
+            best = current;
+        }
+        current.clear();
+    };
+    // A literal followed by a quantifier that allows zero repetitions is optional
+    auto addLiteral = [&](char c, size_t next) {
+        char q = next < regex.size() ? regex[next] : '\0';
+        if (q == '*' || q == '?' || q == '{') {
+            flush();
+        } else {
+            current += c;
+            if (q == '+') {
+                flush();
+            }
+        }
+    };
+
+    int depth = 0;
+    for (size_t i = 0; i < regex.size(); ++i) {
+        char c = regex[i];
+        if (c == '\\' && i + 1 < regex.size()) {
+            char escaped = regex[++i];
+            if (std::isalnum(static_cast<unsigned char>(escaped))) {
+                flush(); // Character class, anchor or back-reference
+            } else {
+                addLiteral(escaped, i + 1);
+            }
+        } else if (c == '(' || c == '[') {
+            // Groups and sets are skipped whole
+            flush();
+            char close = c == '(' ? ')' : ']';
+            depth = 1;
+            for (++i; i < regex.size() && depth > 0; ++i) {
+                if (regex[i] == '\\') {
+                    ++i;
+                } else if (regex[i] == close) {
+                    --depth;
+                } else if (regex[i] == c && c == '(') {
+                    ++depth;
+                }
+            }
+            --i;
+        } else if (c == '|') {
+            return std::string(); // Top-level alternation: no single literal is required
+        } else if (c == '{') {
+            flush();
+            while (i < regex.size() && regex[i] != '}') {
+                ++i;
+            }
+        } else if (std::strchr(".^$*+?)]}", c)) {
+            flush();
+        } else {
+            addLiteral(c, i + 1);
+        }
+    }
+    flush();
+    return best;
+}
+
+bool TextSearch::start(std::string* error) {
+    if (query_.pattern.empty()) {
+        return false;
+    }
+
+    if (query_.regex) {
+        try {
+            auto flags = std::regex::ECMAScript | std::regex::optimize;
+            if (!query_.caseSensitive) {
+                flags |= std::regex::icase;
+            }
+            regex_ = std::regex(query_.pattern, flags);
+        } catch (const std::regex_error& e) {
+            if (error) {
+                *error = e.what();
+            }
+            return false;
+        }
+        needle_ = requiredLiteral(query_.pattern);
+    } else {
+        needle_ = query_.pattern;
+    }
+    foldedNeedle_ = needle_;
+    std::transform(foldedNeedle_.begin(), foldedNeedle_.end(), foldedNeedle_.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    startNs_ = Tracer::now();
+    // Held until every root is queued so the search cannot finish early
+    pending_ = 1;
+    for (size_t i = 0; i < roots_.size(); ++i) {
+        auto rules = IgnoreRules::load(roots_[i].path + "/.gitignore", "", nullptr);
+        spawn([this, i, rules] { searchDirectory(i, std::string(), rules); });
+    }
+    taskDone();
+    return true;
+}
+
+void TextSearch::cancel() {
+    token_.cancel();
+}
+
+void TextSearch::spawn(std::function<void()> task) {
+    ++pending_;
+    std::shared_ptr<TextSearch> self = shared_from_this();
+    TaskExecutor::instance().submit(TaskLane::Background, token_, [self, task = std::move(task)](const CancellationToken& token) {
+        if (!token.isCancelled()) {
+            task();
+        }
+        self->taskDone();
+    });
+}
+
+void TextSearch::taskDone() {
+    if (--pending_ != 0) {
+        return;
+    }
+
+    SearchSummary summary;
+    summary.filesSearched = filesSearched_;
+    summary.matches = std::min<uint64_t>(matchCount_, query_.maxMatches);
+    summary.truncated = truncated_;
+    summary.cancelled = token_.isCancelled() && !truncated_;
+    summary.seconds = (Tracer::now() - startNs_) / 1e9;
+    Tracer::instance().record("TextSearch", "search", startNs_, Tracer::now() - startNs_, query_.pattern);
+    if (onFinished_) {
+        onFinished_(summary);
+    }
+}
+
+void TextSearch::searchDirectory(size_t rootIndex, std::string relative, std::shared_ptr<const IgnoreRules> rules) {
+    const std::string& rootPath = roots_[rootIndex].path;
+    std::string absolute = relative.empty() ? rootPath : rootPath + "/" + relative;
+    if (!relative.empty()) {
+        rules = IgnoreRules::load(absolute + "/.gitignore", relative, rules);
+    }
+
+    int dirFd = open(absolute.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR* dir = dirFd >= 0 ? fdopendir(dirFd) : nullptr;
+    if (!dir) {
+        if (dirFd >= 0) {
+            close(dirFd);
+        }
+        return;
+    }
+
+    std::vector<std::string> batch;
+    while (dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0 ||
+            std::strcmp(name, ".git") == 0 || std::strcmp(name, ".cppm") == 0) {
+            continue;
+        }
+
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN) {
+            struct stat st;
+            if (fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+            type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+        }
+        // Symlinks are not followed, so nothing is searched twice
+        if (type != DT_DIR && type != DT_REG) {
+            continue;
+        }
+
+        std::string child = relative.empty() ? std::string(name) : relative + "/" + name;
+        if (rules && rules->isIgnored(child, type == DT_DIR)) {
+            continue;
+        }
+
+        if (type == DT_DIR) {
+            spawn([this, rootIndex, child, rules] { searchDirectory(rootIndex, child, rules); });
+        } else {
+            batch.push_back(std::move(child));
+            if (batch.size() == kFilesPerTask) {
+                spawn([this, rootIndex, files = std::move(batch)]() mutable { searchFiles(rootIndex, std::move(files)); });
+                batch.clear();
+            }
+        }
+    }
+    closedir(dir);
+
+    if (!batch.empty()) {
+        searchFiles(rootIndex, std::move(batch));
+    }
+}
+
+void TextSearch::searchFiles(size_t rootIndex, std::vector<std::string> files) {
+    const SearchRoot& root = roots_[rootIndex];
+    std::vector<SearchMatch> matches;
+    thread_local std::vector<char> buffer(kReadBuffer);
+
+    for (const auto& relative : files) {
+        if (token_.isCancelled()) {
+            break;
+        }
+        int fd = open((root.path + "/" + relative).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0 || static_cast<size_t>(st.st_size) > kMaxFileSize) {
+            close(fd);
+            continue;
+        }
+
+        // Read rather than map: a file truncated while it is searched would
+        // raise SIGBUS in a mapping
+        size_t size = static_cast<size_t>(st.st_size);
+        if (buffer.size() < size) {
+            buffer.resize(size);
+        }
+        size_t length = 0;
+        while (length < size) {
+            ssize_t chunk = pread(fd, buffer.data() + length, size - length, static_cast<off_t>(length));
+            if (chunk < 0 && errno == EINTR) {
+                continue;
+            }
+            if (chunk <= 0) {
+                break;
+            }
+            length += static_cast<size_t>(chunk);
+        }
+        if (length > 0) {
+            searchBuffer(root, relative, buffer.data(), length, matches);
+        }
+        if (buffer.size() > kReadBufferKeep) {
+            buffer.resize(kReadBuffer);
+            buffer.shrink_to_fit();
+        }
+        close(fd);
+        ++filesSearched_;
+    }
+
+    if (!matches.empty() && onMatches_) {
+        onMatches_(std::move(matches));
+    }
+}
+
+const char* TextSearch::findCandidate(const char* from, const char* end) const {
+    if (from >= end) {
+        return nullptr;
+    }
+    if (query_.caseSensitive) {
+        return static_cast<const char*>(memmem(from, end - from, needle_.data(), needle_.size()));
+    }
+    return findFolded(from, end, foldedNeedle_);
+}
+
+bool TextSearch::lineMatches(const char* begin, const char* end) const {
+    return std::regex_search(begin, end, regex_);
+}
+
+void TextSearch::searchBuffer(const SearchRoot& root, const std::string& relative, const char* data, size_t size,
+                              std::vector<SearchMatch>& matches) {
+    // Same heuristic as grep: a NUL byte near the start means binary
+    if (std::memchr(data, '\0', std::min(size, kBinaryProbe))) {
+        return;
+    }
+
+    const char* end = data + size;
+    const char* countedTo = data;
+    uint64_t line = 1;
+    const char* p = data;
+
+    while (p < end && !token_.isCancelled()) {
+        const char* lineStart;
+        const char* lineEnd;
+        if (needle_.empty()) {
+            // Regex without a usable literal: every line is a candidate
+            lineStart = p;
+            lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            lineEnd = lineEnd ? lineEnd : end;
+        } else {
+            const char* hit = findCandidate(p, end);
+            if (!hit) {
+                break;
+            }
+            lineStart = hit;
+            while (lineStart > p && lineStart[-1] != '\n') {
+                --lineStart;
+            }
+            lineEnd = static_cast<const char*>(std::memchr(hit, '\n', end - hit));
+            lineEnd = lineEnd ? lineEnd : end;
+        }
+        p = lineEnd + 1;
+
+        if (query_.regex && !lineMatches(lineStart, lineEnd)) {
+            continue;
+        }
+
+        // Line numbers are only worked out for lines that match
+        line += SourceStats::countNewlines(countedTo, lineStart - countedTo);
+        countedTo = lineStart;
+
+        const char* textEnd = lineEnd > lineStart && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+        SearchMatch match;
+        match.workspace = root.name;
+        match.path = relative;
+        match.line = line;
+        match.text.assign(lineStart, std::min<size_t>(textEnd - lineStart, kMaxLineText));
+        matches.push_back(std::move(match));
+
+        if (++matchCount_ >= query_.maxMatches) {
+            truncated_ = true;
+            token_.cancel();
+        }
+    }
+}
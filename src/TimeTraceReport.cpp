@@ -0,0 +1,292 @@
+#include "TimeTraceReport.h"
+#include "Trace.h"
+#include "WorkStealingPool.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <sys/stat.h>
+#include <unordered_map>
+
+namespace {
+
+using EntryMap = std::unordered_map<std::string, TimeTraceEntry>;
+
+struct Partial {
+    size_t traces = 0;
+    size_t unreadable = 0;
+    double compileMs = 0.0;
+    double frontendMs = 0.0;
+    double backendMs = 0.0;
+    std::vector<TimeTraceEntry> files;
+    EntryMap headers;
+    EntryMap instantiations;
+    EntryMap templateSets;
+    EntryMap functions;
+};
+
+void addTo(EntryMap& map, const std::string& name, double ms) {
+    TimeTraceEntry& entry = map[name];
+    if (entry.count == 0) {
+        entry.name = name;
+    }
+    entry.totalMs += ms;
+    entry.maxMs = std::max(entry.maxMs, ms);
+    ++entry.count;
+}
+
+void merge(EntryMap& into, EntryMap& from) {
+    for (auto& pair : from) {
+        TimeTraceEntry& entry = into[pair.first];
+        if (entry.count == 0) {
+            entry.name = pair.first;
+        }
+        entry.totalMs += pair.second.totalMs;
+        entry.maxMs = std::max(entry.maxMs, pair.second.maxMs);
+        entry.count += pair.second.count;
+    }
+}
+
+std::vector<TimeTraceEntry> topOf(std::vector<TimeTraceEntry> entries, size_t top) {
+    auto slower = [](const TimeTraceEntry& a, const TimeTraceEntry& b) { return a.totalMs > b.totalMs; };
+    if (entries.size() > top) {
+        std::partial_sort(entries.begin(), entries.begin() + top, entries.end(), slower);
+        entries.resize(top);
+    } else {
+        std::sort(entries.begin(), entries.end(), slower);
+    }
+    return entries;
+}
+
+std::vector<TimeTraceEntry> topOf(const EntryMap& map, size_t top) {
+    std::vector<TimeTraceEntry> entries;
+    entries.reserve(map.size());
+    for (const auto& pair : map) {
+        entries.push_back(pair.second);
+    }
+    return topOf(std::move(entries), top);
+}
+
+// "std::vector<int, std::allocator<int>>::push_back" -> "std::vector<$>::push_back"
+std::string templateSetOf(const std::string& name) {
+    std::string set;
+    int depth = 0;
+    for (char c : name) {
+        if (c == '<') {
+            if (depth++ == 0) {
+                set += "<$>";
+            }
+        } else if (c == '>' && depth > 0) {
+            --depth;
+        } else if (depth == 0) {
+            set += c;
+        }
+    }
+    return set;
+}
+
+void parseTrace(const std::string& path, const std::string& displayName, Partial& partial) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromStdString(buffer.str()));
+    const QJsonArray events = document.object().value("traceEvents").toArray();
+    if (events.isEmpty()) {
+        ++partial.unreadable;
+        return;
+    }
+
+    double compileMs = 0.0;
+    double executeMs = 0.0;
+    for (const auto& value : events) {
+        QJsonObject event = value.toObject();
+        if (event.value("ph").toString() != "X") {
+            continue;
+        }
+        QString name = event.value("name").toString();
+        double ms = event.value("dur").toDouble() / 1000.0;
+        std::string detail = event.value("args").toObject().value("detail").toString().toStdString();
+
+        if (name == "Source") {
+            addTo(partial.headers, detail, ms);
+        } else if (name == "InstantiateClass" || name == "InstantiateFunction") {
+            addTo(partial.instantiations, detail, ms);
+            addTo(partial.templateSets, templateSetOf(detail), ms);
+        } else if (name == "OptFunction") {
+            addTo(partial.functions, detail, ms);
+        } else if (name == "Total ExecuteCompiler") {
+            compileMs = ms;
+        } else if (name == "ExecuteCompiler") {
+            executeMs = std::max(executeMs, ms);
+        } else if (name == "Total Frontend") {
+            partial.frontendMs += ms;
+        } else if (name == "Total Backend") {
+            partial.backendMs += ms;
+        }
+    }
+
+    // Older clangs only have the per-process event, not the totals
+    compileMs = compileMs > 0.0 ? compileMs : executeMs;
+    TimeTraceEntry file;
+    file.name = displayName;
+    file.totalMs = compileMs;
+    file.maxMs = compileMs;
+    file.count = 1;
+    partial.files.push_back(file);
+    partial.compileMs += compileMs;
+    ++partial.traces;
+}
+
+std::string formatMs(double ms) {
+    char text[32];
+    if (ms >= 10000.0) {
+        std::snprintf(text, sizeof(text), "%.1f s", ms / 1000.0);
+    } else {
+        std::snprintf(text, sizeof(text), "%.0f ms", ms);
+    }
+    return text;
+}
+
+void formatSection(std::ostringstream& out, const char* title, const std::vector<TimeTraceEntry>& entries,
+                   bool counted) {
+    out << "\n**** " << title << ":\n";
+    if (entries.empty()) {
+        out << "  (none)\n";
+        return;
+    }
+    for (const auto& entry : entries) {
+        char line[96];
+        if (counted) {
+            std::snprintf(line, sizeof(line), "%10s %6llux  avg %8s  ", formatMs(entry.totalMs).c_str(),
+                          static_cast<unsigned long long>(entry.count),
+                          formatMs(entry.totalMs / static_cast<double>(entry.count)).c_str());
+        } else {
+            std::snprintf(line, sizeof(line), "%10s  ", formatMs(entry.totalMs).c_str());
+        }
+        std::string name = entry.name.size() > 200 ? entry.name.substr(0, 197) + "..." : entry.name;
+        out << line << name << "\n";
+    }
+}
+
+} // namespace
+
+std::vector<std::string> TimeTraceReport::findTraces(const std::string& buildDir, int64_t sinceNs) {
+    TRACE_SCOPE("TimeTraceReport::findTraces", "scan", buildDir);
+    std::vector<std::string> traces;
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(buildDir, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        const std::filesystem::path& path = it->path();
+        if (path.extension() != ".json") {
+            continue;
+        }
+        // -ftime-trace names the trace after the object: foo.cpp.o -> foo.cpp.json
+        std::filesystem::path stem = path;
+        stem.replace_extension();
+        std::error_code objectError;
+        if (!std::filesystem::exists(stem.string() + ".o", objectError) &&
+            !std::filesystem::exists(stem.string() + ".obj", objectError)) {
+            continue;
+        }
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+            continue;
+        }
+        int64_t mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+        if (mtimeNs >= sinceNs) {
+            traces.push_back(path.string());
+        }
+    }
+    return traces;
+}
+
+TimeTraceSummary TimeTraceReport::aggregate(const std::vector<std::string>& traces, const std::string& buildDir,
+                                            size_t top) {
+    TRACE_SCOPE("TimeTraceReport::aggregate", "scan", buildDir);
+    auto start = std::chrono::steady_clock::now();
+
+    // Each task parses a few traces into a partial of its own; partials
+    // are merged once everything is parsed
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<Partial> partials;
+    size_t pending = 0;
+    const size_t batchSize = 8;
+    WorkStealingPool& pool = WorkStealingPool::instance();
+    for (size_t first = 0; first < traces.size(); first += batchSize) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++pending;
+        }
+        pool.submit([&, first] {
+            Partial partial;
+            for (size_t i = first; i < std::min(first + batchSize, traces.size()); ++i) {
+                std::string name = std::filesystem::path(traces[i]).lexically_relative(buildDir).string();
+                parseTrace(traces[i], name.empty() ? traces[i] : name, partial);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            partials.push_back(std::move(partial));
+            if (--pending == 0) {
+                done.notify_all();
+            }
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return pending == 0; });
+    }
+
+    Partial total;
+    for (auto& partial : partials) {
+        total.traces += partial.traces;
+        total.unreadable += partial.unreadable;
+        total.compileMs += partial.compileMs;
+        total.frontendMs += partial.frontendMs;
+        total.backendMs += partial.backendMs;
+        total.files.insert(total.files.end(), partial.files.begin(), partial.files.end());
+        merge(total.headers, partial.headers);
+        merge(total.instantiations, partial.instantiations);
+        merge(total.templateSets, partial.templateSets);
+        merge(total.functions, partial.functions);
+    }
+
+    TimeTraceSummary summary;
+    summary.traces = total.traces;
+    summary.unreadable = total.unreadable;
+    summary.compileMs = total.compileMs;
+    summary.frontendMs = total.frontendMs;
+    summary.backendMs = total.backendMs;
+    summary.files = topOf(std::move(total.files), top);
+    summary.headers = topOf(total.headers, top);
+    summary.instantiations = topOf(total.instantiations, top);
+    summary.templateSets = topOf(total.templateSets, top);
+    summary.functions = topOf(total.functions, top);
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summary;
+}
+
+std::string TimeTraceReport::format(const TimeTraceSummary& summary) {
+    std::ostringstream out;
+    out << "Compile profile of " << summary.traces << " translation units (aggregated in "
+        << formatMs(summary.seconds * 1000.0) << ")";
+    if (summary.unreadable > 0) {
+        out << ", " << summary.unreadable << " traces unreadable";
+    }
+    out << "\n\n**** Time summary:\n"
+        << "  Compilation: " << formatMs(summary.compileMs) << "\n"
+        << "  Frontend:    " << formatMs(summary.frontendMs) << "\n"
+        << "  Backend:     " << formatMs(summary.backendMs) << "\n";
+    formatSection(out, "Files that took longest to compile", summary.files, false);
+    formatSection(out, "Expensive headers (parse time, including nested includes)", summary.headers, true);
+    formatSection(out, "Templates that took longest to instantiate", summary.instantiations, true);
+    formatSection(out, "Template sets that took longest to instantiate", summary.templateSets, true);
+    formatSection(out, "Functions that took longest to optimize", summary.functions, true);
+    return out.str();
+}
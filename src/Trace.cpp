@@ -0,0 +1,153 @@
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+
+namespace {
+
+const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+void writeJsonString(std::ofstream& out, const char* text) {
+    out << '"';
+    for (const char* p = text; *p; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out << escaped;
+                } else {
+                    out << *p;
+                }
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+uint64_t Tracer::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+Tracer::ThreadBuffer& Tracer::localBuffer() {
+    // The registry keeps buffers alive after their thread exits so that
+    // spans from finished worker threads still show up in the export.
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        static std::atomic<uint32_t> nextTid{1};
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->tid = nextTid++;
+        buffer->events.resize(kRingCapacity);
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        buffers_.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Tracer::record(const char* name, const char* category, uint64_t startNs, uint64_t durationNs,
+                    std::string_view detail) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    TraceEvent& event = buffer.events[buffer.written % kRingCapacity];
+    event.name = name;
+    event.category = category;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    size_t length = std::min(detail.size(), sizeof(event.detail) - 1);
+    std::memcpy(event.detail, detail.data(), length);
+    event.detail[length] = '\0';
+    ++buffer.written;
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+size_t Tracer::eventCount() const {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    size_t count = 0;
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        count += std::min<uint64_t>(buffer->written, kRingCapacity);
+    }
+    return count;
+}
+
+bool Tracer::exportChromeTrace(const std::string& filePath) const {
+    std::ofstream out(filePath);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    const long pid = static_cast<long>(getpid());
+    bool first = true;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+        if (!buffer->threadName.empty()) {
+            out << (first ? "" : ",\n");
+            first = false;
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":";
+            writeJsonString(out, buffer->threadName.c_str());
+            out << "}}";
+        }
+
+        // Oldest surviving event first
+        uint64_t count = std::min<uint64_t>(buffer->written, kRingCapacity);
+        for (uint64_t i = buffer->written - count; i < buffer->written; ++i) {
+            const TraceEvent& event = buffer->events[i % kRingCapacity];
+            out << (first ? "" : ",\n");
+            first = false;
+            out << "{\"name\":";
+            writeJsonString(out, event.name);
+            out << ",\"cat\":";
+            writeJsonString(out, event.category);
+            out << ",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+                << ",\"ts\":" << event.startNs / 1000 << "." << (event.startNs % 1000) / 100
+                << ",\"dur\":" << event.durationNs / 1000 << "." << (event.durationNs % 1000) / 100;
+            if (event.detail[0] != '\0') {
+                out << ",\"args\":{\"detail\":";
+                writeJsonString(out, event.detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return out.good();
+}
+
+TraceScope::TraceScope(const char* name, const char* category, std::string_view detail)
+    : name_(name), category_(category), start_(Tracer::now()) {
+    size_t length = std::min(detail.size(), sizeof(detail_) - 1);
+    std::memcpy(detail_, detail.data(), length);
+    detail_[length] = '\0';
+}
+
+TraceScope::~TraceScope() {
+    Tracer::instance().record(name_, category_, start_, Tracer::now() - start_, detail_);
+}
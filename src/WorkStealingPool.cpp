@@ -0,0 +1,113 @@
+#include "WorkStealingPool.h"
+#include "Trace.h"
+#include <algorithm>
+
+namespace {
+
+// Index of the pool worker running on this thread, or -1 elsewhere
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local int currentWorker = -1;
+
+} // namespace
+
+WorkStealingPool& WorkStealingPool::instance() {
+    static WorkStealingPool pool;
+    return pool;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(2u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    shutdown();
+}
+
+void WorkStealingPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    for (auto& queue : queues_) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks.clear();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    // Workers keep their own spawned tasks; outside callers spread round-robin
+    unsigned index = currentPool == this && currentWorker >= 0
+                         ? static_cast<unsigned>(currentWorker)
+                         : nextQueue_++ % threadCount();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Taking the lock orders the increment against a worker about to sleep
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        ++queued_;
+    }
+    wake_.notify_one();
+}
+
+bool WorkStealingPool::popLocal(unsigned index, Task& task) {
+    Queue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned thief, Task& task) {
+    unsigned count = threadCount();
+    for (unsigned offset = 1; offset < count; ++offset) {
+        Queue& victim = *queues_[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned index) {
+    currentPool = this;
+    currentWorker = static_cast<int>(index);
+    Tracer::instance().setThreadName("Pool " + std::to_string(index));
+
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            --queued_;
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+        if (stopping_) {
+            return;
+        }
+    }
+}
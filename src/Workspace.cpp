@@ -1,15 +1,219 @@
 #include "Workspace.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "Reaper.h"
+#include "ConfigureCache.h"
+#include "LinkerBenchmark.h"
+#include "SourceStats.h"
 #include <iostream>
 #include <cstdlib>
 #include <cstdio>
 #include <memory>
 #include <array>
 #include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <string_view>
+#include <limits>
 #include <fstream>
 #include <algorithm>
 #include <regex>
+#include <chrono>
+#include <sstream>
+#include <iterator>
+#include <thread>
 
-Workspace::Workspace(const std::string& path) : path_(path), buildDir_(std::filesystem::path(path) / "build") {
+namespace {
+
+// "./build/" and "build" name the same directory
+std::filesystem::path normalizedDirectory(const std::string& directory) {
+    std::filesystem::path path = std::filesystem::path(directory).lexically_normal();
+    return path.has_filename() ? path : path.parent_path();
+}
+
+// Empty if the file is missing
+std::string fileContents(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::vector<BuildConfiguration> defaultConfigurations() {
+    // "Default" keeps using ./build so existing build trees stay valid
+    const char* asanFlags = "-fsanitize=address -fno-omit-frame-pointer";
+    const char* ubsanFlags = "-fsanitize=undefined -fno-omit-frame-pointer";
+    return {
+        {"Default", "", "build", "", {}, true},
+        {"Debug", "Debug", "build-debug", "", {}, true},
+        {"Release", "Release", "build-release", "", {}, true},
+        {"RelWithDebInfo", "RelWithDebInfo", "build-relwithdebinfo", "", {}, true},
+        {"ASan", "Debug", "build-asan", "",
+         {std::string("CMAKE_C_FLAGS=") + asanFlags, std::string("CMAKE_CXX_FLAGS=") + asanFlags,
+          "CMAKE_EXE_LINKER_FLAGS=-fsanitize=address", "CMAKE_SHARED_LINKER_FLAGS=-fsanitize=address"}, true},
+        {"UBSan", "Debug", "build-ubsan", "",
+         {std::string("CMAKE_C_FLAGS=") + ubsanFlags, std::string("CMAKE_CXX_FLAGS=") + ubsanFlags,
+          "CMAKE_EXE_LINKER_FLAGS=-fsanitize=undefined", "CMAKE_SHARED_LINKER_FLAGS=-fsanitize=undefined"}, true},
+    };
+}
+
+// CMAKE_LINKER_TYPE needs CMake 3.29; asked once per process
+bool cmakeHasLinkerType() {
+    static const bool supported = []() {
+        int major = 0;
+        int minor = 0;
+        std::unique_ptr<FILE, decltype(&pclose)> pipe(popen("cmake --version 2>/dev/null", "r"), pclose);
+        return pipe && std::fscanf(pipe.get(), "cmake version %d.%d", &major, &minor) == 2 &&
+               (major > 3 || (major == 3 && minor >= 29));
+    }();
+    return supported;
+}
+
+enum class MarkerKind { BuildFile, BuildScript, BuildDirectory, Docs, Readme, GitHub, ScriptsDirectory };
+
+struct Marker {
+    std::string_view name;
+    MarkerKind kind;
+    int rank;                            // Lower wins among markers of the same kind
+    BuildSystem system = BuildSystem::None;
+};
+
+// Names that mean something in a workspace root; a name may play several roles
+constexpr Marker kMarkers[] = {
+    {"CMakeLists.txt", MarkerKind::BuildFile, 0, BuildSystem::CMake},
+    {"Makefile", MarkerKind::BuildFile, 1, BuildSystem::Makefile},
+    {"makefile", MarkerKind::BuildFile, 1, BuildSystem::Makefile},
+    {"build.ninja", MarkerKind::BuildFile, 2, BuildSystem::Ninja},
+    {"configure", MarkerKind::BuildFile, 3, BuildSystem::AutoTools},
+    {"configure.ac", MarkerKind::BuildFile, 3, BuildSystem::AutoTools},
+    {"Makefile.am", MarkerKind::BuildFile, 3, BuildSystem::AutoTools},
+    {"build.sh", MarkerKind::BuildFile, 4, BuildSystem::Script},
+    {"build.py", MarkerKind::BuildFile, 4, BuildSystem::Script},
+    {"build.js", MarkerKind::BuildFile, 4, BuildSystem::Script},
+
+    {"build.sh", MarkerKind::BuildScript, 0},
+    {"build.py", MarkerKind::BuildScript, 1},
+    {"build.js", MarkerKind::BuildScript, 2},
+    {"build.bat", MarkerKind::BuildScript, 3},
+    {"compile.sh", MarkerKind::BuildScript, 4},
+    {"make.sh", MarkerKind::BuildScript, 5},
+    {"install.sh", MarkerKind::BuildScript, 6},
+
+    {"build", MarkerKind::BuildDirectory, 0},
+    {"Build", MarkerKind::BuildDirectory, 1},
+    {"BUILD", MarkerKind::BuildDirectory, 2},
+    {"_build", MarkerKind::BuildDirectory, 3},
+    {"cmake-build", MarkerKind::BuildDirectory, 4},
+    {"cmake-build-debug", MarkerKind::BuildDirectory, 5},
+    {"cmake-build-release", MarkerKind::BuildDirectory, 6},
+    {"out", MarkerKind::BuildDirectory, 7},
+    {"bin", MarkerKind::BuildDirectory, 8},
+    {"target", MarkerKind::BuildDirectory, 9},
+    {"dist", MarkerKind::BuildDirectory, 10},
+
+    {"docs", MarkerKind::Docs, 0},
+    {"README.md", MarkerKind::Readme, 0},
+    {".github", MarkerKind::GitHub, 0},
+    {"scripts", MarkerKind::ScriptsDirectory, 0},
+};
+
+int64_t directoryStamp(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return -1;
+    }
+#ifdef __APPLE__
+    return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+WorkspaceProfile scanProfile(const std::string& path) {
+    WorkspaceProfile profile;
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        return profile;
+    }
+
+    int systemRank = std::numeric_limits<int>::max();
+    std::vector<std::pair<int, std::string>> scripts;
+    std::vector<std::pair<int, std::string>> buildDirs;
+    bool hasGitHub = false;
+
+    while (dirent* entry = readdir(dir)) {
+        std::string_view name(entry->d_name);
+        bool isDirectory = false;
+        bool typeKnown = false;
+
+        for (const Marker& marker : kMarkers) {
+            if (marker.name != name) {
+                continue;
+            }
+            switch (marker.kind) {
+                case MarkerKind::BuildFile:
+                    if (marker.rank < systemRank) {
+                        systemRank = marker.rank;
+                        profile.buildSystem = marker.system;
+                    }
+                    break;
+                case MarkerKind::BuildScript:
+                    scripts.emplace_back(marker.rank, std::string(name));
+                    break;
+                case MarkerKind::BuildDirectory:
+                    // Only directories count, so resolve the type (and any symlink) once
+                    if (!typeKnown) {
+                        typeKnown = true;
+                        if (entry->d_type == DT_DIR) {
+                            isDirectory = true;
+                        } else if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+                            struct stat st;
+                            isDirectory = fstatat(dirfd(dir), entry->d_name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+                        }
+                    }
+                    if (isDirectory) {
+                        buildDirs.emplace_back(marker.rank, std::string(name));
+                    }
+                    break;
+                case MarkerKind::Docs: profile.hasDocsDirectory = true; break;
+                case MarkerKind::Readme: profile.hasReadme = true; break;
+                case MarkerKind::GitHub: hasGitHub = true; break;
+                case MarkerKind::ScriptsDirectory: profile.hasScriptsDirectory = true; break;
+            }
+        }
+    }
+    closedir(dir);
+
+    // The only lookup below the root
+    if (hasGitHub) {
+        struct stat st;
+        profile.hasWorkflows = stat((path + "/.github/workflows").c_str(), &st) == 0;
+    }
+
+    std::sort(scripts.begin(), scripts.end());
+    std::sort(buildDirs.begin(), buildDirs.end());
+    for (auto& script : scripts) {
+        profile.buildScripts.push_back(std::move(script.second));
+    }
+    for (auto& buildDir : buildDirs) {
+        profile.buildDirectories.push_back(std::move(buildDir.second));
+    }
+    return profile;
+}
+
+std::string shellQuote(const std::string& arg) {
+    std::string quoted = "'";
+    for (char c : arg) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+}
+
+} // namespace
+
+Workspace::Workspace(const std::string& path) : path_(path) {
 }
 
 std::string Workspace::getPath() const {
@@ -21,6 +225,7 @@ bool Workspace::exists() const {
 }
 
 bool Workspace::gitInit() {
+    TRACE_SCOPE("Workspace::gitInit", "git");
     std::string cmd = "git init";
     std::string cwd = std::filesystem::current_path().string();
     std::filesystem::current_path(path_);
@@ -30,6 +235,7 @@ bool Workspace::gitInit() {
 }
 
 bool Workspace::gitAdd() {
+    TRACE_SCOPE("Workspace::gitAdd", "git");
     std::string cmd = "git add .";
     std::string cwd = std::filesystem::current_path().string();
     std::filesystem::current_path(path_);
@@ -39,6 +245,7 @@ bool Workspace::gitAdd() {
 }
 
 bool Workspace::gitCommit(const std::string& message) {
+    TRACE_SCOPE("Workspace::gitCommit", "git");
     std::string cmd = "git commit -m \"" + message + "\"";
     std::string cwd = std::filesystem::current_path().string();
     std::filesystem::current_path(path_);
@@ -47,34 +254,162 @@ bool Workspace::gitCommit(const std::string& message) {
     return true; // Assume success
 }
 
+std::filesystem::path Workspace::gitCommonDirectory() const {
+    std::filesystem::path gitDir = std::filesystem::path(path_) / ".git";
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(gitDir, ec)) {
+        // Worktrees and submodules point elsewhere with "gitdir: <path>"
+        std::ifstream link(gitDir);
+        std::string line;
+        if (std::getline(link, line) && line.rfind("gitdir: ", 0) == 0) {
+            std::filesystem::path target = line.substr(8);
+            gitDir = target.is_absolute() ? target : gitDir.parent_path() / target;
+        }
+        // A worktree shares config and refs with the main repository
+        std::ifstream common(gitDir / "commondir");
+        if (std::getline(common, line) && !line.empty()) {
+            std::filesystem::path commonDir = line;
+            gitDir = commonDir.is_absolute() ? commonDir : gitDir / commonDir;
+        }
+    }
+    return gitDir.lexically_normal();
+}
+
+std::vector<std::string> Workspace::getGitRemotes() const {
+    // Read from the config instead of running `git remote` on the GUI thread
+    std::vector<std::string> remotes;
+    std::ifstream config(gitCommonDirectory() / "config");
+    std::string line;
+    while (std::getline(config, line)) {
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos || line.compare(begin, 9, "[remote \"") != 0) {
+            continue;
+        }
+        size_t end = line.find("\"]", begin + 9);
+        if (end != std::string::npos) {
+            std::string name = line.substr(begin + 9, end - begin - 9);
+            if (std::find(remotes.begin(), remotes.end(), name) == remotes.end()) {
+                remotes.push_back(name);
+            }
+        }
+    }
+    return remotes;
+}
+
+const TagIndex& Workspace::getTagIndex() const {
+    std::string gitDir = gitCommonDirectory().string();
+    if (tagIndex_.gitDirectory() != gitDir) {
+        tagIndex_ = TagIndex(gitDir);
+    }
+    tagIndex_.refresh();
+    return tagIndex_;
+}
+
+void Workspace::addTag(const std::string& tag) {
+    tagIndex_.add(tag);
+}
+
+std::string Workspace::getCurrentVersion() const {
+    const SemVer* latest = getTagIndex().latest();
+    return latest ? latest->toString() : "0.0.0";
+}
+
+bool Workspace::prepareConfigure() const {
+    std::filesystem::path buildDir = activeBuildDirectory();
+    std::error_code ec;
+    std::filesystem::create_directories(buildDir, ec);
+    if (ec) {
+        return false;
+    }
+    return detectBuildSystem() != BuildSystem::CMake || CMakeFileApi(buildDir.string()).writeQuery();
+}
+
 bool Workspace::configureBuild() {
-    std::filesystem::create_directory(buildDir_);
-    std::string cmd = "cmake ..";
+    TRACE_SCOPE("Workspace::configureBuild", "build");
+    std::filesystem::path buildDir = activeBuildDirectory();
+    prepareConfigure();
+    std::string cmd = "cmake";
+    for (const auto& arg : getConfigureArguments(getActiveConfiguration())) {
+        cmd += " " + shellQuote(arg);
+    }
     std::string cwd = std::filesystem::current_path().string();
-    std::filesystem::current_path(buildDir_);
+    std::filesystem::current_path(buildDir);
     runCommand(cmd);
     std::filesystem::current_path(cwd);
+    recordConfigureCache();
     return true; // Assume success
 }
 
+bool Workspace::recordConfigureCache() const {
+    BuildConfiguration config = getActiveConfiguration();
+    return ConfigureCache(config.toolchainFile, config.cacheEntries, stateDirectory())
+        .record((activeBuildDirectory() / "CMakeCache.txt").string());
+}
+
 bool Workspace::build() {
-    if (!std::filesystem::exists(buildDir_)) {
+    TRACE_SCOPE("Workspace::build", "build");
+    std::filesystem::path buildDir = activeBuildDirectory();
+    if (!std::filesystem::exists(buildDir)) {
         configureBuild();
     }
     std::string cmd = "make";
     std::string cwd = std::filesystem::current_path().string();
-    std::filesystem::current_path(buildDir_);
+    std::filesystem::current_path(buildDir);
     runCommand(cmd);
     std::filesystem::current_path(cwd);
     return true;
 }
 
-bool Workspace::clean() {
-    std::filesystem::remove_all(buildDir_);
+bool Workspace::clean(std::function<void(const ReapResult&)> onReaped, std::string* error) {
+    std::filesystem::path buildDir = activeBuildDirectory();
+    TRACE_SCOPE("Workspace::clean", "build", buildDir.string());
+    std::string reason;
+    if (!checkBuildDirectory(getActiveConfiguration().directory, reason)) {
+        if (error) *error = reason;
+        return false;
+    }
+
+    // The next build must run even if no source changes
+    forgetSuccessfulBuild(getActiveConfiguration().name);
+
+    std::error_code ec;
+    if (!std::filesystem::exists(buildDir, ec)) {
+        return true;
+    }
+
+    // Renaming within the workspace is atomic and instant, however large
+    // the tree is; the actual deletion happens on the reaper threads
+    std::filesystem::path trashDir = stateDirectory() / "trash";
+    std::filesystem::create_directories(trashDir, ec);
+    auto stamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::filesystem::path trashPath = trashDir / (buildDir.filename().string() + "-" + std::to_string(stamp));
+
+    std::filesystem::rename(buildDir, trashPath, ec);
+    if (ec) {
+        // e.g. a mount point. Deleting in place is not worth the risk of a
+        // directory that is more than a build tree.
+        if (error) *error = "cannot move " + buildDir.string() + " to the trash: " + ec.message();
+        return false;
+    }
+
+    Reaper::instance().reap(trashPath.string(), std::move(onReaped));
+
+    // Resume trash left behind by a reap that was interrupted at exit
+    for (const auto& entry : std::filesystem::directory_iterator(trashDir, ec)) {
+        if (entry.path() != trashPath) {
+            Reaper::instance().reap(entry.path().string());
+        }
+    }
     return true;
 }
 
 std::string Workspace::runCommand(const std::string& cmd) {
+    TRACE_SCOPE("Workspace::runCommand", "process", cmd);
+    std::unique_ptr<ScopedLatency> gitLatency;
+    if (cmd.rfind("git ", 0) == 0) {
+        gitLatency = std::make_unique<ScopedLatency>("git");
+    }
     std::array<char, 128> buffer;
     std::string result;
     std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd.c_str(), "r"), pclose);
@@ -87,44 +422,92 @@ std::string Workspace::runCommand(const std::string& cmd) {
     return result;
 }
 
-BuildSystem Workspace::detectBuildSystem() const {
-    if (buildSystemCached_) {
-        return cachedBuildSystem_;
+std::string Workspace::runInWorkspace(const std::string& cmd) {
+    return runCommand("cd " + shellQuote(path_) + " && " + cmd);
+}
+
+bool Workspace::loadInfoSnapshot(InfoSnapshot& snapshot) const {
+    // Format: "version <v>", then "section <line count> <title>" followed by its lines
+    std::ifstream file(std::filesystem::path(path_) / ".cppm" / "info.txt");
+    std::string line;
+    if (!std::getline(file, line) || line.rfind("version ", 0) != 0) {
+        return false;
     }
-    
-    std::filesystem::path basePath(path_);
-    
-    // Check for CMake
-    if (std::filesystem::exists(basePath / "CMakeLists.txt")) {
-        cachedBuildSystem_ = BuildSystem::CMake;
-    }
-    // Check for Makefile
-    else if (std::filesystem::exists(basePath / "Makefile") || 
-             std::filesystem::exists(basePath / "makefile")) {
-        cachedBuildSystem_ = BuildSystem::Makefile;
-    }
-    // Check for Ninja
-    else if (std::filesystem::exists(basePath / "build.ninja")) {
-        cachedBuildSystem_ = BuildSystem::Ninja;
-    }
-    // Check for AutoTools
-    else if (std::filesystem::exists(basePath / "configure") || 
-             std::filesystem::exists(basePath / "configure.ac") ||
-             std::filesystem::exists(basePath / "Makefile.am")) {
-        cachedBuildSystem_ = BuildSystem::AutoTools;
-    }
-    // Check for build scripts
-    else if (std::filesystem::exists(basePath / "build.sh") ||
-             std::filesystem::exists(basePath / "build.py") ||
-             std::filesystem::exists(basePath / "build.js")) {
-        cachedBuildSystem_ = BuildSystem::Script;
-    }
-    else {
-        cachedBuildSystem_ = BuildSystem::None;
+    snapshot = InfoSnapshot();
+    snapshot.version = line.substr(8);
+    while (std::getline(file, line)) {
+        std::istringstream header(line);
+        std::string keyword;
+        size_t lineCount = 0;
+        InfoSection section;
+        if (!(header >> keyword >> lineCount) || keyword != "section" || header.get() != ' ' ||
+            !std::getline(header, section.title)) {
+            return false;
+        }
+        for (size_t i = 0; i < lineCount && std::getline(file, line); ++i) {
+            section.body += line + "\n";
+        }
+        snapshot.sections.push_back(std::move(section));
     }
-    
-    buildSystemCached_ = true;
-    return cachedBuildSystem_;
+    return true;
+}
+
+void Workspace::saveInfoSnapshot(const InfoSnapshot& snapshot) const {
+    // Written aside and renamed: snapshots are saved from worker threads
+    std::filesystem::path target = stateDirectory() / "info.txt";
+    std::filesystem::path temporary = target;
+    temporary += ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream file(temporary);
+        file << "version " << snapshot.version << "\n";
+        for (const auto& section : snapshot.sections) {
+            size_t lineCount = std::count(section.body.begin(), section.body.end(), '\n');
+            if (!section.body.empty() && section.body.back() != '\n') {
+                ++lineCount;
+            }
+            file << "section " << lineCount << ' ' << section.title << "\n" << section.body;
+            if (!section.body.empty() && section.body.back() != '\n') {
+                file << "\n";
+            }
+        }
+        if (!file.good()) {
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, target, ec);
+}
+
+std::filesystem::path Workspace::stateDirectory() const {
+    prepareStateDirectory();
+    return std::filesystem::path(path_) / ".cppm";
+}
+
+bool Workspace::prepareStateDirectory() const {
+    std::filesystem::path stateDir = std::filesystem::path(path_) / ".cppm";
+    std::error_code ec;
+    if (std::filesystem::exists(stateDir, ec)) {
+        return true;
+    }
+    std::filesystem::create_directories(stateDir, ec);
+    std::ofstream ignore(stateDir / ".gitignore");
+    ignore << "*" << std::endl;
+    return !ec;
+}
+
+WorkspaceProfile Workspace::getProfile() const {
+    TRACE_SCOPE("Workspace::getProfile", "scan");
+    // Adding or removing a root entry bumps the directory mtime
+    int64_t stamp = directoryStamp(path_);
+    if (stamp < 0 || stamp != profileStamp_) {
+        profile_ = scanProfile(path_);
+        profileStamp_ = stamp;
+    }
+    return profile_;
+}
+
+BuildSystem Workspace::detectBuildSystem() const {
+    return getProfile().buildSystem;
 }
 
 std::string Workspace::getBuildSystemName() const {
@@ -139,45 +522,543 @@ std::string Workspace::getBuildSystemName() const {
     }
 }
 
+SourceStatsResult Workspace::getSourceStats() const {
+    ScopedLatency statsLatency("stats");
+    SourceStats stats(path_, (stateDirectory() / "sourcestats.txt").string());
+    return stats.compute();
+}
+
 std::vector<std::string> Workspace::getBuildScripts() const {
-    std::vector<std::string> scripts;
-    std::filesystem::path basePath(path_);
-    
-    std::vector<std::string> scriptNames = {
-        "build.sh", "build.py", "build.js", "build.bat",
-        "compile.sh", "make.sh", "install.sh"
-    };
-    
-    for (const auto& script : scriptNames) {
-        if (std::filesystem::exists(basePath / script)) {
-            scripts.push_back(script);
-        }
-    }
-    
-    return scripts;
+    return getProfile().buildScripts;
 }
 
 std::string Workspace::getBuildDirectory() const {
+    TRACE_SCOPE("Workspace::getBuildDirectory", "scan");
     std::filesystem::path basePath(path_);
+    WorkspaceProfile profile = getProfile();
+
+    // CMake builds out of source, one directory per configuration
+    if (profile.buildSystem == BuildSystem::CMake) {
+        return activeBuildDirectory().string();
+    }
     
-    // Common build directory names
-    std::vector<std::string> buildDirs = {
-        "build", "Build", "BUILD", "_build",
-        "cmake-build", "cmake-build-debug", "cmake-build-release",
-        "out", "bin", "target", "dist"
-    };
-    
-    for (const auto& dir : buildDirs) {
-        std::filesystem::path buildPath = basePath / dir;
-        if (std::filesystem::exists(buildPath) && std::filesystem::is_directory(buildPath)) {
-            return buildPath.string();
-        }
+    if (!profile.buildDirectories.empty()) {
+        return (basePath / profile.buildDirectories.front()).string();
     }
     
     // Default to build if none found
     return (basePath / "build").string();
 }
 
+void Workspace::loadConfigurations() const {
+    if (configurationsLoaded_) {
+        return;
+    }
+    configurationsLoaded_ = true;
+    configurations_ = defaultConfigurations();
+    activeConfiguration_ = "Default";
+
+    // Format: "active=<name>" and one "name|buildType|directory|toolchain|entry;entry" per custom configuration
+    std::ifstream file(std::filesystem::path(path_) / ".cppm" / "configurations.txt");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("active=", 0) == 0) {
+            activeConfiguration_ = line.substr(7);
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '|')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 3 || fields[0].empty() || fields[2].empty()) {
+            continue;
+        }
+
+        BuildConfiguration config;
+        config.name = fields[0];
+        config.buildType = fields[1];
+        config.directory = fields[2];
+        config.toolchainFile = fields.size() > 3 ? fields[3] : "";
+        if (fields.size() > 4) {
+            std::stringstream entries(fields[4]);
+            std::string entry;
+            while (std::getline(entries, entry, ';')) {
+                if (!entry.empty()) {
+                    config.cacheEntries.push_back(entry);
+                }
+            }
+        }
+        configurations_.push_back(config);
+    }
+
+    auto active = std::find_if(configurations_.begin(), configurations_.end(),
+                               [this](const BuildConfiguration& c) { return c.name == activeConfiguration_; });
+    if (active == configurations_.end()) {
+        activeConfiguration_ = "Default";
+    }
+}
+
+void Workspace::saveConfigurations() const {
+    std::ofstream file(stateDirectory() / "configurations.txt");
+    file << "active=" << activeConfiguration_ << std::endl;
+    for (const auto& config : configurations_) {
+        if (config.builtin) {
+            continue;
+        }
+        file << config.name << "|" << config.buildType << "|" << config.directory << "|" << config.toolchainFile << "|";
+        for (size_t i = 0; i < config.cacheEntries.size(); ++i) {
+            file << (i ? ";" : "") << config.cacheEntries[i];
+        }
+        file << std::endl;
+    }
+}
+
+std::vector<BuildConfiguration> Workspace::getConfigurations() const {
+    loadConfigurations();
+    return configurations_;
+}
+
+BuildConfiguration Workspace::getActiveConfiguration() const {
+    loadConfigurations();
+    for (const auto& config : configurations_) {
+        if (config.name == activeConfiguration_) {
+            return config;
+        }
+    }
+    return configurations_.front();
+}
+
+bool Workspace::setActiveConfiguration(const std::string& name) {
+    loadConfigurations();
+    for (const auto& config : configurations_) {
+        if (config.name == name) {
+            activeConfiguration_ = name;
+            saveConfigurations();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Workspace::addConfiguration(const BuildConfiguration& config, std::string* error) {
+    loadConfigurations();
+    std::string reason;
+    if (config.name.empty() || config.name.find('|') != std::string::npos) {
+        reason = "the name must not be empty or contain '|'";
+    } else if (config.directory.find('|') != std::string::npos) {
+        reason = "the directory must not contain '|'";
+    } else {
+        checkBuildDirectory(config.directory, reason);
+    }
+    std::filesystem::path directory = normalizedDirectory(config.directory);
+    for (const auto& existing : configurations_) {
+        if (!reason.empty()) {
+            break;
+        }
+        if (existing.name == config.name) {
+            reason = "a configuration named " + config.name + " already exists";
+        } else if (normalizedDirectory(existing.directory) == directory) {
+            reason = existing.name + " already builds into " + config.directory;
+        }
+    }
+    if (!reason.empty()) {
+        if (error) *error = reason;
+        return false;
+    }
+    BuildConfiguration custom = config;
+    custom.directory = directory.string();
+    custom.builtin = false;
+    configurations_.push_back(custom);
+    saveConfigurations();
+    return true;
+}
+
+bool Workspace::removeConfiguration(const std::string& name) {
+    loadConfigurations();
+    auto it = std::find_if(configurations_.begin(), configurations_.end(),
+                           [&name](const BuildConfiguration& c) { return c.name == name && !c.builtin; });
+    if (it == configurations_.end()) {
+        return false;
+    }
+    configurations_.erase(it);
+    if (activeConfiguration_ == name) {
+        activeConfiguration_ = "Default";
+    }
+    saveConfigurations();
+    return true;
+}
+
+bool Workspace::checkBuildDirectory(const std::string& directory, std::string& error) const {
+    std::filesystem::path relative(directory);
+    if (directory.empty() || relative.has_root_path()) {
+        error = "the build directory must be a path relative to the workspace";
+        return false;
+    }
+    relative = normalizedDirectory(directory);
+    if (relative.empty() || relative == ".") {
+        error = "the build directory must not be the workspace itself";
+        return false;
+    }
+    for (const auto& part : relative) {
+        if (part == "..") {
+            error = "the build directory must stay inside the workspace";
+            return false;
+        }
+    }
+    std::string first = relative.begin()->string();
+    if (first == ".cppm" || first == ".git") {
+        error = first + " is not a build directory";
+        return false;
+    }
+
+    // Symbolic links must not lead out of the workspace or back to its root
+    std::error_code ec;
+    std::filesystem::path root = std::filesystem::weakly_canonical(path_, ec);
+    std::filesystem::path resolved = std::filesystem::weakly_canonical(std::filesystem::path(path_) / relative, ec);
+    if (ec || resolved == root || resolved.lexically_relative(root).empty() ||
+        *resolved.lexically_relative(root).begin() == "..") {
+        error = "the build directory must stay inside the workspace";
+        return false;
+    }
+
+    // An existing tree is a build tree if CMake configured it; otherwise it
+    // must not contain sources
+    if (!std::filesystem::is_directory(resolved, ec) || std::filesystem::exists(resolved / "CMakeCache.txt", ec)) {
+        return true;
+    }
+    auto options = std::filesystem::directory_options::skip_permission_denied;
+    for (std::filesystem::recursive_directory_iterator it(resolved, options, ec), end; it != end; it.increment(ec)) {
+        if (ec) {
+            break;
+        }
+        std::string name = it->path().filename().string();
+        if (it->is_directory(ec) && SourceStats::isSkippedDirectory(name)) {
+            it.disable_recursion_pending();
+        } else if (name == "CMakeLists.txt" || SourceStats::isSourceFile(name)) {
+            error = directory + " holds sources (" + it->path().lexically_relative(resolved).string() +
+                    ") and cannot be a build directory";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string Workspace::getConfigurationDirectory(const BuildConfiguration& config) const {
+    return (std::filesystem::path(path_) / config.directory).string();
+}
+
+std::vector<std::string> Workspace::getConfigureArguments(const BuildConfiguration& config,
+                                                          const std::vector<std::string>& compileLauncher) const {
+    // compile_commands.json drives single-file builds
+    std::vector<std::string> args = {"-S", path_, "-B", getConfigurationDirectory(config),
+                                     "-DCMAKE_EXPORT_COMPILE_COMMANDS=ON"};
+    if (!config.buildType.empty()) {
+        args.push_back("-DCMAKE_BUILD_TYPE=" + config.buildType);
+    }
+    if (!config.toolchainFile.empty()) {
+        args.push_back("-DCMAKE_TOOLCHAIN_FILE=" + config.toolchainFile);
+    }
+
+    // Only a fresh build directory gets the launcher: changing the compile
+    // rules of a configured tree would rebuild all of it
+    std::error_code ec;
+    bool fresh = !std::filesystem::exists(std::filesystem::path(getConfigurationDirectory(config)) / "CMakeCache.txt", ec);
+    std::string launcher;
+    if (fresh) {
+        for (const auto& part : compileLauncher) {
+            launcher += (launcher.empty() ? "" : ";") + part;
+        }
+    }
+    // The workspace's linker: CMake 3.29 selects it itself, older ones get
+    // -fuse-ld in the linker flags, after the configuration's own
+    std::string linker = getLinker();
+    bool linkerType = cmakeHasLinkerType();
+    const char* const linkerFlags[] = {"CMAKE_EXE_LINKER_FLAGS", "CMAKE_SHARED_LINKER_FLAGS", "CMAKE_MODULE_LINKER_FLAGS"};
+    std::unordered_map<std::string, std::string> userLaunchers;
+    std::unordered_map<std::string, std::string> userLinkerFlags;
+    for (const auto& entry : config.cacheEntries) {
+        // A launcher of the configuration itself (e.g. ccache) runs after ours
+        std::string name = entry.substr(0, entry.find_first_of(":="));
+        if (!launcher.empty() && (name == "CMAKE_C_COMPILER_LAUNCHER" || name == "CMAKE_CXX_COMPILER_LAUNCHER") &&
+            entry.find('=') != std::string::npos) {
+            userLaunchers[name] = entry.substr(entry.find('=') + 1);
+            continue;
+        }
+        if (!linkerType && std::find(std::begin(linkerFlags), std::end(linkerFlags), name) != std::end(linkerFlags) &&
+            entry.find('=') != std::string::npos) {
+            userLinkerFlags[name] = entry.substr(entry.find('=') + 1);
+            continue;
+        }
+        args.push_back("-D" + entry);
+    }
+    if (linkerType) {
+        // Empty goes back to the default
+        std::string type = linker;
+        std::transform(type.begin(), type.end(), type.begin(), ::toupper);
+        args.push_back("-DCMAKE_LINKER_TYPE=" + type);
+    } else {
+        // Left alone unless there is a linker to add or an earlier one to
+        // drop, so that flags CMake took from LDFLAGS survive
+        std::unordered_map<std::string, std::string> cached;
+        std::ifstream cache(std::filesystem::path(getConfigurationDirectory(config)) / "CMakeCache.txt");
+        std::string line;
+        while (!fresh && std::getline(cache, line)) {
+            size_t equals = line.find('=');
+            if (equals != std::string::npos) {
+                cached[line.substr(0, line.find_first_of(":="))] = line.substr(equals + 1);
+            }
+        }
+        static const std::regex fuseLd(R"(\s*-fuse-ld=\S+)");
+        for (const char* name : linkerFlags) {
+            bool configured = userLinkerFlags.count(name) > 0;
+            if (linker.empty() && !configured && cached[name].find("-fuse-ld=") == std::string::npos) {
+                continue;
+            }
+            std::string flags = configured ? userLinkerFlags[name] : std::regex_replace(cached[name], fuseLd, "");
+            if (!linker.empty()) {
+                flags += (flags.empty() ? "" : " ") + std::string("-fuse-ld=") + linker;
+            }
+            args.push_back(std::string("-D") + name + "=" + flags);
+        }
+    }
+    if (!launcher.empty()) {
+        // CMake would take these from the environment itself, were it not for ours
+        for (const char* name : {"CMAKE_C_COMPILER_LAUNCHER", "CMAKE_CXX_COMPILER_LAUNCHER"}) {
+            const char* environment = std::getenv(name);
+            if (userLaunchers[name].empty() && environment) {
+                userLaunchers[name] = environment;
+            }
+        }
+        for (const char* name : {"CMAKE_C_COMPILER_LAUNCHER", "CMAKE_CXX_COMPILER_LAUNCHER"}) {
+            const std::string& user = userLaunchers[name];
+            args.push_back(std::string("-D") + name + "=" + launcher + (user.empty() ? "" : ";" + user));
+        }
+    }
+
+    // A fresh build directory starts from the checks this toolchain already ran
+    if (fresh) {
+        ConfigureCache cache(config.toolchainFile, config.cacheEntries, std::filesystem::path(path_) / ".cppm");
+        std::string initialCache = cache.initialCacheFile();
+        if (!initialCache.empty()) {
+            args.push_back("-C");
+            args.push_back(initialCache);
+        }
+    }
+    return args;
+}
+
+std::string Workspace::compileMemoryLog() const {
+    return (std::filesystem::path(path_) / ".cppm" / "compilememory.txt").string();
+}
+
+std::string Workspace::compileLauncherShim() const {
+    std::string script =
+        "#!/bin/sh\n"
+        "# Compile launcher of this workspace's build trees, written by cppm. Builds\n"
+        "# started from cppm name theirs; any other build compiles directly.\n"
+        "if [ -n \"$" + std::string(CompileMemory::kLauncherVariable) + "\" ]; then\n"
+        "    exec \"$" + CompileMemory::kLauncherVariable + "\" --compile-launcher \"$" +
+        CompileMemory::kLogVariable + "\" \"$@\"\n"
+        "fi\n"
+        "exec \"$@\"\n";
+    std::filesystem::path shim = stateDirectory() / "compile-launcher";
+    if (fileContents(shim) != script) {
+        std::ofstream out(shim, std::ios::trunc);
+        out << script;
+        out.close();
+        if (!out.good()) {
+            return std::string();
+        }
+    }
+    std::error_code ec;
+    std::filesystem::permissions(shim, std::filesystem::perms::owner_all | std::filesystem::perms::group_read |
+                                       std::filesystem::perms::group_exec | std::filesystem::perms::others_read |
+                                       std::filesystem::perms::others_exec, ec);
+    return ec ? std::string() : shim.string();
+}
+
+JobsChoice Workspace::chooseBuildJobs() const {
+    CompileMemory memory(compileMemoryLog());
+    memory.load();
+    memory.compact();
+    return memory.chooseJobs(static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+std::string Workspace::parallelismFile() const {
+    return (std::filesystem::path(path_) / ".cppm" / "parallelism.txt").string();
+}
+
+std::string Workspace::distributedSettingsFile() const {
+    return (std::filesystem::path(path_) / ".cppm" / "distributed.txt").string();
+}
+
+std::string Workspace::runHistoryFile() const {
+    return (std::filesystem::path(path_) / ".cppm" / "runs.txt").string();
+}
+
+std::string Workspace::getLinker() const {
+    std::ifstream file(std::filesystem::path(path_) / ".cppm" / "linker.txt");
+    std::string linker;
+    file >> linker;
+    const auto& known = LinkerBenchmark::linkers();
+    return std::find(known.begin(), known.end(), linker) != known.end() ? linker : std::string();
+}
+
+bool Workspace::setLinker(const std::string& linker) {
+    const auto& known = LinkerBenchmark::linkers();
+    if (!linker.empty() && std::find(known.begin(), known.end(), linker) == known.end()) {
+        return false;
+    }
+    std::ofstream file(stateDirectory() / "linker.txt");
+    file << linker << "\n";
+    return file.good();
+}
+
+std::vector<std::string> Workspace::getBuildTargets() {
+    std::vector<std::string> targets;
+    BuildSystem buildSystem = detectBuildSystem();
+
+    if (buildSystem == BuildSystem::CMake) {
+        CMakeCodeModel model;
+        if (getCodeModel(model)) {
+            for (const auto& target : model.targets) {
+                // Interface libraries have nothing to build
+                if (target.type != "INTERFACE_LIBRARY") {
+                    targets.push_back(target.name);
+                }
+            }
+        }
+    } else if (buildSystem == BuildSystem::Ninja) {
+        // Lines look like "name: rule"
+        std::istringstream output(runCommand("cd " + shellQuote(path_) + " && ninja -t targets 2>/dev/null"));
+        std::string line;
+        while (std::getline(output, line)) {
+            size_t colon = line.find(": ");
+            if (colon != std::string::npos && colon > 0) {
+                targets.push_back(line.substr(0, colon));
+            }
+        }
+    }
+
+    std::sort(targets.begin(), targets.end());
+    return targets;
+}
+
+std::string Workspace::getCompileDatabasePath() const {
+    std::error_code ec;
+    std::filesystem::path inBuild = activeBuildDirectory() / "compile_commands.json";
+    if (std::filesystem::exists(inBuild, ec)) {
+        return inBuild.string();
+    }
+    // Non-CMake projects often keep one at the root (bear, meson symlink)
+    std::filesystem::path inRoot = std::filesystem::path(path_) / "compile_commands.json";
+    if (std::filesystem::exists(inRoot, ec)) {
+        return inRoot.string();
+    }
+    return std::string();
+}
+
+TreeDigest Workspace::computeSourceDigest() const {
+    ScopedLatency digestLatency("digest");
+    // A tree cppm never built keeps no index: the first build creates .cppm
+    HashIndex index(path_, (std::filesystem::path(path_) / ".cppm" / "hashindex.txt").string(), getBuildDirectories());
+    return index.compute();
+}
+
+std::vector<std::string> Workspace::getBuildDirectories() const {
+    std::vector<std::string> directories;
+    for (const auto& config : getConfigurations()) {
+        directories.push_back(config.directory);
+    }
+    return directories;
+}
+
+std::unordered_map<std::string, uint64_t> Workspace::loadBuildDigests() const {
+    // Format: "<digest in hex> <configuration name>" per line
+    std::unordered_map<std::string, uint64_t> digests;
+    std::ifstream file(std::filesystem::path(path_) / ".cppm" / "builds.txt");
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        uint64_t digest = 0;
+        std::string name;
+        if (in >> std::hex >> digest && in.get() == ' ' && std::getline(in, name) && !name.empty()) {
+            digests[name] = digest;
+        }
+    }
+    return digests;
+}
+
+void Workspace::saveBuildDigests(const std::unordered_map<std::string, uint64_t>& digests) const {
+    std::ofstream file(stateDirectory() / "builds.txt");
+    for (const auto& pair : digests) {
+        file << std::hex << pair.second << std::dec << ' ' << pair.first << std::endl;
+    }
+}
+
+uint64_t Workspace::buildKey(const std::string& configuration, uint64_t sourceDigest,
+                             const std::string& generator) const {
+    BuildConfiguration config = getActiveConfiguration();
+    for (const auto& candidate : getConfigurations()) {
+        if (candidate.name == configuration) {
+            config = candidate;
+        }
+    }
+
+    std::ostringstream settings;
+    settings << "generator " << generator << '\n';
+    for (const auto& arg : getConfigureArguments(config)) {
+        settings << "arg " << arg << '\n';
+    }
+    settings << "linker " << getLinker() << '\n';
+    settings << "distributed " << fileContents(distributedSettingsFile()) << '\n';
+    // What CMake and make pick up from the environment
+    for (const char* name : {"CC", "CXX", "CFLAGS", "CXXFLAGS", "CPPFLAGS", "LDFLAGS", "CMAKE_GENERATOR",
+                             "CMAKE_C_COMPILER_LAUNCHER", "CMAKE_CXX_COMPILER_LAUNCHER"}) {
+        const char* value = std::getenv(name);
+        settings << name << ' ' << (value ? value : "") << '\n';
+    }
+    // Compilers, flags and launchers as configured, whoever set them
+    settings << "cache " << fileContents(std::filesystem::path(getConfigurationDirectory(config)) / "CMakeCache.txt");
+
+    std::string text = settings.str();
+    return HashIndex::xxh64(text.data(), text.size(), sourceDigest);
+}
+
+bool Workspace::isBuildUpToDate(uint64_t key) const {
+    BuildConfiguration config = getActiveConfiguration();
+    auto digests = loadBuildDigests();
+    auto it = digests.find(config.name);
+    if (it == digests.end() || it->second != key) {
+        return false;
+    }
+    // A build tree that was deleted behind our back needs a full build
+    if (detectBuildSystem() == BuildSystem::CMake) {
+        return std::filesystem::exists(activeBuildDirectory() / "CMakeCache.txt");
+    }
+    return true;
+}
+
+void Workspace::recordSuccessfulBuild(const std::string& configuration, uint64_t key) {
+    auto digests = loadBuildDigests();
+    digests[configuration] = key;
+    saveBuildDigests(digests);
+}
+
+void Workspace::forgetSuccessfulBuild(const std::string& configuration) {
+    auto digests = loadBuildDigests();
+    if (digests.erase(configuration) > 0) {
+        saveBuildDigests(digests);
+    }
+}
+
+std::filesystem::path Workspace::activeBuildDirectory() const {
+    return getConfigurationDirectory(getActiveConfiguration());
+}
+
 std::string Workspace::getPreferredBuildCommand() const {
     switch (detectBuildSystem()) {
         case BuildSystem::CMake:
@@ -207,19 +1088,18 @@ std::string Workspace::getPreferredBuildCommand() const {
     }
 }
 
-bool Workspace::isExecutableFile(const std::filesystem::path& file) const {
-    if (!std::filesystem::exists(file) || !std::filesystem::is_regular_file(file)) {
+bool Workspace::isExecutableFile(const FileProbe& probe) const {
+    if (!probe.exists || !S_ISREG(probe.mode)) {
         return false;
     }
     
     // Check if file has execute permissions
-    std::filesystem::perms perms = std::filesystem::status(file).permissions();
-    bool hasExecutePerms = (perms & std::filesystem::perms::owner_exec) != std::filesystem::perms::none ||
-                          (perms & std::filesystem::perms::group_exec) != std::filesystem::perms::none ||
-                          (perms & std::filesystem::perms::others_exec) != std::filesystem::perms::none;
+    bool hasExecutePerms = (probe.mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0;
     
     if (!hasExecutePerms) return false;
     
+    std::filesystem::path file(probe.path);
+    
     // Get file info
     std::string filename = file.filename().string();
     std::string extension = file.extension().string();
@@ -258,21 +1138,13 @@ bool Workspace::isExecutableFile(const std::filesystem::path& file) const {
     // For files without extensions, check if they look like built executables
     if (extension.empty()) {
         // Check file size (built executables are usually larger than a few KB)
-        try {
-            auto fileSize = std::filesystem::file_size(file);
-            if (fileSize < 1024) { // Less than 1KB, probably not a real executable
-                return false;
-            }
-        } catch (...) {
+        if (probe.size < 1024) { // Less than 1KB, probably not a real executable
             return false;
         }
         
-        // Simple check: read first few bytes to see if it looks like a binary
-        std::ifstream f(file, std::ios::binary);
-        if (f.is_open()) {
-            char magic[4] = {0};
-            f.read(magic, 4);
-            f.close();
+        // Simple check: the first few bytes tell binaries from scripts
+        if (probe.headerLength >= 4) {
+            const unsigned char* magic = probe.header;
             
             // Check for ELF magic number (Linux executables)
             if (magic[0] == 0x7F && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F') {
@@ -285,15 +1157,13 @@ bool Workspace::isExecutableFile(const std::filesystem::path& file) const {
             }
             
             // If it's not obviously a binary, check if it has common text patterns
-            std::ifstream textCheck(file);
-            std::string firstLine;
-            if (std::getline(textCheck, firstLine)) {
-                // If first line looks like text/script, exclude it
-                if (firstLine.find("#!/") == 0 || firstLine.find("<?") == 0 ||
-                    firstLine.find("//") == 0 || firstLine.find("/*") == 0 ||
-                    firstLine.find("#include") != std::string::npos) {
-                    return false;
-                }
+            std::string header(reinterpret_cast<const char*>(probe.header), probe.headerLength);
+            std::string firstLine = header.substr(0, header.find('\n'));
+            // If first line looks like text/script, exclude it
+            if (firstLine.find("#!/") == 0 || firstLine.find("<?") == 0 ||
+                firstLine.find("//") == 0 || firstLine.find("/*") == 0 ||
+                firstLine.find("#include") != std::string::npos) {
+                return false;
             }
         }
     }
@@ -320,9 +1190,61 @@ bool Workspace::isLikelyGUIApp(const std::filesystem::path& file) const {
     return false;
 }
 
+bool Workspace::getCodeModel(CMakeCodeModel& model) const {
+    if (detectBuildSystem() != BuildSystem::CMake) {
+        return false;
+    }
+    BuildConfiguration config = getActiveConfiguration();
+    return CMakeFileApi(getConfigurationDirectory(config)).readCodeModel(model, config.buildType);
+}
+
+void Workspace::collectExecutables(std::vector<FileProbe>& candidates, std::vector<ExecutableInfo>& executables) const {
+    // Only extensionless files with an execute bit need their header sniffed
+    MetadataScanner scanner;
+    scanner.probe(candidates, [](const FileProbe& file) {
+        return S_ISREG(file.mode) && (file.mode & (S_IXUSR | S_IXGRP | S_IXOTH)) && file.size >= 1024 &&
+               std::filesystem::path(file.path).extension().empty();
+    });
+
+    for (const auto& candidate : candidates) {
+        if (isExecutableFile(candidate)) {
+            std::filesystem::path file(candidate.path);
+            ExecutableInfo info;
+            info.path = candidate.path;
+            info.name = file.filename().string();
+            info.relativePath = std::filesystem::relative(file, path_).string();
+            info.isGUI = isLikelyGUIApp(file);
+            executables.push_back(info);
+        }
+    }
+}
+
 std::vector<ExecutableInfo> Workspace::findExecutables() const {
+    TRACE_SCOPE("Workspace::findExecutables", "scan", path_);
+    ScopedLatency scanLatency("scan");
     std::vector<ExecutableInfo> executables;
     std::filesystem::path basePath(path_);
+
+    // CMake knows exactly which targets are executables and where they go
+    CMakeCodeModel model;
+    if (getCodeModel(model)) {
+        for (const auto& target : model.targets) {
+            if (target.type != "EXECUTABLE" || target.artifacts.empty()) {
+                continue;
+            }
+            std::filesystem::path artifact(target.artifacts.front());
+            if (!std::filesystem::exists(artifact)) {
+                continue; // Not built yet
+            }
+            ExecutableInfo info;
+            info.path = artifact.string();
+            info.name = target.name;
+            info.relativePath = std::filesystem::relative(artifact, basePath).string();
+            info.isGUI = target.linksGuiToolkit || isLikelyGUIApp(artifact);
+            executables.push_back(info);
+        }
+        return executables;
+    }
     
     // Prioritize build output directories (most likely to contain project executables)
     std::vector<std::string> searchDirs = {
@@ -334,9 +1256,9 @@ std::vector<ExecutableInfo> Workspace::findExecutables() const {
         (basePath / "Debug").string()
     };
     
-    // Only search project root if no executables found in build directories
-    bool foundInBuildDirs = false;
-    
+    // The walk only collects candidates; their metadata and headers are
+    // then fetched in batches
+    std::vector<FileProbe> candidates;
     for (const auto& dirPath : searchDirs) {
         if (!std::filesystem::exists(dirPath)) continue;
         
@@ -361,14 +1283,10 @@ std::vector<ExecutableInfo> Workspace::findExecutables() const {
                     continue;
                 }
                 
-                if (iter->is_regular_file() && isExecutableFile(iter->path())) {
-                    ExecutableInfo info;
-                    info.path = iter->path().string();
-                    info.name = iter->path().filename().string();
-                    info.relativePath = std::filesystem::relative(iter->path(), basePath).string();
-                    info.isGUI = isLikelyGUIApp(iter->path());
-                    executables.push_back(info);
-                    foundInBuildDirs = true;
+                if (iter->is_regular_file()) {
+                    FileProbe candidate;
+                    candidate.path = iter->path().string();
+                    candidates.push_back(std::move(candidate));
                 }
             }
         } catch (const std::filesystem::filesystem_error&) {
@@ -376,30 +1294,31 @@ std::vector<ExecutableInfo> Workspace::findExecutables() const {
             continue;
         }
     }
+    collectExecutables(candidates, executables);
     
     // If no executables found in build directories, do a limited search in project root
-    if (!foundInBuildDirs) {
+    if (executables.empty()) {
+        candidates.clear();
         try {
             // Only search one level deep in project root
             for (const auto& entry : std::filesystem::directory_iterator(basePath)) {
-                if (entry.is_regular_file() && isExecutableFile(entry.path())) {
-                    ExecutableInfo info;
-                    info.path = entry.path().string();
-                    info.name = entry.path().filename().string();
-                    info.relativePath = std::filesystem::relative(entry.path(), basePath).string();
-                    info.isGUI = isLikelyGUIApp(entry.path());
-                    executables.push_back(info);
+                if (entry.is_regular_file()) {
+                    FileProbe candidate;
+                    candidate.path = entry.path().string();
+                    candidates.push_back(std::move(candidate));
                 }
             }
         } catch (const std::filesystem::filesystem_error&) {
             // Skip if we can't access the directory
         }
+        collectExecutables(candidates, executables);
     }
     
     return executables;
 }
 
 ExecutableInfo Workspace::findMainExecutable() const {
+    TRACE_SCOPE("Workspace::findMainExecutable", "scan");
     auto executables = findExecutables();
     
     if (executables.empty()) {
@@ -408,6 +1327,14 @@ ExecutableInfo Workspace::findMainExecutable() const {
     
     // Try to find the "main" executable using heuristics
     std::string projectName = std::filesystem::path(path_).filename().string();
+    CMakeCodeModel model;
+    if (getCodeModel(model) && !model.projectName.empty()) {
+        for (const auto& exe : executables) {
+            if (exe.name == model.projectName) {
+                return exe;
+            }
+        }
+    }
     std::transform(projectName.begin(), projectName.end(), projectName.begin(), ::tolower);
     
     // First, look for executables with the project name
@@ -0,0 +1,14 @@
+#include "CompileMemory.h"
+#include <cstdio>
+#include <cstring>
+
+// cppm-launcher: the compile launcher on its own. Builds run it in front of
+// every compiler call, so it links nothing but CompileMemory and starts as
+// fast as the compiler itself.
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--compile-launcher") == 0) {
+        return CompileMemory::runLauncher(argc - 2, argv + 2);
+    }
+    std::fprintf(stderr, "usage: cppm-launcher --compile-launcher <log file> <compiler> [arguments...]\n");
+    return 2;
+}
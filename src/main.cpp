@@ -1,9 +1,49 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include "MainWindow.h"
+#include "Trace.h"
+#include "MetadataScanner.h"
+#include "ProcessSupervisor.h"
+#include "CompileMemory.h"
+#include <cstring>
+#include <iostream>
 
 int main(int argc, char *argv[]) {
+    // Wrapper around every supervised child; only ever first, so arguments
+    // meant for the child are not mistaken for options below
+    if (argc > 1 && std::strcmp(argv[1], "--exec-supervised") == 0) {
+        return ProcessSupervisor::execSupervised(argc - 2, argv + 2);
+    }
+    // Build trees configured before cppm-launcher existed still name cppm itself
+    if (argc > 1 && std::strcmp(argv[1], "--compile-launcher") == 0) {
+        return CompileMemory::runLauncher(argc - 2, argv + 2);
+    }
+
+    // Headless, so it is handled before QApplication needs a display
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark-scan") == 0) {
+            MetadataScanner::benchmark(argv[i + 1], std::cout);
+            return 0;
+        }
+    }
+
     QApplication a(argc, argv);
+    Tracer::instance().setThreadName("GUI");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption traceOutOption("trace-out", "Write a Chrome trace-event JSON file on exit.", "file");
+    parser.addOption(traceOutOption);
+    QCommandLineOption benchmarkScanOption("benchmark-scan", "Compare the classic and io_uring file scanners on a directory and exit.", "directory");
+    parser.addOption(benchmarkScanOption);
+    parser.process(a);
+
     MainWindow w;
     w.show();
-    return a.exec();
+    int result = a.exec();
+
+    if (parser.isSet(traceOutOption)) {
+        Tracer::instance().exportChromeTrace(parser.value(traceOutOption).toStdString());
+    }
+    return result;
 }